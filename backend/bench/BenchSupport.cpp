@@ -0,0 +1,164 @@
+#include "BenchSupport.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <system_error>
+
+#include "util/TrdpLogPartitions.hpp"
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+
+void *allocate(std::size_t size) {
+    ++allocations;
+    if (void *ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) {
+    ++allocations;
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment.
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    if (void *ptr = std::aligned_alloc(align, rounded)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace trdp::bench {
+
+uint64_t threadAllocations() noexcept {
+    return allocations;
+}
+
+std::string syntheticTrdpXml(size_t telegrams, bool subscribers_only, int cycle_ms) {
+    const std::string cycle = "\" cycle=\"" + std::to_string(cycle_ms) + "\">\n";
+    const std::string pd_parameter = "        <pd-parameter cycle=\"" + std::to_string(cycle_ms * 1000) +
+                                     "\" marshall=\"off\" timeout=\"" + std::to_string(cycle_ms * 3000) +
+                                     "\" validity-behavior=\"zero\" />\n";
+    std::string xml;
+    xml.reserve(512 + telegrams * 320);
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<device host-name=\"bench\" type=\"bench\">\n";
+    xml += "  <bus-interface-list>\n    <bus-interface network-id=\"1\" name=\"bench\" host-ip=\"127.0.0.1\">\n";
+    for (size_t i = 0; i < telegrams; ++i) {
+        const bool subscriber = subscribers_only || i % 2 == 1;
+        const std::string com_id = std::to_string(kFirstComId + static_cast<int>(i));
+        xml += "      <telegram name=\"bench";
+        xml += com_id;
+        xml += subscriber ? "\" direction=\"subscriber\"" : "\" direction=\"publisher\"";
+        xml += " com-id=\"" + com_id + "\" data-set-id=\"900\" com-parameter-id=\"1";
+        xml += cycle;
+        xml += pd_parameter;
+        xml += subscriber ? "        <source id=\"1\" uri=\"239.2.0.1\" />\n" : "        <destination id=\"1\" uri=\"239.2.0.1\" />\n";
+        xml += "      </telegram>\n";
+    }
+    xml += "    </bus-interface>\n  </bus-interface-list>\n";
+    // 8 + 4 * 4 + 8 * 4 + 2 * 4 = 64 bytes.
+    xml += "  <data-set-list>\n    <data-set name=\"BenchDataset\" id=\"900\">\n";
+    xml += "      <element name=\"counter\" type=\"UINT64\" />\n";
+    xml += "      <element name=\"speed\" type=\"REAL32\" array-size=\"4\" />\n";
+    xml += "      <element name=\"position\" type=\"REAL64\" array-size=\"4\" />\n";
+    xml += "      <element name=\"status\" type=\"UINT16\" array-size=\"4\" />\n";
+    xml += "    </data-set>\n  </data-set-list>\n</device>\n";
+    return xml;
+}
+
+std::filesystem::path scratchDatabase(std::string_view name) {
+    auto path = std::filesystem::temp_directory_path() / std::string(name);
+    std::error_code ignored;
+    for (const char *suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::filesystem::remove(path.string() + suffix, ignored);
+    }
+    std::filesystem::remove_all(util::TrdpLogPartitions::defaultDirectory(path.string()), ignored);
+    return path;
+}
+
+ScratchDatabase::ScratchDatabase(std::string_view name)
+    : path_(scratchDatabase(name)), database_(path_.string()) {}
+
+Check::~Check() {
+    if (failure_ != nullptr) {
+        state_.SkipWithError(failure_);
+    }
+}
+
+bool Check::expect(bool ok, const char *failure) noexcept {
+    if (!ok && failure_ == nullptr) {
+        failure_ = failure;
+    }
+    return ok;
+}
+
+std::vector<util::TrdpLogEntry> allLogs(util::LogService &logs, util::TrdpLogQuery query) {
+    std::vector<util::TrdpLogEntry> entries;
+    for (;;) {
+        auto page = logs.getTrdpLogs(query);
+        if (page.empty()) {
+            return entries;
+        }
+        const int64_t last = page.back().id;
+        entries.insert(entries.end(), std::make_move_iterator(page.begin()), std::make_move_iterator(page.end()));
+        if (query.before_id && last >= *query.before_id) {
+            return entries;
+        }
+        query.before_id = last;
+    }
+}
+
+}  // namespace trdp::bench
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "db/Database.hpp"
+#include "util/LogService.hpp"
+
+namespace trdp::bench {
+
+// A TRDP device description with `telegrams` PD telegrams on one bus
+// interface, all sharing a 64-byte dataset of scalar fields. Publishers and
+// subscribers alternate unless `subscribers_only` is set. ComIds start at
+// 10000. Telegrams are cyclic every `cycle_ms` milliseconds, given both as
+// the pd-parameter of the TRDP schema and as the telegram attribute read
+// without libtrdp; 0 makes publishers send only when updated.
+std::string syntheticTrdpXml(size_t telegrams, bool subscribers_only = false, int cycle_ms = 100);
+
+constexpr int kFirstComId = 10000;
+constexpr size_t kDatasetSize = 64;
+
+// A path in the system temporary directory for a scratch database; any file
+// left over from a previous run, including its TRDP log partitions, is
+// removed first.
+std::filesystem::path scratchDatabase(std::string_view name);
+
+// A database opened on a fresh scratchDatabase(name), for checks that write
+// to it.
+class ScratchDatabase {
+public:
+    explicit ScratchDatabase(std::string_view name);
+
+    const std::filesystem::path &path() const noexcept { return path_; }
+    db::Database &database() noexcept { return database_; }
+
+private:
+    std::filesystem::path path_;
+    db::Database database_;
+};
+
+// The outcome of a BM_Check benchmark. The first failed expectation is
+// reported with SkipWithError when the Check goes out of scope, which the
+// trdp_bench_checks test treats as a failure.
+class Check {
+public:
+    explicit Check(benchmark::State &state) noexcept : state_(state) {}
+    ~Check();
+
+    Check(const Check &) = delete;
+    Check &operator=(const Check &) = delete;
+
+    // Records `failure` unless `ok` or an earlier expectation failed;
+    // returns `ok`.
+    bool expect(bool ok, const char *failure) noexcept;
+    bool failed() const noexcept { return failure_ != nullptr; }
+
+private:
+    benchmark::State &state_;
+    const char *failure_ {nullptr};
+};
+
+// Every entry matching `query`, newest first, read page by page with
+// `before_id` as a client does. Stops after a page that does not move
+// `before_id` down, leaving its repeated rows for the caller to find.
+std::vector<util::TrdpLogEntry> allLogs(util::LogService &logs, util::TrdpLogQuery query);
+
+// Heap allocations made so far by the calling thread. trdp_bench replaces
+// the global operator new to count them; compare two readings to check that
+// a code path does not allocate.
+uint64_t threadAllocations() noexcept;
+
+}  // namespace trdp::bench
@@ -0,0 +1,491 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "db/Database.hpp"
+#include "http/StreamBroadcaster.hpp"
+#include "network/NetworkConfigService.hpp"
+#include "trdp/DatasetCodec.hpp"
+#include "trdp/TrdpConfigService.hpp"
+#include "trdp/TrdpEngine.hpp"
+#include "util/Hex.hpp"
+#include "util/LogService.hpp"
+#include "util/TrdpLogWriter.hpp"
+
+namespace trdp::stack {
+
+// Reaches the receive and logging paths that the stack callbacks normally
+// drive, so they can be timed without a peer on the network.
+struct TrdpEngineBenchAccess {
+    static size_t subscriberCount(const TrdpEngine &engine) { return engine.pd_subscriber_runtime_.size(); }
+
+    static void receivePd(TrdpEngine &engine, size_t subscriber, const uint8_t *payload, uint32_t size,
+                          int64_t rx_time_ns = 0) {
+        TrdpEngine::pdCallbackBridge(engine.pd_subscriber_runtime_[subscriber].get(), payload, size, 0x0a000101,
+                                     0xef020001, rx_time_ns);
+    }
+
+    static void logEvent(TrdpEngine &engine, int msg_id, const uint8_t *payload, size_t size) {
+        engine.logTrdpEvent("IN", "PD", msg_id, "10.0.1.1", "239.2.0.1", payload, size);
+    }
+
+    static void flushLog(TrdpEngine &engine) { engine.log_writer_->flush(); }
+};
+
+}  // namespace trdp::stack
+
+namespace {
+
+using trdp::stack::TrdpEngine;
+using trdp::stack::TrdpEngineBenchAccess;
+
+constexpr size_t kSubscribers = 100;
+
+// Loads a configuration without starting the worker; the stack may or may
+// not come up, only the telegram tables matter here.
+void loadSubscribers(TrdpEngine &engine, size_t count) {
+    trdp::config::TrdpConfig config;
+    config.name = "bench";
+    config.xml_content = trdp::bench::syntheticTrdpXml(count, true);
+    trdp::network::NetworkConfig net;
+    net.local_ip = "127.0.0.1";
+    net.pd_port = 18330;
+    net.md_port = 18331;
+    engine.loadConfiguration(config, net);
+}
+
+// Receive callback throughput while range(0) HTTP-style reader threads keep
+// snapshotting the subscriber table.
+void BM_HandleIncomingPd(benchmark::State &state) {
+    TrdpEngine engine;
+    loadSubscribers(engine, kSubscribers);
+    const size_t subscribers = TrdpEngineBenchAccess::subscriberCount(engine);
+    if (subscribers == 0) {
+        state.SkipWithError("no subscribers loaded");
+        return;
+    }
+
+    std::atomic<bool> stop {false};
+    std::atomic<uint64_t> snapshots {0};
+    std::vector<std::thread> readers;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto messages = engine.listIncomingPd();
+                benchmark::DoNotOptimize(messages);
+                snapshots.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    size_t next = 0;
+    for (auto _ : state) {
+        ++payload[0];
+        TrdpEngineBenchAccess::receivePd(engine, next, payload, sizeof(payload));
+        next = next + 1 == subscribers ? 0 : next + 1;
+    }
+
+    stop = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["snapshots"] = benchmark::Counter(static_cast<double>(snapshots.load()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_HandleIncomingPd)->Arg(0)->Arg(1)->Arg(4)->ArgName("readers")->UseRealTime();
+
+// The steady-state receive path must not allocate, with trdp_logs logging and
+// traffic rollups on. Warming up across two second boundaries lets every
+// rollup series and both of its pending bucket buffers come into existence;
+// the measured part then crosses another boundary so that closing buckets
+// is covered as well. Only allocations of the receiving thread count.
+void BM_CheckHandleIncomingPdAllocations(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_receive.db");
+    TrdpEngine engine(&scratch.database());
+    loadSubscribers(engine, kSubscribers);
+    const size_t subscribers = TrdpEngineBenchAccess::subscriberCount(engine);
+    if (!check.expect(subscribers != 0, "no subscribers loaded")) {
+        return;
+    }
+
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    size_t next = 0;
+    uint64_t received = 0;
+    // Receives until the wall clock has entered `boundaries` more seconds.
+    auto receiveFor = [&](int boundaries) {
+        using std::chrono::system_clock;
+        const auto until = std::chrono::floor<std::chrono::seconds>(system_clock::now()) +
+                           std::chrono::seconds(boundaries) + std::chrono::milliseconds(50);
+        while (system_clock::now() < until) {
+            ++payload[0];
+            TrdpEngineBenchAccess::receivePd(engine, next, payload, sizeof(payload));
+            next = next + 1 == subscribers ? 0 : next + 1;
+            ++received;
+        }
+    };
+    receiveFor(2);
+
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        received = 0;
+        const uint64_t before = trdp::bench::threadAllocations();
+        receiveFor(1);
+        allocations += trdp::bench::threadAllocations() - before;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(received));
+    state.counters["allocations"] = static_cast<double>(allocations);
+    check.expect(allocations == 0, "the PD receive path allocated");
+}
+BENCHMARK(BM_CheckHandleIncomingPdAllocations)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// A since_version delta must list a subscriber once its payload changes and
+// not again while the same bytes keep arriving. Repeats must not rebuild the
+// listed message either, unless its timestamp moved to the next second.
+void BM_CheckIncomingPdDelta(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    TrdpEngine engine;
+    loadSubscribers(engine, 2);
+    if (!check.expect(TrdpEngineBenchAccess::subscriberCount(engine) == 2, "no subscribers loaded")) {
+        return;
+    }
+
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    for (auto _ : state) {
+        const uint64_t start = engine.incomingPdSince(0).version;
+        payload[0] = 1;
+        TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload));
+        const auto changed = engine.incomingPdSince(start);
+        check.expect(changed.messages.size() == 1, "a changed payload is missing from the delta");
+        const auto before = engine.listIncomingPd();
+        for (int i = 0; i < 10; ++i) {
+            TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload));
+        }
+        check.expect(engine.incomingPdSince(changed.version).messages.empty(),
+                     "a repeated payload showed up in the delta");
+        const auto after = engine.listIncomingPd();
+        for (size_t i = 0; i < before.size() && i < after.size(); ++i) {
+            check.expect(before[i] == after[i] || before[i]->timestamp != after[i]->timestamp,
+                         "a repeated payload rebuilt the cached message");
+        }
+        payload[0] = 2;
+        TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload));
+        check.expect(engine.incomingPdSince(changed.version).messages.size() == 1,
+                     "a changed payload after repeats is missing from the delta");
+    }
+}
+BENCHMARK(BM_CheckIncomingPdDelta)->Iterations(1);
+
+// update_latency runs from the frame's arrival, as reported by the
+// transport, to its publication, so a frame that waited before reaching the
+// callback shows that wait.
+void BM_CheckPdUpdateLatency(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    TrdpEngine engine;
+    loadSubscribers(engine, 1);
+    if (!check.expect(TrdpEngineBenchAccess::subscriberCount(engine) == 1, "no subscribers loaded")) {
+        return;
+    }
+
+    constexpr int64_t kQueuedNs = 20'000'000;
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    for (auto _ : state) {
+        const int64_t arrived = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count() -
+                                kQueuedNs;
+        TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload), arrived);
+        TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload));
+    }
+    for (const auto &stats : engine.pdTimingStats()) {
+        if (stats.is_outgoing) {
+            continue;
+        }
+        check.expect(stats.update_latency.count == 2, "update latency was not recorded for every frame");
+        check.expect(stats.update_latency.max_ns >= kQueuedNs, "update latency ignored the arrival time");
+        check.expect(stats.update_latency.min_ns < kQueuedNs, "update latency without an arrival time is off");
+    }
+}
+BENCHMARK(BM_CheckPdUpdateLatency)->Iterations(1);
+
+// Four streams at the same interval while one subscriber's payload changes
+// every few milliseconds. Each frame must list the telegram at most once,
+// the last one with its final payload, and frames must be shared between
+// the streams instead of being built for each. A fifth stream is refused.
+void BM_CheckStreamBroadcaster(benchmark::State &state) {
+    using trdp::http::StreamBroadcaster;
+    trdp::bench::Check check(state);
+    TrdpEngine engine;
+    loadSubscribers(engine, 2);
+    if (!check.expect(TrdpEngineBenchAccess::subscriberCount(engine) == 2, "no subscribers loaded")) {
+        return;
+    }
+    constexpr size_t kStreams = 4;
+    constexpr auto kInterval = std::chrono::milliseconds(200);
+    const std::string telegram = "\"id\":" + std::to_string(trdp::bench::kFirstComId) + ",";
+
+    for (auto _ : state) {
+        StreamBroadcaster broadcaster(engine, kStreams);
+        std::vector<std::unique_ptr<StreamBroadcaster::Subscription>> streams;
+        for (size_t i = 0; i < kStreams; ++i) {
+            streams.push_back(broadcaster.subscribe(kInterval));
+            check.expect(streams.back() != nullptr, "a stream was refused below the limit");
+        }
+        check.expect(broadcaster.subscribe(kInterval) == nullptr, "a stream was opened beyond the limit");
+        if (check.failed()) {
+            return;
+        }
+        for (const auto &stream : streams) {
+            const auto first = stream->next(std::chrono::seconds(1));
+            check.expect(first && first->find("\"reset\":true") != std::string::npos,
+                         "the first frame does not hold the complete lists");
+        }
+
+        const uint64_t built_before = broadcaster.framesBuilt();
+        std::atomic<bool> stop {false};
+        std::mutex frames_mutex;
+        std::vector<std::vector<std::shared_ptr<const std::string>>> frames(kStreams);
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < kStreams; ++i) {
+            readers.emplace_back([&, i] {
+                while (!stop.load()) {
+                    if (auto frame = streams[i]->next(std::chrono::milliseconds(50))) {
+                        std::lock_guard<std::mutex> lock(frames_mutex);
+                        frames[i].push_back(std::move(frame));
+                    }
+                }
+            });
+        }
+        uint8_t payload[trdp::bench::kDatasetSize] = {};
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::chrono::steady_clock::now() < until) {
+            ++payload[0];
+            TrdpEngineBenchAccess::receivePd(engine, 0, payload, sizeof(payload));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        // Let every stream take the frame holding the last change.
+        std::this_thread::sleep_for(kInterval * 2);
+        stop = true;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+
+        char final_hex[2 * sizeof(payload) + 1] = {};
+        trdp::util::hexEncode(payload, sizeof(payload), final_hex);
+        size_t delivered = 0;
+        for (const auto &stream_frames : frames) {
+            delivered += stream_frames.size();
+            for (const auto &frame : stream_frames) {
+                const size_t at = frame->find(telegram);
+                check.expect(at == std::string::npos || frame->find(telegram, at + 1) == std::string::npos,
+                             "a frame lists a telegram more than once");
+            }
+            check.expect(!stream_frames.empty() && stream_frames.back()->find(final_hex) != std::string::npos,
+                         "a stream missed the last change");
+        }
+        const uint64_t built = broadcaster.framesBuilt() - built_before;
+        state.counters["delivered"] = static_cast<double>(delivered);
+        state.counters["built"] = static_cast<double>(built);
+        check.expect(built * 2 <= delivered, "frames were built per stream instead of shared");
+
+        streams.pop_back();
+        check.expect(broadcaster.subscribe(kInterval) != nullptr, "a closed stream did not free its place");
+    }
+}
+BENCHMARK(BM_CheckStreamBroadcaster)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Element `index` of field `name` in a frame of the bench dataset.
+double frameElement(const trdp::stack::DatasetLayout &layout, const std::vector<uint8_t> &frame, const char *name,
+                    uint32_t index) {
+    const auto value = trdp::stack::readElement(*layout.find(name), frame.data(), index);
+    return std::visit([](auto element) { return static_cast<double>(element); }, value);
+}
+
+// kPatchWriters threads PATCH one publisher at once, thread t writing its
+// own value k to speed[t], position[t] and status[t] in a single update,
+// while the telegram is published every range(0) milliseconds (0: on every
+// update). Every frame logged to trdp_logs must show the three fields of
+// each thread equal, i.e. no half-applied or torn update, and the last frame
+// as well as the telegram's state must hold every thread's final value.
+constexpr uint32_t kPatchWriters = 4;
+
+void BM_CheckPatchOutgoingPdFields(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_patch.db");
+    trdp::stack::TrdpEngineOptions options;
+    options.log_writer.overflow_policy = trdp::util::LogOverflowPolicy::kBlock;
+    options.log_writer.deduplicate_pd = false;
+    options.rollup.enabled = false;
+    TrdpEngine engine(&scratch.database(), options);
+    trdp::config::TrdpConfig config;
+    config.name = "bench";
+    config.xml_content = trdp::bench::syntheticTrdpXml(1, false, static_cast<int>(state.range(0)));
+    trdp::network::NetworkConfig net;
+    net.local_ip = "127.0.0.1";
+    net.pd_port = 18332;
+    net.md_port = 18333;
+    engine.loadConfiguration(config, net);
+    engine.start();
+    const int com_id = trdp::bench::kFirstComId;
+    const auto telegram = engine.findOutgoingPd(com_id);
+    if (!check.expect(telegram && telegram->dataset, "publisher not loaded")) {
+        return;
+    }
+    const auto &layout = *telegram->dataset;
+
+    uint64_t final_values[kPatchWriters] = {};
+    for (auto _ : state) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        std::vector<std::thread> writers;
+        for (uint32_t t = 0; t < kPatchWriters; ++t) {
+            writers.emplace_back([&, t] {
+                const std::string index = "[" + std::to_string(t) + "]";
+                uint64_t k = 0;
+                // status is a UINT16.
+                while (k < 65535 && std::chrono::steady_clock::now() < until) {
+                    ++k;
+                    engine.updateOutgoingPdFields(com_id, {{"speed" + index, {static_cast<double>(k)}, {}},
+                                                           {"position" + index, {static_cast<double>(k)}, {}},
+                                                           {"status" + index, {k}, {}}});
+                }
+                final_values[t] = k;
+            });
+        }
+        for (auto &writer : writers) {
+            writer.join();
+        }
+    }
+    // Give a cyclic publisher time to send the final state.
+    std::this_thread::sleep_for(std::chrono::milliseconds(state.range(0) * 3));
+    engine.stop();
+    TrdpEngineBenchAccess::flushLog(engine);
+
+    auto consistent = [&](const std::vector<uint8_t> &frame, bool final) {
+        for (uint32_t t = 0; t < kPatchWriters; ++t) {
+            const double speed = frameElement(layout, frame, "speed", t);
+            if (frameElement(layout, frame, "position", t) != speed ||
+                frameElement(layout, frame, "status", t) != speed ||
+                (final && speed != static_cast<double>(final_values[t]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    trdp::util::LogService logs(scratch.database(), options.log_writer);
+    trdp::util::TrdpLogQuery query;
+    query.limit = 500;
+    query.msg_id = com_id;
+    query.direction = "OUT";
+    const auto frames = trdp::bench::allLogs(logs, query);
+    size_t torn = 0;
+    for (const auto &entry : frames) {
+        torn += consistent(entry.payload, false) ? 0 : 1;
+    }
+
+    state.counters["frames"] = static_cast<double>(frames.size());
+    state.counters["torn"] = static_cast<double>(torn);
+    const auto current = engine.findOutgoingPd(com_id);
+    if (!check.expect(!frames.empty(), "no frames were published")) {
+        return;
+    }
+    check.expect(torn == 0, "a published frame mixed two updates");
+    check.expect(current && consistent(current->payload, true), "the telegram lost an update");
+    check.expect(consistent(frames.front().payload, true), "the last published frame lost an update");
+}
+BENCHMARK(BM_CheckPatchOutgoingPdFields)->Arg(0)
+    ->Arg(1)
+    ->ArgName("cycle_ms")
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Payload updates and MD sends from API threads while another thread keeps
+// reloading the configuration, which tears the transport down and opens a
+// new one each time. Senders must never reach a transport being torn down.
+void BM_CheckSendDuringReload(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    TrdpEngine engine;
+    trdp::config::TrdpConfig config;
+    config.name = "bench";
+    config.xml_content = trdp::bench::syntheticTrdpXml(4, false);
+    trdp::network::NetworkConfig net;
+    net.local_ip = "127.0.0.1";
+    net.pd_port = 18334;
+    net.md_port = 18335;
+    engine.loadConfiguration(config, net);
+    const int com_id = trdp::bench::kFirstComId;
+    if (!check.expect(engine.findOutgoingPd(com_id) != nullptr, "publisher not loaded")) {
+        return;
+    }
+
+    std::atomic<uint64_t> sends {0};
+    uint64_t reloads = 0;
+    for (auto _ : state) {
+        std::atomic<bool> stop {false};
+        std::vector<std::thread> senders;
+        for (int t = 0; t < 4; ++t) {
+            senders.emplace_back([&, t] {
+                std::vector<uint8_t> payload(trdp::bench::kDatasetSize);
+                while (!stop.load()) {
+                    ++payload[0];
+                    if (t % 2 == 0) {
+                        engine.updateOutgoingPdPayload(com_id, payload);
+                    } else {
+                        engine.sendMdMessage("127.0.0.1:18335", 20000, payload);
+                    }
+                    sends.fetch_add(1);
+                }
+            });
+        }
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        while (std::chrono::steady_clock::now() < until) {
+            engine.loadConfiguration(config, net);
+            ++reloads;
+        }
+        stop = true;
+        for (auto &sender : senders) {
+            sender.join();
+        }
+    }
+    state.counters["sends"] = static_cast<double>(sends.load());
+    state.counters["reloads"] = static_cast<double>(reloads);
+    check.expect(sends > 0 && reloads > 0, "sends and reloads did not overlap");
+}
+BENCHMARK(BM_CheckSendDuringReload)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Sustained trdp_logs insert rate: each iteration logs a burst of events and
+// waits for the writer thread to commit them.
+void BM_LogTrdpEvent(benchmark::State &state) {
+    trdp::db::Database database(trdp::bench::scratchDatabase("trdp_bench_writer.db").string());
+    trdp::stack::TrdpEngineOptions options;
+    options.log_writer.overflow_policy = trdp::util::LogOverflowPolicy::kBlock;
+    TrdpEngine engine(&database, options);
+
+    const auto burst = static_cast<size_t>(state.range(0));
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            payload[0] = static_cast<uint8_t>(i);
+            TrdpEngineBenchAccess::logEvent(engine, trdp::bench::kFirstComId + static_cast<int>(i % 100), payload,
+                                            sizeof(payload));
+        }
+        TrdpEngineBenchAccess::flushLog(engine);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * burst));
+    const auto stats = engine.logWriterStats();
+    state.counters["batch_p99_us"] = static_cast<double>(stats.write_latency.percentileNs(0.99)) / 1e3;
+    state.counters["dropped"] = static_cast<double>(stats.dropped);
+}
+BENCHMARK(BM_LogTrdpEvent)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
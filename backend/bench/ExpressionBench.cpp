@@ -0,0 +1,266 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "trdp/DatasetCodec.hpp"
+#include "trdp/Expression.hpp"
+#include "trdp/PayloadGenerator.hpp"
+#include "trdp/TrdpXmlParser.hpp"
+
+namespace {
+
+using trdp::stack::Expression;
+using trdp::stack::GeneratorKind;
+using trdp::stack::GeneratorSpec;
+
+// One publish cycle of a telegram whose fields are all driven by
+// generator expressions: field reads, trigonometry and a ternary.
+void BM_ExpressionEvaluate(benchmark::State &state) {
+    auto parsed = trdp::config::parseTrdpXmlConfig(trdp::bench::syntheticTrdpXml(1));
+    const auto layouts = trdp::stack::compileDatasets(parsed->datasets);
+    const auto &layout = *layouts.begin()->second;
+
+    const std::vector<std::string> sources = {
+        "counter + 1",
+        "20 + 5 * sin(2 * pi * 0.5 * t)",
+        "speed[0] * 0.9 + 0.1 * abs(cos(t))",
+        "clamp(position[1] + speed[2] * 0.1, -1000, 1000)",
+        "(status[0] & 0x4) != 0 ? status[1] : cycle % 65536",
+    };
+    std::vector<Expression> expressions;
+    for (size_t i = 0; i < static_cast<size_t>(state.range(0)); ++i) {
+        expressions.push_back(Expression::compile(sources[i % sources.size()], &layout));
+    }
+    std::vector<uint8_t> wire(layout.size, 0x11);
+
+    uint64_t cycle = 0;
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto &expression : expressions) {
+            sum += expression.evaluate(wire.data(), cycle, static_cast<double>(cycle) * 0.1);
+        }
+        benchmark::DoNotOptimize(sum);
+        ++cycle;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * expressions.size()));
+}
+BENCHMARK(BM_ExpressionEvaluate)->Arg(10)->Arg(1000);
+
+void BM_ExpressionCompile(benchmark::State &state) {
+    auto parsed = trdp::config::parseTrdpXmlConfig(trdp::bench::syntheticTrdpXml(1));
+    const auto layouts = trdp::stack::compileDatasets(parsed->datasets);
+    const auto &layout = *layouts.begin()->second;
+    for (auto _ : state) {
+        auto expression = Expression::compile("clamp(position[1] + speed[2] * sin(t) * 0.1, -1000, 1000)", &layout);
+        benchmark::DoNotOptimize(expression);
+    }
+}
+BENCHMARK(BM_ExpressionCompile);
+
+// Compiled expressions must evaluate like the arithmetic they spell out,
+// reading fields from the wire payload, and malformed, overlong or deeply
+// nested sources must be rejected with std::invalid_argument, not crash.
+void BM_CheckExpressionCompiler(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    auto parsed = trdp::config::parseTrdpXmlConfig(trdp::bench::syntheticTrdpXml(1));
+    const auto layouts = trdp::stack::compileDatasets(parsed->datasets);
+    const auto &layout = *layouts.begin()->second;
+    std::vector<uint8_t> wire(layout.size, 0);
+    trdp::stack::writeElement(*layout.find("counter"), wire.data(), 0, uint64_t {41});
+    trdp::stack::writeElement(*layout.find("speed"), wire.data(), 2, 2.5);
+    trdp::stack::writeElement(*layout.find("status"), wire.data(), 0, uint64_t {0x6});
+
+    struct Case {
+        const char *source;
+        double expected;
+    };
+    // Evaluated at cycle 7, t = 1.5.
+    const Case values[] = {
+        {"1 + 2 * 3", 7.0},
+        {"(1 + 2) * 3", 9.0},
+        {"-2 - -3", 1.0},
+        {"7 % 4 + (1 << 4) + (0xff >> 4)", 34.0},
+        {"2 > 1 && 0 || !0", 1.0},
+        {"1 ? 2 : 3 ? 4 : 5", 2.0},
+        {"clamp(5, 0, 3) + min(1, 2) + max(1, 2)", 6.0},
+        {"round(sin(pi / 2) * 100)", 100.0},
+        {"cycle * 10 + t * 2", 73.0},
+        {"counter + 1", 42.0},
+        {"speed[2] * 2", 5.0},
+        {"(status[0] & 0x4) != 0 ? speed[2] : -1", 2.5},
+    };
+    const char *errors[] = {"", "1 +", "(1", "1 2", "unknown", "speed", "sin(1, 2)", "nope(1)", "0x", "1 $ 2"};
+
+    std::string deep_parentheses(100000, '(');
+    deep_parentheses += "1";
+    deep_parentheses.append(100000, ')');
+    std::string deep_unary(4000, '-');
+    deep_unary += "1";
+    std::string deep_ternary;
+    for (int i = 0; i < 800; ++i) {
+        deep_ternary += "t?1:";
+    }
+    deep_ternary += "0";
+    std::string nested_64;
+    std::string nested_65 = "(";
+    for (int i = 0; i < 64; ++i) {
+        nested_64 += "(";
+    }
+    nested_65 += nested_64;
+    nested_64 += "1";
+    nested_65 += "1";
+    nested_64.append(64, ')');
+    nested_65.append(65, ')');
+
+    auto rejects = [](const std::string &source, const trdp::stack::DatasetLayout *layout) {
+        try {
+            Expression::compile(source, layout);
+        } catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    };
+
+    for (auto _ : state) {
+        for (const auto &test : values) {
+            double result = 0.0;
+            try {
+                result = Expression::compile(test.source, &layout).evaluate(wire.data(), 7, 1.5);
+            } catch (const std::invalid_argument &) {
+                result = NAN;
+            }
+            check.expect(result == test.expected, "an expression evaluated to the wrong value");
+        }
+        check.expect(Expression::compile("sin(pi / 2) * 2", nullptr).isConstant(),
+                     "a constant expression was not folded");
+        check.expect(!Expression::compile("t * 2", nullptr).isConstant(), "an input was folded as a constant");
+        for (const char *source : errors) {
+            check.expect(rejects(source, &layout), "a malformed expression compiled");
+        }
+        check.expect(rejects("counter", nullptr), "a field resolved without a layout");
+        check.expect(rejects(deep_parentheses, nullptr), "an overlong expression compiled");
+        check.expect(rejects(deep_unary, nullptr), "deeply nested unary operators compiled");
+        check.expect(rejects(deep_ternary, nullptr), "a deeply nested ternary compiled");
+        check.expect(rejects(nested_65, nullptr), "more than 64 levels of parentheses compiled");
+        check.expect(!rejects(nested_64, nullptr), "64 levels of parentheses were rejected");
+    }
+}
+BENCHMARK(BM_CheckExpressionCompiler)->Iterations(1);
+
+// Each generator kind must write the documented waveform into its field,
+// wrapping or saturating at the field's type range, and specs that do not
+// fit the dataset must be rejected.
+void BM_CheckPayloadGenerators(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    auto parsed = trdp::config::parseTrdpXmlConfig(trdp::bench::syntheticTrdpXml(1));
+    const auto layouts = trdp::stack::compileDatasets(parsed->datasets);
+    const auto layout = layouts.begin()->second;
+    std::vector<uint8_t> wire(layout->size, 0);
+    trdp::stack::writeElement(*layout->find("counter"), wire.data(), 0, uint64_t {41});
+
+    auto spec = [](const char *field, GeneratorKind kind) {
+        GeneratorSpec result;
+        result.field = field;
+        result.kind = kind;
+        return result;
+    };
+    // The element `field` holds after applying `spec` for each cycle in
+    // turn, as doubles.
+    auto run = [&](const GeneratorSpec &generator_spec, uint64_t cycles) {
+        trdp::stack::FieldGenerator generator(layout, generator_spec);
+        const auto target = layout->resolve(generator_spec.field);
+        std::vector<double> values;
+        for (uint64_t cycle = 0; cycle < cycles; ++cycle) {
+            generator.apply(wire.data(), cycle, static_cast<double>(cycle) * 0.1);
+            const auto value = trdp::stack::readElement(*target.field, wire.data(), target.index);
+            values.push_back(std::visit([](auto element) { return static_cast<double>(element); }, value));
+        }
+        return values;
+    };
+    auto rejects = [&](const GeneratorSpec &generator_spec) {
+        try {
+            trdp::stack::FieldGenerator generator(layout, generator_spec);
+        } catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    };
+
+    for (auto _ : state) {
+        auto wrapping = spec("status[0]", GeneratorKind::kCounter);
+        wrapping.start = 65533;
+        wrapping.step = 2;
+        check.expect(run(wrapping, 4) == std::vector<double> {65533, 65535, 1, 3},
+                     "a counter did not wrap at its field's type range");
+
+        auto ranged = spec("status[1]", GeneratorKind::kCounter);
+        ranged.start = 10;
+        ranged.min = 10;
+        ranged.max = 12;
+        check.expect(run(ranged, 5) == std::vector<double> {10, 11, 12, 10, 11},
+                     "a counter did not wrap within [min, max]");
+
+        auto sawtooth = spec("position[0]", GeneratorKind::kSawtooth);
+        sawtooth.max = 10;
+        sawtooth.period = 5;
+        check.expect(run(sawtooth, 6) == std::vector<double> {0, 2, 4, 6, 8, 0}, "a sawtooth did not ramp and restart");
+
+        auto sine = spec("speed[0]", GeneratorKind::kSine);
+        sine.min = -1;
+        sine.max = 1;
+        sine.period = 4;
+        const auto wave = run(sine, 4);
+        check.expect(std::fabs(wave[0]) < 1e-6 && std::fabs(wave[1] - 1) < 1e-6 && std::fabs(wave[2]) < 1e-6 &&
+                         std::fabs(wave[3] + 1) < 1e-6,
+                     "a sine did not oscillate between min and max");
+
+        auto random = spec("status[2]", GeneratorKind::kRandom);
+        random.min = 5;
+        random.max = 7;
+        for (double value : run(random, 200)) {
+            check.expect(value >= 5 && value <= 7 && value == std::floor(value),
+                         "a random value left [min, max] or was not an integer");
+        }
+
+        auto sequence = spec("status[3]", GeneratorKind::kSequence);
+        sequence.values = {3, -5, 70000};
+        check.expect(run(sequence, 4) == std::vector<double> {3, 0, 65535, 3},
+                     "a sequence did not repeat or saturate at its field's type range");
+
+        auto expression = spec("position[1]", GeneratorKind::kExpression);
+        expression.expression = "counter + cycle + t";
+        check.expect(run(expression, 3) == std::vector<double> {41, 42.1, 43.2},
+                     "an expression generator did not read the payload");
+
+        trdp::stack::FieldGenerator generator(layout, spec("status[2]", GeneratorKind::kCounter));
+        const auto *status = layout->find("status");
+        check.expect(generator.apply(wire.data(), 0, 0.0) ==
+                         std::pair<size_t, size_t> {status->offset + 2 * status->width, status->width},
+                     "apply() did not return the element's byte range");
+
+        auto empty_sequence = spec("status[0]", GeneratorKind::kSequence);
+        auto flat_sine = spec("speed[0]", GeneratorKind::kSine);
+        flat_sine.min = flat_sine.max = 1;
+        auto infinite = spec("speed[0]", GeneratorKind::kCounter);
+        infinite.step = INFINITY;
+        auto bad_expression = spec("speed[0]", GeneratorKind::kExpression);
+        bad_expression.expression = "1 +";
+        for (const auto &invalid : {spec("missing", GeneratorKind::kCounter), spec("speed", GeneratorKind::kCounter),
+                                    empty_sequence, flat_sine, infinite, bad_expression}) {
+            check.expect(rejects(invalid), "a generator that does not fit the dataset was accepted");
+        }
+        check.expect(trdp::stack::parseGeneratorKind("ramp") == GeneratorKind::kSawtooth &&
+                         !trdp::stack::parseGeneratorKind("square"),
+                     "generator kind names are not parsed as documented");
+    }
+}
+BENCHMARK(BM_CheckPayloadGenerators)->Iterations(1);
+
+}  // namespace
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/Hex.hpp"
+
+namespace {
+
+// 64 bytes is a typical PD dataset, 1432 the largest PD frame and 64 KiB an
+// MD message.
+void hexSizes(benchmark::internal::Benchmark *bench) {
+    bench->Arg(64)->Arg(1432)->Arg(65536);
+}
+
+std::vector<uint8_t> sampleBytes(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 131 + 7);
+    }
+    return bytes;
+}
+
+void BM_HexEncode(benchmark::State &state) {
+    const auto bytes = sampleBytes(static_cast<size_t>(state.range(0)));
+    std::string out(bytes.size() * 2, '\0');
+    for (auto _ : state) {
+        trdp::util::hexEncode(bytes.data(), bytes.size(), out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    state.SetLabel(trdp::util::hexKernelName());
+}
+BENCHMARK(BM_HexEncode)->Apply(hexSizes);
+
+void BM_HexDecode(benchmark::State &state) {
+    const auto bytes = sampleBytes(static_cast<size_t>(state.range(0)));
+    std::string hex(bytes.size() * 2, '\0');
+    trdp::util::hexEncode(bytes.data(), bytes.size(), hex.data());
+    std::vector<uint8_t> out(bytes.size());
+    for (auto _ : state) {
+        const bool ok = trdp::util::hexDecode(hex.data(), out.size(), out.data());
+        benchmark::DoNotOptimize(ok);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    state.SetLabel(trdp::util::hexKernelName());
+}
+BENCHMARK(BM_HexDecode)->Apply(hexSizes);
+
+}  // namespace
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "http/JsonUtils.hpp"
+#include "trdp/DatasetCodec.hpp"
+#include "trdp/TrdpEngine.hpp"
+#include "trdp/TrdpXmlParser.hpp"
+#include "util/LogService.hpp"
+
+namespace {
+
+using trdp::stack::PdMessagePtr;
+
+std::vector<PdMessagePtr> samplePdMessages(size_t count, bool with_layout) {
+    trdp::stack::DatasetLayoutPtr layout;
+    if (with_layout) {
+        auto parsed = trdp::config::parseTrdpXmlConfig(trdp::bench::syntheticTrdpXml(1));
+        layout = trdp::stack::compileDatasets(parsed->datasets).begin()->second;
+    }
+    std::vector<PdMessagePtr> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto message = std::make_shared<trdp::stack::PdMessage>();
+        message->id = static_cast<int>(i + 1);
+        message->name = "bench" + std::to_string(trdp::bench::kFirstComId + static_cast<int>(i));
+        message->cycle_time_ms = 100;
+        message->payload.assign(trdp::bench::kDatasetSize, static_cast<uint8_t>(i));
+        message->timestamp = "2024-01-01T00:00:00.000Z";
+        message->version = i + 1;
+        message->dataset = layout;
+        messages.push_back(std::move(message));
+    }
+    return messages;
+}
+
+// range(0): telegrams, range(1): 1 when the dataset layout is known so the
+// decoded fields are rendered too.
+void BM_PdListJson(benchmark::State &state) {
+    const auto messages = samplePdMessages(static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto json = trdp::http::json::pdListJson(messages, true);
+        bytes += json.size();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * messages.size()));
+}
+BENCHMARK(BM_PdListJson)->ArgsProduct({{100, 1000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+void BM_TrdpLogListJson(benchmark::State &state) {
+    std::vector<trdp::util::TrdpLogEntry> logs(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < logs.size(); ++i) {
+        auto &entry = logs[i];
+        entry.id = static_cast<int>(i + 1);
+        entry.direction = i % 2 == 0 ? "OUT" : "IN";
+        entry.type = "PD";
+        entry.msg_id = trdp::bench::kFirstComId + static_cast<int>(i % 100);
+        entry.src_ip = "10.0.1.1";
+        entry.dst_ip = "239.2.0.1";
+        entry.payload.assign(trdp::bench::kDatasetSize, static_cast<uint8_t>(i));
+        entry.timestamp = "2024-01-01 00:00:00";
+    }
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto json = trdp::http::json::trdpLogListJson(logs);
+        bytes += json.size();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * logs.size()));
+}
+BENCHMARK(BM_TrdpLogListJson)->Arg(100)->Arg(500)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
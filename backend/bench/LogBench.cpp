@@ -0,0 +1,559 @@
+#include <benchmark/benchmark.h>
+
+#include <sqlite3.h>
+
+#include <cstdlib>
+#include <atomic>
+#include <ctime>
+#include <filesystem>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "db/Database.hpp"
+#include "util/LogService.hpp"
+#include "util/TrdpLogPartitions.hpp"
+#include "util/TrdpLogWriter.hpp"
+
+namespace {
+
+// Ten million rows take about a minute to generate and 2 GB of disk;
+// TRDP_BENCH_LOG_ROWS selects a smaller table for quick runs.
+constexpr int64_t kDefaultLogRows = 10000000;
+// Rows are spread over time at this rate, starting at kFirstLogTime.
+constexpr int64_t kRowsPerSecond = 100;
+constexpr int64_t kFirstLogTime = 1700000000;
+constexpr int kSources = 16;
+
+int64_t logRows() {
+    const char *value = std::getenv("TRDP_BENCH_LOG_ROWS");
+    const long long rows = value != nullptr ? std::atoll(value) : 0;
+    return rows > 0 ? rows : kDefaultLogRows;
+}
+
+std::string formatTime(int64_t unix_seconds) {
+    const auto time = static_cast<std::time_t>(unix_seconds);
+    std::tm tm {};
+    gmtime_r(&time, &tm);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    return buffer;
+}
+
+// A database holding logRows() trdp_logs rows, built once per run. The rows
+// go into the main database's trdp_logs table, which LogService reads after
+// the (here absent) partition files. Every tenth row is MD, comIds cycle
+// through 100 values and sources through kSources addresses.
+trdp::db::Database &logDatabase() {
+    static std::unique_ptr<trdp::db::Database> database;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        database = std::make_unique<trdp::db::Database>(trdp::bench::scratchDatabase("trdp_bench_logs.db").string());
+        auto writer = database->writer();
+        sqlite3 *db = writer->handle();
+        sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db,
+                               "INSERT INTO trdp_logs (id, direction, type, msg_id, src_ip, dst_ip, payload, timestamp) "
+                               "VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db));
+        }
+        const int64_t rows = logRows();
+        uint8_t payload[trdp::bench::kDatasetSize] = {};
+        std::string source;
+        std::string timestamp;
+        for (int64_t i = 0; i < rows; ++i) {
+            payload[0] = static_cast<uint8_t>(i);
+            source = "10.0.1." + std::to_string(i % kSources + 1);
+            if (i % kRowsPerSecond == 0) {
+                timestamp = formatTime(kFirstLogTime + i / kRowsPerSecond);
+            }
+            sqlite3_bind_int64(stmt, 1, i + 1);
+            sqlite3_bind_text(stmt, 2, i % 3 == 0 ? "IN" : "OUT", -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 3, i % 10 == 0 ? "MD" : "PD", -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 4, trdp::bench::kFirstComId + static_cast<int>(i % 100));
+            sqlite3_bind_text(stmt, 5, source.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 6, "239.2.0.1", -1, SQLITE_STATIC);
+            sqlite3_bind_blob(stmt, 7, payload, sizeof(payload), SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 8, timestamp.c_str(), -1, SQLITE_STATIC);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    });
+    return *database;
+}
+
+// Rows in all trdp_logs partitions of the database at `database_path`.
+int64_t partitionRows(const std::filesystem::path &database_path) {
+    trdp::util::TrdpLogStorageOptions storage;
+    storage.directory = trdp::util::TrdpLogPartitions::defaultDirectory(database_path.string());
+    int64_t rows = 0;
+    for (const auto &partition : trdp::util::TrdpLogPartitions(storage).list()) {
+        sqlite3 *db = trdp::util::TrdpLogPartitions::openForReading(partition.path);
+        sqlite3_stmt *stmt = nullptr;
+        if (db != nullptr && sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM trdp_logs", -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW) {
+            rows += sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+    }
+    return rows;
+}
+
+// Number of newer rows in front of the requested page: range(0) per mille
+// of the table.
+int64_t pageDepth(const benchmark::State &state) {
+    return logRows() * state.range(0) / 1000;
+}
+
+void runPages(benchmark::State &state, trdp::util::LogService &logs, const trdp::util::TrdpLogQuery &query) {
+    size_t returned = 0;
+    for (auto _ : state) {
+        auto page = logs.getTrdpLogs(query);
+        returned = page.size();
+        benchmark::DoNotOptimize(page);
+    }
+    state.counters["rows"] = static_cast<double>(returned);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * returned));
+}
+
+// One page of 100 rows at increasing depth, skipped with `offset`; range(1)
+// adds the "type=MD" filter used by the log view. Filtered offsets count MD
+// rows only, so both variants start at the same place in the log.
+void BM_GetTrdpLogsOffset(benchmark::State &state) {
+    trdp::util::LogService logs(logDatabase());
+    trdp::util::TrdpLogQuery query;
+    query.offset = static_cast<int>(pageDepth(state) / (state.range(1) != 0 ? 10 : 1));
+    if (state.range(1) != 0) {
+        query.type = "MD";
+    }
+    runPages(state, logs, query);
+}
+BENCHMARK(BM_GetTrdpLogsOffset)
+    ->ArgsProduct({{0, 1, 10, 100, 500, 990}, {0, 1}})
+    ->ArgNames({"depth_permille", "filtered"})
+    ->Unit(benchmark::kMicrosecond);
+
+// The same pages reached with `before_id`, as a client paging through the
+// log does.
+void BM_GetTrdpLogsKeyset(benchmark::State &state) {
+    trdp::util::LogService logs(logDatabase());
+    trdp::util::TrdpLogQuery query;
+    query.before_id = logRows() - pageDepth(state) + 1;
+    if (state.range(1) != 0) {
+        query.type = "MD";
+    }
+    runPages(state, logs, query);
+}
+BENCHMARK(BM_GetTrdpLogsKeyset)
+    ->ArgsProduct({{0, 1, 10, 100, 500, 990}, {0, 1}})
+    ->ArgNames({"depth_permille", "filtered"})
+    ->Unit(benchmark::kMicrosecond);
+
+// The first page of the filters a user narrows the log down with:
+// 0 comId, 1 source, 2 comId and direction, 3 source and type, 4 one
+// minute in the middle of the log, 5 that minute and type MD.
+void BM_GetTrdpLogsFiltered(benchmark::State &state) {
+    trdp::util::LogService logs(logDatabase());
+    trdp::util::TrdpLogQuery query;
+    const int64_t middle = kFirstLogTime + logRows() / kRowsPerSecond / 2;
+    switch (state.range(0)) {
+        case 0:
+            query.msg_id = trdp::bench::kFirstComId + 42;
+            break;
+        case 1:
+            query.src_ip = "10.0.1.7";
+            break;
+        case 2:
+            query.msg_id = trdp::bench::kFirstComId + 42;
+            query.direction = "IN";
+            break;
+        case 3:
+            query.src_ip = "10.0.1.7";
+            query.type = "MD";
+            break;
+        case 4:
+            query.from = middle;
+            query.to = middle + 60;
+            break;
+        default:
+            query.from = middle;
+            query.to = middle + 60;
+            query.type = "MD";
+            break;
+    }
+    runPages(state, logs, query);
+}
+BENCHMARK(BM_GetTrdpLogsFiltered)->DenseRange(0, 5)->ArgName("filter")->Unit(benchmark::kMicrosecond);
+
+// Bursts four times the queue capacity: with drop-oldest (range(0) == 0)
+// every record must end up written or counted as dropped, with block
+// (range(0) == 1) all of them written. Either way the written ones must all
+// be in trdp_logs.
+void BM_CheckLogWriterAccounting(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_accounting.db");
+    trdp::util::TrdpLogWriterOptions options;
+    options.queue_capacity = 256;
+    options.batch_size = 64;
+    options.deduplicate_pd = false;
+    options.overflow_policy =
+        state.range(0) == 0 ? trdp::util::LogOverflowPolicy::kDropOldest : trdp::util::LogOverflowPolicy::kBlock;
+    trdp::util::TrdpLogWriter writer(scratch.database(), options);
+
+    const size_t burst = options.queue_capacity * 4;
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            payload[0] = static_cast<uint8_t>(i);
+            writer.enqueue("IN", "PD", trdp::bench::kFirstComId, "10.0.1.1", "239.2.0.1", payload, sizeof(payload));
+        }
+        writer.flush();
+    }
+
+    const auto stats = writer.stats();
+    const int64_t rows = partitionRows(scratch.path());
+    state.counters["written"] = static_cast<double>(stats.written);
+    state.counters["dropped"] = static_cast<double>(stats.dropped);
+    check.expect(stats.enqueued == state.iterations() * burst, "enqueued records were not all counted");
+    check.expect(stats.written + stats.dropped == stats.enqueued, "records were lost without being counted as dropped");
+    check.expect(options.overflow_policy != trdp::util::LogOverflowPolicy::kBlock || stats.dropped == 0,
+                 "the block policy dropped records");
+    check.expect(rows == static_cast<int64_t>(stats.written), "trdp_logs does not hold the written records");
+}
+BENCHMARK(BM_CheckLogWriterAccounting)->Arg(0)->Arg(1)->ArgName("block")->Iterations(4)->Unit(benchmark::kMillisecond);
+
+// The writer thread uses a connection of its own, never the application's:
+// while a transaction is open on Database::writer() it keeps writing, and
+// what it wrote survives that transaction's rollback. Flushing runs on a
+// helper thread so that a writer stuck behind the transaction fails the
+// check instead of hanging it.
+void BM_CheckLogWriterOwnConnection(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_own_connection.db");
+    trdp::util::TrdpLogWriterOptions options;
+    options.deduplicate_pd = false;
+    trdp::util::TrdpLogWriter writer(scratch.database(), options);
+
+    constexpr size_t kRecords = 100;
+    uint8_t payload[trdp::bench::kDatasetSize] = {};
+    uint64_t logged = 0;
+    for (auto _ : state) {
+        auto connection = scratch.database().writer();
+        if (!check.expect(sqlite3_exec(connection->handle(), "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) ==
+                              SQLITE_OK,
+                          "cannot open a transaction on the writer connection")) {
+            break;
+        }
+        for (size_t i = 0; i < kRecords; ++i) {
+            payload[0] = static_cast<uint8_t>(i);
+            writer.enqueue("IN", "PD", trdp::bench::kFirstComId, "10.0.1.1", "239.2.0.1", payload, sizeof(payload));
+        }
+        logged += kRecords;
+        auto flushed = std::async(std::launch::async, [&writer] { writer.flush(); });
+        check.expect(flushed.wait_for(std::chrono::seconds(2)) == std::future_status::ready,
+                     "the log writer waited for the application's transaction");
+        sqlite3_exec(connection->handle(), "ROLLBACK;", nullptr, nullptr, nullptr);
+        flushed.wait();
+    }
+
+    const auto stats = writer.stats();
+    check.expect(stats.written == logged, "records were not written while a transaction was open");
+    check.expect(partitionRows(scratch.path()) == static_cast<int64_t>(logged),
+                 "rolling back the application's transaction removed log rows");
+}
+BENCHMARK(BM_CheckLogWriterOwnConnection)->Iterations(2)->Unit(benchmark::kMillisecond);
+
+// Keyset paging over rows spread across hourly partitions, one of them
+// holding a single row and one hour missing, and older rows still in the
+// main database. With range(0) == 1 the span was switched from days to
+// hours late on one day and back early on the next, leaving daily files
+// that overlap hourly ones. Every query must return each matching row
+// exactly once, newest first, whatever the page size and however pages
+// fall on partition boundaries; unfiltered, offset pages must agree.
+void BM_CheckKeysetPagingAcrossPartitions(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_paging.db");
+    auto &database = scratch.database();
+    trdp::util::TrdpLogWriterOptions options;
+    options.storage.span = trdp::util::LogPartitionSpan::kHour;
+    options.storage.directory = trdp::util::TrdpLogPartitions::defaultDirectory(scratch.path().string());
+    const trdp::util::TrdpLogPartitions partitions(options.storage);
+    trdp::util::TrdpLogStorageOptions daily = options.storage;
+    daily.span = trdp::util::LogPartitionSpan::kDay;
+    const trdp::util::TrdpLogPartitions day_partitions(daily);
+    const bool mixed = state.range(0) != 0;
+
+    struct Row {
+        int64_t id;
+        bool md;
+        int64_t time;
+    };
+    std::vector<Row> rows;
+    // Mixed, first_hour is 20:00, so hours 4 to 6 fall on the next day.
+    const int64_t first_hour = mixed ? kFirstLogTime / 86400 * 86400 + 20 * 3600 : kFirstLogTime / 3600 * 3600;
+    // Rows per hour after first_hour; hour 0 is in the main database.
+    const int64_t hours[] = {250, 1234, 1, 0, 777, 300, 120};
+    // Mixed, these hours are in daily partitions: hour 1 before the
+    // switch to hours, hour 6 after the switch back.
+    const auto in_day_partition = [&](int64_t hour) { return mixed && (hour == 1 || hour == 6); };
+    const int64_t hour_count = mixed ? static_cast<int64_t>(std::size(hours)) : 5;
+    for (int64_t hour = 0; hour < hour_count; ++hour) {
+        if (hours[hour] == 0) {
+            continue;
+        }
+        std::optional<trdp::db::ConnectionLease> lease;
+        sqlite3 *partition = nullptr;
+        sqlite3 *db = nullptr;
+        if (hour == 0) {
+            lease.emplace(database.writer());
+            db = (*lease)->handle();
+        } else {
+            const auto &owner = in_day_partition(hour) ? day_partitions : partitions;
+            partition = trdp::util::TrdpLogPartitions::openForWriting(owner.partitionAt(first_hour + hour * 3600).path);
+            db = partition;
+        }
+        sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db,
+                               "INSERT INTO trdp_logs (id, direction, type, msg_id, src_ip, dst_ip, payload, timestamp) "
+                               "VALUES (?, 'IN', ?, ?, '10.0.1.1', '239.2.0.1', NULL, ?)",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db));
+        }
+        for (int64_t i = 0; i < hours[hour]; ++i) {
+            const Row row {static_cast<int64_t>(rows.size()) + 1, rows.size() % 7 == 0,
+                           first_hour + hour * 3600 + i * 3600 / hours[hour]};
+            const std::string timestamp = formatTime(row.time);
+            sqlite3_bind_int64(stmt, 1, row.id);
+            sqlite3_bind_text(stmt, 2, row.md ? "MD" : "PD", -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 3, trdp::bench::kFirstComId);
+            sqlite3_bind_text(stmt, 4, timestamp.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            rows.push_back(row);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+        sqlite3_close(partition);
+    }
+
+    struct Case {
+        int limit;
+        bool md;
+        bool window;
+    };
+    const Case cases[] = {{100, false, false}, {37, true, false}, {64, false, true}, {500, true, true}};
+    const int64_t from = first_hour + 3600 + 1800;
+    const int64_t to = first_hour + 4 * 3600 + 600;
+    trdp::util::LogService logs(database, options);
+    for (auto _ : state) {
+        for (const auto &test : cases) {
+            trdp::util::TrdpLogQuery query;
+            query.limit = test.limit;
+            if (test.md) {
+                query.type = "MD";
+            }
+            if (test.window) {
+                query.from = from;
+                query.to = to;
+            }
+            std::vector<int64_t> expected;
+            for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+                if ((!test.md || it->md) && (!test.window || (it->time >= from && it->time < to))) {
+                    expected.push_back(it->id);
+                }
+            }
+            std::vector<int64_t> keyset;
+            for (const auto &entry : trdp::bench::allLogs(logs, query)) {
+                keyset.push_back(entry.id);
+            }
+            check.expect(keyset == expected, "keyset pages do not return every matching row once, newest first");
+            if (!test.md && !test.window) {
+                std::vector<int64_t> offset;
+                for (;; query.offset += query.limit) {
+                    const auto page = logs.getTrdpLogs(query);
+                    if (page.empty()) {
+                        break;
+                    }
+                    for (const auto &entry : page) {
+                        offset.push_back(entry.id);
+                    }
+                }
+                check.expect(offset == expected, "offset pages disagree with keyset pages");
+            }
+        }
+    }
+    state.counters["rows"] = static_cast<double>(rows.size());
+}
+BENCHMARK(BM_CheckKeysetPagingAcrossPartitions)->Arg(0)
+    ->Arg(1)
+    ->ArgName("mixed")
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+// Two PD telegrams whose payloads change after runs of varying length,
+// with an MD record now and then. With deduplication each run must become
+// one row whose repeat_count is the run's length, in the order the runs
+// began, also when a run spans several batches or its payload repeats an
+// earlier run's; MD records keep a row each. Expanded, the rows must give
+// back every record.
+void BM_CheckLogWriterRuns(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_runs.db");
+    auto &database = scratch.database();
+    trdp::util::TrdpLogWriterOptions options;
+    options.queue_capacity = 256;
+    options.batch_size = 16;
+    options.overflow_policy = trdp::util::LogOverflowPolicy::kBlock;
+    trdp::util::TrdpLogWriter writer(database, options);
+
+    struct Row {
+        int msg_id;
+        const char *type;
+        uint8_t value;
+        int64_t repeat_count;
+    };
+    std::vector<Row> expected;
+    constexpr int kSteps = 4000;
+    for (auto _ : state) {
+        // Per telegram: the row of its open run, the run's number and how
+        // many records are left in it.
+        struct Telegram {
+            int msg_id;
+            int period;
+            size_t row;
+            int run;
+            int left;
+        } telegrams[] = {{trdp::bench::kFirstComId, 23, 0, -1, 0}, {trdp::bench::kFirstComId + 1, 11, 0, -1, 0}};
+        uint8_t payload[trdp::bench::kDatasetSize] = {};
+        for (int step = 0; step < kSteps; ++step) {
+            for (auto &telegram : telegrams) {
+                if (telegram.left == 0) {
+                    ++telegram.run;
+                    telegram.left = 1 + telegram.run * 7 % telegram.period;
+                    telegram.row = expected.size();
+                    expected.push_back({telegram.msg_id, "PD", static_cast<uint8_t>(telegram.run % 2), 0});
+                }
+                --telegram.left;
+                ++expected[telegram.row].repeat_count;
+                payload[0] = expected[telegram.row].value;
+                writer.enqueue("IN", "PD", telegram.msg_id, "10.0.1.1", "239.2.0.1", payload, sizeof(payload));
+            }
+            if (step % 40 == 0) {
+                payload[0] = expected[telegrams[0].row].value;
+                expected.push_back({telegrams[0].msg_id, "MD", payload[0], 1});
+                writer.enqueue("IN", "MD", telegrams[0].msg_id, "10.0.1.1", "239.2.0.1", payload, sizeof(payload));
+            }
+        }
+        writer.flush();
+    }
+
+    trdp::util::LogService logs(database, options);
+    trdp::util::TrdpLogQuery query;
+    query.limit = 500;
+    const auto rows = trdp::bench::allLogs(logs, query);
+    query.limit = 100;
+    query.expand_runs = true;
+    const auto records = trdp::bench::allLogs(logs, query);
+
+    const auto stats = writer.stats();
+    state.counters["rows"] = static_cast<double>(rows.size());
+    state.counters["records"] = static_cast<double>(stats.written);
+    bool rows_match = rows.size() == expected.size();
+    for (size_t i = 0; rows_match && i < rows.size(); ++i) {
+        const auto &row = rows[rows.size() - 1 - i];
+        rows_match = row.msg_id == expected[i].msg_id && row.type == expected[i].type && !row.payload.empty() &&
+                     row.payload[0] == expected[i].value && row.repeat_count == expected[i].repeat_count;
+    }
+    check.expect(stats.written == stats.enqueued && stats.dropped == 0, "records were not all written");
+    check.expect(rows_match, "the rows do not match the runs of equal payloads");
+    check.expect(stats.deduplicated == stats.written - rows.size(),
+                 "deduplicated does not count the records folded into runs");
+    check.expect(records.size() == stats.written, "expanded runs do not give back every record");
+}
+BENCHMARK(BM_CheckLogWriterRuns)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// A clock starting four seconds before an hour boundary and advancing 1 ms
+// per reading, so the records of BM_CheckLogIdsFollowTime straddle two
+// hourly partitions.
+std::atomic<int64_t> fake_clock_ms {0};
+
+std::chrono::system_clock::time_point fakeClock() {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(fake_clock_ms.fetch_add(1)));
+}
+
+// Two threads log PD records while the clock crosses an hour boundary. Row
+// ids must grow with timestamps across the two partitions, so paging with
+// `before_id` returns every record once with timestamps newest first, also
+// when the pages are limited to a window around the boundary.
+void BM_CheckLogIdsFollowTime(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    trdp::bench::ScratchDatabase scratch("trdp_bench_boundary.db");
+    const int64_t boundary = (kFirstLogTime / 3600 + 1) * 3600;
+    fake_clock_ms = (boundary - 4) * 1000;
+    trdp::util::TrdpLogWriterOptions options;
+    options.queue_capacity = 256;
+    options.batch_size = 32;
+    options.overflow_policy = trdp::util::LogOverflowPolicy::kBlock;
+    options.deduplicate_pd = false;
+    options.storage.span = trdp::util::LogPartitionSpan::kHour;
+    options.storage.directory = trdp::util::TrdpLogPartitions::defaultDirectory(scratch.path().string());
+    options.clock = &fakeClock;
+    constexpr int kRecordsPerThread = 4000;
+
+    for (auto _ : state) {
+        trdp::util::TrdpLogWriter writer(scratch.database(), options);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 2; ++t) {
+            producers.emplace_back([&writer, t] {
+                uint8_t payload[8] = {static_cast<uint8_t>(t)};
+                for (int i = 0; i < kRecordsPerThread; ++i) {
+                    payload[1] = static_cast<uint8_t>(i);
+                    writer.enqueue("IN", "PD", trdp::bench::kFirstComId + t, "10.0.1.1", "239.2.0.1", payload,
+                                   sizeof(payload));
+                }
+            });
+        }
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        writer.flush();
+        const auto stats = writer.stats();
+        check.expect(stats.written == stats.enqueued && stats.dropped == 0, "records were not all written");
+
+        trdp::util::LogService logs(scratch.database(), options);
+        check.expect(logs.trdpLogPartitions().size() == 2, "the records do not straddle two partitions");
+        trdp::util::TrdpLogQuery query;
+        query.limit = 97;
+        const auto rows = trdp::bench::allLogs(logs, query);
+        check.expect(rows.size() == stats.written, "keyset pages do not return every record");
+        for (size_t i = 1; i < rows.size(); ++i) {
+            check.expect(rows[i].id < rows[i - 1].id, "keyset pages are not in id order");
+            check.expect(rows[i].timestamp <= rows[i - 1].timestamp, "a row has a higher id than a newer row");
+        }
+
+        query.from = boundary - 1;
+        query.to = boundary + 1;
+        size_t in_window = 0;
+        for (const auto &row : rows) {
+            in_window += row.timestamp >= formatTime(boundary - 1) && row.timestamp < formatTime(boundary + 1) ? 1 : 0;
+        }
+        check.expect(in_window > 0 && trdp::bench::allLogs(logs, query).size() == in_window,
+                     "keyset pages over a window around the boundary miss rows");
+    }
+}
+BENCHMARK(BM_CheckLogIdsFollowTime)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
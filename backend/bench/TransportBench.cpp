@@ -0,0 +1,182 @@
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "network/NetworkConfigService.hpp"
+#include "trdp/TrdpWire.hpp"
+#include "trdp/UdpTransport.hpp"
+
+namespace {
+
+using trdp::stack::TrdpMessageType;
+using trdp::stack::UdpFrame;
+using trdp::stack::UdpIoBackend;
+using trdp::stack::UdpTransport;
+
+constexpr uint32_t kLoopback = 0x7f000001;
+constexpr size_t kBatch = 64;
+
+// Loopback PD round: queue a batch of 64-byte datasets, flush them with one
+// send call and read them back on a second transport. range(0) selects the
+// backend (0 epoll, 1 io_uring).
+void BM_UdpLoopback(benchmark::State &state) {
+    const auto backend = state.range(0) == 0 ? UdpIoBackend::kEpoll : UdpIoBackend::kIoUring;
+    trdp::network::NetworkConfig tx_cfg;
+    tx_cfg.local_ip = "127.0.0.1";
+    tx_cfg.pd_port = 18310;
+    tx_cfg.md_port = 18311;
+    auto rx_cfg = tx_cfg;
+    rx_cfg.pd_port = 18320;
+    rx_cfg.md_port = 18321;
+
+    UdpTransport tx;
+    UdpTransport rx;
+    std::string error;
+    if (!tx.open(tx_cfg, backend, error) || !rx.open(rx_cfg, backend, error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    if (rx.backend() != backend) {
+        state.SkipWithError(("io_uring unavailable: " + rx.fallbackReason()).c_str());
+        return;
+    }
+
+    uint8_t payload[64] = {};
+    uint64_t received = 0;
+    const auto handler = [](void *context, const UdpFrame &) { ++*static_cast<uint64_t *>(context); };
+    for (auto _ : state) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            tx.queuePd(static_cast<uint32_t>(1000 + i), kLoopback, rx.pdPort(), payload, sizeof(payload));
+        }
+        tx.flush();
+        const uint64_t target = received + kBatch;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        while (received < target && std::chrono::steady_clock::now() < deadline) {
+            rx.wait(&deadline, -1);
+            rx.receive(handler, &received);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(received));
+    state.counters["lost"] = static_cast<double>(state.iterations() * kBatch - received);
+}
+BENCHMARK(BM_UdpLoopback)->Arg(0)->Arg(1)->ArgName("io_uring")->UseRealTime();
+
+struct ReceivedFrame {
+    TrdpMessageType type;
+    uint32_t com_id;
+    uint32_t sequence;
+    std::vector<uint8_t> data;
+};
+
+// Sends `frame` to the loopback `port` from a plain socket, bypassing the
+// transport's framing.
+bool sendRaw(const uint8_t *frame, size_t size, uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(kLoopback);
+    address.sin_port = htons(port);
+    const auto sent = ::sendto(fd, frame, size, 0, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    ::close(fd);
+    return sent == static_cast<ssize_t>(size);
+}
+
+// PD and MD telegrams survive encode, send, receive and decode between two
+// transports byte for byte, with sequence counters kept per message type and
+// ComId, and a frame whose header no longer matches its FCS is dropped.
+// range(0) selects the backend as above; without io_uring the fallback is
+// checked instead.
+void BM_CheckUdpLoopback(benchmark::State &state) {
+    trdp::bench::Check check(state);
+    const auto backend = state.range(0) == 0 ? UdpIoBackend::kEpoll : UdpIoBackend::kIoUring;
+    trdp::network::NetworkConfig tx_cfg;
+    tx_cfg.local_ip = "127.0.0.1";
+    tx_cfg.pd_port = static_cast<uint16_t>(18340 + 4 * state.range(0));
+    tx_cfg.md_port = static_cast<uint16_t>(tx_cfg.pd_port + 1);
+    auto rx_cfg = tx_cfg;
+    rx_cfg.pd_port = static_cast<uint16_t>(tx_cfg.pd_port + 2);
+    rx_cfg.md_port = static_cast<uint16_t>(tx_cfg.pd_port + 3);
+
+    UdpTransport tx;
+    UdpTransport rx;
+    std::string error;
+    if (!check.expect(tx.open(tx_cfg, backend, error) && rx.open(rx_cfg, backend, error), "cannot open transports")) {
+        return;
+    }
+
+    std::vector<ReceivedFrame> received;
+    const auto handler = [](void *context, const UdpFrame &frame) {
+        static_cast<std::vector<ReceivedFrame> *>(context)->push_back(
+            {frame.frame.type, frame.frame.com_id, frame.frame.sequence,
+             std::vector<uint8_t>(frame.frame.data, frame.frame.data + frame.frame.size)});
+    };
+    auto receiveUntil = [&](size_t count) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+        while (received.size() < count && std::chrono::steady_clock::now() < deadline) {
+            rx.wait(&deadline, -1);
+            rx.receive(handler, &received);
+        }
+    };
+
+    for (auto _ : state) {
+        received.clear();
+        const std::vector<uint8_t> pd_data = {1, 2, 3, 4, 5, 6, 7, 8};
+        const std::vector<uint8_t> md_data(3000, 0x5a);
+        // Three PD frames on one ComId, two on another and one MD frame
+        // sharing the first ComId.
+        for (uint32_t com_id : {2001u, 2001u, 2002u, 2001u, 2002u}) {
+            tx.queuePd(com_id, kLoopback, rx.pdPort(), pd_data.data(), pd_data.size());
+        }
+        tx.queueMd(TrdpMessageType::kMdNotify, 2001, kLoopback, rx.mdPort(), md_data.data(), md_data.size());
+        tx.flush();
+        receiveUntil(6);
+        if (!check.expect(received.size() == 6, "not every frame came back")) {
+            break;
+        }
+
+        std::map<std::tuple<TrdpMessageType, uint32_t>, std::vector<uint32_t>> sequences;
+        for (const auto &frame : received) {
+            const bool is_pd = frame.type == TrdpMessageType::kPdData;
+            check.expect(is_pd || frame.type == TrdpMessageType::kMdNotify, "a frame changed its type");
+            check.expect(frame.data == (is_pd ? pd_data : md_data), "a dataset changed on the way");
+            sequences[{frame.type, frame.com_id}].push_back(frame.sequence);
+        }
+        check.expect(sequences[{TrdpMessageType::kPdData, 2001}] == std::vector<uint32_t>{0, 1, 2},
+                     "PD sequence numbers of ComId 2001 are off");
+        check.expect(sequences[{TrdpMessageType::kPdData, 2002}] == std::vector<uint32_t>{0, 1},
+                     "PD sequence numbers of ComId 2002 are off");
+        check.expect(sequences[{TrdpMessageType::kMdNotify, 2001}] == std::vector<uint32_t>{0},
+                     "MD shares a sequence counter with PD");
+
+        uint8_t frame[trdp::stack::kPdHeaderSize + 8];
+        const size_t size = trdp::stack::encodePdFrame(frame, TrdpMessageType::kPdData, 7, 2003, pd_data.data(),
+                                                       pd_data.size());
+        const uint64_t rejected = rx.stats().frames_rejected;
+        frame[11] ^= 0x01;  // low byte of the ComId
+        check.expect(sendRaw(frame, size, rx.pdPort()), "cannot send the corrupted frame");
+        frame[11] ^= 0x01;
+        check.expect(sendRaw(frame, size, rx.pdPort()), "cannot send the intact frame");
+        received.clear();
+        receiveUntil(1);
+        check.expect(received.size() == 1 && received.front().com_id == 2003, "the intact frame was not received");
+        check.expect(rx.stats().frames_rejected == rejected + 1, "a frame with a bad FCS was accepted");
+    }
+    state.SetLabel(std::string(trdp::stack::udpIoBackendName(rx.backend())));
+}
+BENCHMARK(BM_CheckUdpLoopback)->Arg(0)->Arg(1)->ArgName("io_uring")->Iterations(1)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchSupport.hpp"
+#include "trdp/TrdpXmlParser.hpp"
+
+namespace {
+
+void BM_ParseTrdpXmlConfig(benchmark::State &state) {
+    const auto telegrams = static_cast<size_t>(state.range(0));
+    const std::string xml = trdp::bench::syntheticTrdpXml(telegrams);
+    for (auto _ : state) {
+        std::string error;
+        auto parsed = trdp::config::parseTrdpXmlConfig(xml, &error);
+        if (!parsed || parsed->interfaces.front().telegrams.size() != telegrams) {
+            state.SkipWithError("synthetic configuration did not parse");
+            break;
+        }
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * xml.size()));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * telegrams));
+}
+BENCHMARK(BM_ParseTrdpXmlConfig)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -31,6 +32,9 @@ public:
     // cookie if present and valid.
     std::optional<User> userFromRequest(const httplib::Request &req);
 
+    // Number of logged-in sessions.
+    size_t sessionCount() const;
+
 private:
     void handleRegister(const httplib::Request &req, httplib::Response &res);
     void handleLogin(const httplib::Request &req, httplib::Response &res);
@@ -44,7 +48,7 @@ private:
     std::optional<std::string> sessionIdFromRequest(const httplib::Request &req);
 
     AuthService &auth_service_;
-    std::mutex session_mutex_;
+    mutable std::mutex session_mutex_;
     std::unordered_map<std::string, User> sessions_;
 };
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+namespace trdp::db {
+
+// A prepared statement borrowed from a Connection. Releasing it resets the
+// statement and clears its bindings, so the next borrower starts fresh.
+// Converts to sqlite3_stmt * for the sqlite3_bind_* / sqlite3_column_*
+// calls.
+class Statement {
+public:
+    Statement() = default;
+    ~Statement();
+
+    Statement(Statement &&other) noexcept;
+    Statement &operator=(Statement &&other) noexcept;
+    Statement(const Statement &) = delete;
+    Statement &operator=(const Statement &) = delete;
+
+    sqlite3_stmt *get() const noexcept { return stmt_; }
+    operator sqlite3_stmt *() const noexcept { return stmt_; }
+
+private:
+    friend class Connection;
+    Statement(sqlite3_stmt *stmt, bool *in_use) noexcept : stmt_(stmt), in_use_(in_use) {}
+    void release() noexcept;
+
+    sqlite3_stmt *stmt_ {nullptr};
+    // In-use flag of the cache entry; null for a statement of its own,
+    // which is finalized on release.
+    bool *in_use_ {nullptr};
+};
+
+// One SQLite connection and its prepared statements, cached by SQL text so
+// that repeated queries skip parsing and planning. A connection is used by
+// one thread at a time; Database hands them out through leases.
+class Connection {
+public:
+    // Statements kept per connection; SQL beyond that, typically queries
+    // assembled from optional filters, is prepared for each use.
+    static constexpr size_t kMaxCachedStatements = 64;
+
+    // Opens `path` with the sqlite3_open_v2 `flags`. Throws
+    // std::runtime_error on failure.
+    Connection(const std::string &path, int flags);
+    // Takes ownership of an open handle.
+    explicit Connection(sqlite3 *db) noexcept : db_(db) {}
+    ~Connection();
+
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    sqlite3 *handle() const noexcept { return db_; }
+
+    // The cached statement for `sql`, prepared on first use. While it is
+    // borrowed, the same SQL gets a statement of its own. Returns an empty
+    // Statement when the SQL does not compile.
+    Statement prepare(const std::string &sql);
+    // Runs SQL without a result, such as BEGIN or a PRAGMA. Throws
+    // std::runtime_error on failure.
+    void exec(const char *sql);
+
+private:
+    struct CachedStatement {
+        sqlite3_stmt *stmt {nullptr};
+        bool in_use {false};
+    };
+
+    sqlite3 *db_ {nullptr};
+    std::unordered_map<std::string, CachedStatement> statements_;
+};
+
+}  // namespace trdp::db
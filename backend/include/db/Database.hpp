@@ -1,26 +1,87 @@
 #pragma once
 
-#include <sqlite3.h>
-
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#include "db/Connection.hpp"
 
 namespace trdp::db {
 
+class Database;
+
+struct DatabaseOptions {
+    // Read-only connections handed out by Database::reader(). With 0, and
+    // always for an in-memory database, readers share the writer.
+    size_t readers {4};
+};
+
+// Exclusive use of one of the database's connections; it goes back to the
+// pool when the lease is destroyed. A thread must not ask for a second
+// lease while it holds one, or move a lease to another thread; debug
+// builds assert this.
+class ConnectionLease {
+public:
+    ~ConnectionLease();
+
+    ConnectionLease(ConnectionLease &&other) noexcept;
+    ConnectionLease(const ConnectionLease &) = delete;
+    ConnectionLease &operator=(const ConnectionLease &) = delete;
+    ConnectionLease &operator=(ConnectionLease &&) = delete;
+
+    Connection &operator*() const noexcept { return *connection_; }
+    Connection *operator->() const noexcept { return connection_; }
+
+private:
+    friend class Database;
+    ConnectionLease(Database *owner, Connection *connection) noexcept;
+
+    Database *owner_ {nullptr};
+    Connection *connection_ {nullptr};
+};
+
+// The application database. It runs in WAL mode with synchronous=NORMAL:
+// readers see the last committed transaction and never wait for the
+// writer, nor the writer for them, and a commit does not wait for fsync.
+// All writes go through one connection; queries use a pool of read-only
+// connections. Every connection caches its prepared statements.
 class Database {
 public:
-    explicit Database(const std::string &db_path);
+    explicit Database(const std::string &db_path, DatabaseOptions options = {});
     ~Database();
 
     Database(const Database &) = delete;
     Database &operator=(const Database &) = delete;
 
-    sqlite3 *handle() const noexcept { return db_; }
+    // The writer connection, held exclusively until the lease ends, so a
+    // transaction run through one lease never interleaves with other
+    // writes.
+    ConnectionLease writer();
+    // A read-only connection, opened on first need; waits while all
+    // `readers` are leased.
+    ConnectionLease reader();
+
+    const std::string &path() const noexcept { return db_path_; }
 
 private:
+    friend class ConnectionLease;
+    void release(Connection *connection) noexcept;
+
     void initializeSchema();
+    void addMissingColumn(const std::string &table, const std::string &column, const std::string &definition);
 
     std::string db_path_;
-    sqlite3 *db_ {nullptr};
+    DatabaseOptions options_;
+    std::unique_ptr<Connection> writer_;
+    std::mutex writer_mutex_;
+
+    std::mutex readers_mutex_;
+    std::condition_variable reader_released_;
+    std::vector<std::unique_ptr<Connection>> readers_;
+    std::vector<Connection *> idle_readers_;
 };
 
 }  // namespace trdp::db
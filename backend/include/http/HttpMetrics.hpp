@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "util/LatencyHistogram.hpp"
+#include "util/Metrics.hpp"
+
+namespace httplib {
+class Server;
+class Request;
+}
+
+namespace trdp::http {
+
+// Request counts and latency per route. install() hooks the server's
+// pre-routing handler and logger, which cpp-httplib runs on the thread that
+// serves the request, so the start time is kept thread-local. Latency runs
+// until the response has been written; for /api/stream that is the life of
+// the connection.
+//
+// Only requests that reached a handler are labelled with their route; all
+// others share the kUnmatched label, so the labels are bounded by the
+// routes registered rather than by what clients send.
+class HttpMetrics {
+public:
+    // Method and route of requests that no handler matched.
+    static constexpr std::string_view kUnmatched = "unmatched";
+
+    void install(httplib::Server &server);
+    void record(std::string_view method, std::string label, int status, int64_t latency_ns);
+    void appendTo(util::OpenMetricsWriter &writer) const;
+
+    // The route that served `req`: its path with the pattern's capture
+    // groups replaced by ":id", "/*" for the frontend, or kUnmatched when
+    // no handler matched.
+    static std::string routeLabel(const httplib::Request &req);
+
+private:
+    struct Route {
+        // Responses by status class, 1xx to 5xx.
+        std::array<util::ShardedCounter, 5> responses;
+        util::LatencyHistogram latency;
+    };
+
+    Route &routeFor(std::string_view method, std::string label);
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<Route>> routes_;
+};
+
+}  // namespace trdp::http
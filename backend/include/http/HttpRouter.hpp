@@ -3,6 +3,9 @@
 #include <optional>
 #include <string>
 
+#include "http/HttpMetrics.hpp"
+#include "http/StreamBroadcaster.hpp"
+
 namespace httplib {
 class Server;
 class Request;
@@ -44,10 +47,17 @@ public:
 
     void registerRoutes(httplib::Server &server);
 
+    // Concurrent /api/stream connections; each holds an HTTP worker thread
+    // for as long as it is open, so the server's pool needs this many
+    // threads on top of those serving the REST API.
+    size_t maxStreams() const noexcept { return stream_broadcaster_.maxSubscribers(); }
+
 private:
     void registerHealthEndpoint(httplib::Server &server);
+    void registerMetricsEndpoint(httplib::Server &server);
     void registerNetworkConfigEndpoints(httplib::Server &server);
     void registerTrdpEngineEndpoints(httplib::Server &server);
+    void registerStreamEndpoints(httplib::Server &server);
     void registerLogEndpoints(httplib::Server &server);
     void registerAccountEndpoints(httplib::Server &server);
     void registerFrontendEndpoints(httplib::Server &server);
@@ -67,6 +77,8 @@ private:
     network::NetworkConfigService &network_config_service_;
     stack::TrdpEngine &trdp_engine_;
     util::LogService &log_service_;
+    HttpMetrics http_metrics_;
+    StreamBroadcaster stream_broadcaster_;
 
     bool frontend_available_{false};
     std::string frontend_root_;
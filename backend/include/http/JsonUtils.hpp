@@ -2,13 +2,19 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace trdp::stack {
 struct PdMessage;
+struct PdDelta;
 struct MdMessage;
+struct PdFieldUpdate;
+struct GeneratorSpec;
+struct PdTimingStats;
 }
 
 namespace trdp::auth {
@@ -18,6 +24,10 @@ struct User;
 namespace trdp::util {
 struct TrdpLogEntry;
 struct AppLogEntry;
+struct LatencySnapshot;
+struct RollupEntry;
+struct LogPartition;
+struct TrdpLogStorageOptions;
 }
 
 namespace trdp::http::json {
@@ -29,6 +39,14 @@ std::optional<std::string> stringField(const std::string &body, const std::strin
 std::optional<int> intField(const std::string &body, const std::string &field_name);
 std::optional<std::vector<std::string>> stringArrayField(const std::string &body,
                                                          const std::string &field_name);
+// Parses a field PATCH body, {"fields": {"name": value, ...}}, where a value
+// is a number, a boolean, a string (CHAR8 fields) or an array of numbers and
+// booleans. Returns nullopt for malformed JSON or a missing "fields" object.
+std::optional<std::vector<stack::PdFieldUpdate>> pdFieldUpdates(const std::string &body);
+// Parses {"generators": [{"field": ..., "type": ..., "start", "step", "min",
+// "max", "period", "values", "expression"}, ...]}; omitted settings keep
+// their defaults.
+std::optional<std::vector<stack::GeneratorSpec>> pdGeneratorSpecs(const std::string &body);
 std::optional<std::vector<uint8_t>> parseHex(const std::string &hex);
 std::optional<std::vector<uint8_t>> hexToBlob(const std::string &hex);
 std::string bytesToHex(const std::vector<uint8_t> &data);
@@ -36,14 +54,30 @@ std::string blobToHex(const void *data, size_t size);
 std::string payloadAscii(const std::vector<uint8_t> &data);
 std::string endpointIp(const std::string &endpoint);
 
-std::string pdListJson(const std::vector<stack::PdMessage> &messages, bool include_cycle_time);
+std::string pdListJson(const std::vector<std::shared_ptr<const stack::PdMessage>> &messages, bool include_cycle_time);
+std::string pdDeltaJson(const stack::PdDelta &delta, bool include_cycle_time);
 std::string pdDetailJson(const stack::PdMessage &message);
+std::string pdFieldsJson(const stack::PdMessage &message);
+std::string pdGeneratorsJson(int msg_id, const std::vector<stack::GeneratorSpec> &specs);
 std::string mdIncomingListJson(const std::vector<stack::MdMessage> &messages);
 std::string mdSendResponseJson(const stack::MdMessage &message);
 std::string trdpLogListJson(const std::vector<util::TrdpLogEntry> &logs);
 std::string appLogListJson(const std::vector<util::AppLogEntry> &logs);
 std::string userJson(const auth::User &user);
 std::string userListJson(const std::vector<auth::User> &users);
+// {"clock": ..., "latency": {"count", "mean_ns", "min_ns", "p50_ns", "p90_ns",
+// "p99_ns", "p999_ns", "max_ns"}}
+std::string receiveLatencyJson(std::string_view clock, const util::LatencySnapshot &latency);
+// {"telegrams": [...]} with the histogram summaries that apply to each
+// telegram's direction, in the same shape as "latency" above.
+std::string pdTimingListJson(const std::vector<stack::PdTimingStats> &telegrams);
+// {"resolution_s": N, "buckets": [...]}; inter-arrival gaps are null for
+// buckets with a single packet.
+std::string rollupListJson(int resolution_s, const std::vector<util::RollupEntry> &rollups);
+// {"span": "hour"|"day", "max_age_hours": N, "max_bytes": N, "partitions":
+// [{"file", "start", "end", "bytes"}]}, oldest partition first.
+std::string logPartitionListJson(const util::TrdpLogStorageOptions &storage,
+                                 const std::vector<util::LogPartition> &partitions);
 
 }  // namespace trdp::http::json
 
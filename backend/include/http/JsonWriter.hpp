@@ -0,0 +1,77 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace trdp::http::json {
+
+// Appends `size` bytes as lowercase hex digits to `out`.
+void appendHex(std::string &out, const uint8_t *data, size_t size);
+
+// Appends `value` to `out` with JSON string escaping (no surrounding quotes).
+void appendEscaped(std::string &out, std::string_view value);
+
+// JsonWriter serializes straight into one growing buffer: strings are escaped
+// through a lookup table, integers are formatted with std::to_chars and hex
+// payloads are encoded in place, so no per-field temporaries are created.
+// Commas between members and elements are inserted automatically. Reusing a
+// writer after clear() keeps the buffer's capacity.
+class JsonWriter {
+public:
+    JsonWriter() = default;
+    explicit JsonWriter(size_t reserve_bytes) { buffer_.reserve(reserve_bytes); }
+
+    JsonWriter &beginObject();
+    JsonWriter &endObject();
+    JsonWriter &beginArray();
+    JsonWriter &endArray();
+
+    // Writes the member name of the next value inside an object.
+    JsonWriter &key(std::string_view name);
+
+    JsonWriter &value(std::string_view text);
+    JsonWriter &value(const std::string &text) { return value(std::string_view(text)); }
+    JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+    JsonWriter &value(bool flag);
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    JsonWriter &value(T number) {
+        separate();
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        buffer_.append(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+    // Shortest round-trip form; NaN and infinities are written as null.
+    JsonWriter &value(double number);
+    JsonWriter &nullValue();
+
+    // Writes `data` as a quoted lowercase hex string.
+    JsonWriter &hexValue(const uint8_t *data, size_t size);
+    JsonWriter &hexValue(const std::vector<uint8_t> &data) { return hexValue(data.data(), data.size()); }
+
+    // Inserts an already serialized JSON value verbatim.
+    JsonWriter &rawValue(std::string_view json);
+
+    void clear();
+    void reserve(size_t bytes) { buffer_.reserve(bytes); }
+    std::string_view view() const { return buffer_; }
+    std::string take() { return std::move(buffer_); }
+
+private:
+    void separate();
+    void open(char bracket);
+    void close(char bracket);
+
+    std::string buffer_;
+    // One bit per open container (64 levels), set once it holds a member.
+    uint64_t has_members_ {0};
+    int depth_ {0};
+    bool after_key_ {false};
+};
+
+}  // namespace trdp::http::json
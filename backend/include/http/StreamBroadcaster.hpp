@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trdp/TrdpEngine.hpp"
+
+namespace trdp::http {
+
+// Builds the frames of the /api/stream Server-Sent Events feed once for all
+// connections. While anyone is subscribed, a single thread collects the PD
+// and MD changes every kTick and keeps them for kHistoryTicks ticks. A
+// subscriber with an interval of k ticks is served on every tick divisible
+// by k with one frame covering the ticks since its previous one, in which a
+// comId that changed several times appears once with its latest value.
+// Subscribers with the same interval receive the same frame object, so the
+// engine is queried and the JSON serialized once per tick, not once per
+// connection.
+class StreamBroadcaster {
+public:
+    static constexpr std::chrono::milliseconds kTick {50};
+    static constexpr size_t kHistoryTicks = 100;
+    static constexpr size_t kDefaultMaxSubscribers = 8;
+
+    class Subscription;
+
+    explicit StreamBroadcaster(stack::TrdpEngine &engine, size_t max_subscribers = kDefaultMaxSubscribers);
+    ~StreamBroadcaster();
+
+    StreamBroadcaster(const StreamBroadcaster &) = delete;
+    StreamBroadcaster &operator=(const StreamBroadcaster &) = delete;
+
+    // Null once max_subscribers are subscribed. `interval` is rounded up to
+    // whole ticks and limited to kHistoryTicks of them.
+    std::unique_ptr<Subscription> subscribe(std::chrono::milliseconds interval);
+
+    size_t subscribers() const;
+    size_t maxSubscribers() const noexcept { return max_subscribers_; }
+    // Frames serialized so far; each may have been sent to many subscribers.
+    uint64_t framesBuilt() const;
+
+private:
+    struct Subscriber {
+        uint64_t interval_ticks {1};
+        // Tick the last frame covered up to; 0 before the first frame, which
+        // holds the complete PD lists.
+        uint64_t last_tick {0};
+        // Id of the newest MD message delivered.
+        int md_id {0};
+        std::shared_ptr<const std::string> pending;
+    };
+
+    // Changes collected on one tick. A delta with `reset` set holds the
+    // complete list.
+    struct Tick {
+        uint64_t number {0};
+        stack::PdDelta outgoing;
+        stack::PdDelta incoming;
+        std::vector<stack::MdMessage> md;
+    };
+
+    void run();
+    void collectLocked(std::unique_lock<std::mutex> &lock);
+    void publishLocked();
+    std::shared_ptr<const std::string> snapshotFrame(int md_id);
+    std::shared_ptr<const std::string> deltaFrame(uint64_t from_tick);
+    std::shared_ptr<const std::string> next(Subscriber &subscriber, std::chrono::milliseconds timeout);
+    void unsubscribe(std::list<Subscriber>::iterator subscriber);
+
+    stack::TrdpEngine &engine_;
+    const size_t max_subscribers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable frame_ready_;
+    std::list<Subscriber> subscribers_;
+    std::deque<Tick> history_;
+    uint64_t tick_ {0};
+    uint64_t pd_outgoing_version_ {0};
+    uint64_t pd_incoming_version_ {0};
+    int md_id_ {0};
+    uint64_t frames_built_ {0};
+    bool stopping_ {false};
+
+    std::thread thread_;
+};
+
+// One connection's place in the stream; unsubscribes when destroyed.
+class StreamBroadcaster::Subscription {
+public:
+    ~Subscription();
+
+    Subscription(const Subscription &) = delete;
+    Subscription &operator=(const Subscription &) = delete;
+
+    // Waits up to `timeout` for this subscriber's next frame. Null on
+    // timeout, when nothing changed, and when the broadcaster shuts down.
+    std::shared_ptr<const std::string> next(std::chrono::milliseconds timeout);
+
+private:
+    friend class StreamBroadcaster;
+    Subscription(StreamBroadcaster &owner, std::list<Subscriber>::iterator subscriber) noexcept
+        : owner_(owner), subscriber_(subscriber) {}
+
+    StreamBroadcaster &owner_;
+    std::list<Subscriber>::iterator subscriber_;
+};
+
+}  // namespace trdp::http
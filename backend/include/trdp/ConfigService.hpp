@@ -51,10 +51,9 @@ private:
 
     std::optional<long long> requireUserId(const httplib::Request &req, httplib::Response &res);
     static std::optional<std::string> extractJsonField(const std::string &body, const std::string &field_name);
-    static std::string escapeJson(const std::string &value);
     static std::string jsonError(const std::string &message);
-    static std::string serializeConfigMetadata(const TrdpConfig &config);
-    static std::string serializeConfigWithXml(const TrdpConfig &config);
+    static std::string serializeConfigList(const std::vector<TrdpConfig> &configs);
+    static std::string serializeConfigResponse(const TrdpConfig &config);
     static std::string serializePlanSections(const std::vector<TrdpPlanSection> &sections);
     bool loadConfigIntoEngine(const TrdpConfig &config);
 
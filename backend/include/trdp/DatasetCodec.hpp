@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace trdp::config {
+struct TrdpDatasetDefinition;
+}
+
+namespace trdp::stack {
+
+// TRDP element types with their IEC 61375-2-3 type ids.
+enum class FieldType : uint8_t {
+    kBool8 = 1,
+    kChar8 = 2,
+    kUtf16 = 3,
+    kInt8 = 4,
+    kInt16 = 5,
+    kInt32 = 6,
+    kInt64 = 7,
+    kUInt8 = 8,
+    kUInt16 = 9,
+    kUInt32 = 10,
+    kUInt64 = 11,
+    kReal32 = 12,
+    kReal64 = 13,
+    kTimeDate32 = 14,
+    kTimeDate48 = 15,
+    kTimeDate64 = 16,
+};
+
+// How a field's bytes are interpreted once in host byte order. TIMEDATE
+// types are exposed as the unsigned integer formed by their wire bytes.
+enum class FieldKind : uint8_t { kBool, kChar, kSigned, kUnsigned, kReal };
+
+// Accepts the XML type names (case-insensitive, e.g. "UINT32", "string") and
+// numeric type ids.
+std::optional<FieldType> parseFieldType(std::string_view name);
+std::string_view fieldTypeName(FieldType type);
+
+struct DatasetField {
+    // Nested dataset members are flattened to "outer.inner" / "outer[2].inner".
+    std::string name;
+    FieldType type {FieldType::kUInt8};
+    FieldKind kind {FieldKind::kUnsigned};
+    uint32_t offset {0};
+    // Bytes per element and element count; CHAR8 arrays are strings.
+    uint16_t width {1};
+    uint32_t count {1};
+
+    size_t size() const noexcept { return static_cast<size_t>(width) * count; }
+};
+
+// Consecutive multi-byte elements of one width, byte-swapped in one pass.
+struct SwapRun {
+    uint32_t offset {0};
+    uint16_t width {0};
+    uint32_t count {0};
+};
+
+// One field, or a single element of an array field, within a layout.
+struct FieldRef {
+    const DatasetField *field {nullptr};
+    uint32_t index {0};
+    uint32_t count {0};
+
+    explicit operator bool() const noexcept { return field != nullptr; }
+};
+
+// A dataset compiled to wire offsets. TRDP payloads are packed big-endian,
+// so converting a payload is a copy plus the precomputed swap runs, and
+// reading a field is a lookup at a fixed offset.
+struct DatasetLayout {
+    int dataset_id {0};
+    std::string name;
+    size_t size {0};
+    std::vector<DatasetField> fields;
+    // Empty on big-endian hosts.
+    std::vector<SwapRun> swap_runs;
+
+    const DatasetField *find(std::string_view field_name) const;
+    // Accepts a field name or "name[index]" for one element of an array field.
+    FieldRef resolve(std::string_view reference) const;
+};
+
+using DatasetLayoutPtr = std::shared_ptr<const DatasetLayout>;
+using DatasetLayouts = std::unordered_map<int, DatasetLayoutPtr>;
+
+// Compiles every dataset, resolving element types that name another dataset
+// (by id or name) by flattening it in place. Datasets that cannot be
+// compiled, such as recursive ones or those with variable-size arrays, are
+// left out and described in `errors`.
+DatasetLayouts compileDatasets(const std::vector<config::TrdpDatasetDefinition> &definitions,
+                               std::vector<std::string> *errors = nullptr);
+
+// Copies a wire payload into `host` (layout.size bytes) with every
+// multi-byte field in host byte order. Missing trailing bytes read as zero.
+void wireToHost(const DatasetLayout &layout, const uint8_t *wire, size_t wire_size, uint8_t *host);
+// Writes layout.size wire bytes from a host-order image.
+void hostToWire(const DatasetLayout &layout, const uint8_t *host, uint8_t *wire);
+
+// Element values widened to 64 bits.
+using FieldScalar = std::variant<int64_t, uint64_t, double>;
+
+// Accessors for host-order images; `index` must be below field.count.
+FieldScalar loadElement(const DatasetField &field, const uint8_t *host, uint32_t index);
+// Returns false when `value` is not representable in the field's type.
+bool storeElement(const DatasetField &field, uint8_t *host, uint32_t index, const FieldScalar &value);
+// The same accessors working directly on big-endian wire bytes, so a single
+// element can be read or patched without converting the whole payload.
+FieldScalar readElement(const DatasetField &field, const uint8_t *wire, uint32_t index);
+bool writeElement(const DatasetField &field, uint8_t *wire, uint32_t index, const FieldScalar &value);
+// Encodes one element's wire bytes (field.width of them) into `element`.
+bool encodeElement(const DatasetField &field, const FieldScalar &value, uint8_t *element);
+// CHAR8 fields (byte order does not apply, so these serve host and wire
+// buffers alike): text up to the first NUL / NUL-padded text, false if too long.
+std::string_view loadText(const DatasetField &field, const uint8_t *data);
+bool storeText(const DatasetField &field, uint8_t *data, std::string_view text);
+
+}  // namespace trdp::stack
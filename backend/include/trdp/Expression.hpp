@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "trdp/DatasetCodec.hpp"
+
+namespace trdp::stack {
+
+// An arithmetic expression compiled once into register bytecode, e.g.
+// "20 + 5 * sin(t)" or "(status & 0x4) != 0". Constant subexpressions are
+// folded at compile time, so evaluation only executes the parts that depend
+// on its inputs.
+//
+// Operators, lowest precedence first: ?:, ||, &&, |, ^, &, == !=,
+// < <= > >=, << >>, + -, * / %, and the unary - ! ~. Bitwise operators work
+// on the operands truncated to 64-bit integers; comparisons and logical
+// operators yield 1 or 0. Functions: sin cos tan asin acos atan atan2 sqrt
+// abs floor ceil round exp log pow min max clamp fmod.
+//
+// Identifiers name dataset fields ("speed", "door[1]", "hb.counter") or the
+// inputs `cycle` (publish cycles so far) and `t` (seconds, counted in whole
+// cycles); `pi` and `e` are constants.
+class Expression {
+public:
+    // Returns the constant 0.
+    Expression();
+
+    // Throws std::invalid_argument describing the first error and its
+    // position. Field references resolve against `layout`, which must
+    // outlive the expression; without a layout only the inputs are known.
+    // Sources over 4096 characters or nested more than 64 parentheses deep
+    // are rejected.
+    static Expression compile(std::string_view source, const DatasetLayout *layout);
+
+    // `wire` is the payload the field references read from; it may be null
+    // when the expression does not reference fields.
+    double evaluate(const uint8_t *wire, uint64_t cycle, double seconds) const;
+
+    bool isConstant() const noexcept { return code_.size() == 1 && code_.front().op == Op::kConst; }
+    bool readsFields() const noexcept { return !fields_.empty(); }
+
+    enum class Op : uint8_t {
+        kConst,
+        kField,
+        kCycle,
+        kTime,
+        kNeg,
+        kNot,
+        kBitNot,
+        kSin,
+        kCos,
+        kTan,
+        kAsin,
+        kAcos,
+        kAtan,
+        kSqrt,
+        kAbs,
+        kFloor,
+        kCeil,
+        kRound,
+        kExp,
+        kLog,
+        kAdd,
+        kSub,
+        kMul,
+        kDiv,
+        kMod,
+        kPow,
+        kMin,
+        kMax,
+        kAtan2,
+        kLess,
+        kLessEqual,
+        kGreater,
+        kGreaterEqual,
+        kEqual,
+        kNotEqual,
+        kAnd,
+        kOr,
+        kBitAnd,
+        kBitOr,
+        kBitXor,
+        kShiftLeft,
+        kShiftRight,
+        kSelect,
+    };
+
+    // registers[dst] = op(registers[a], registers[b], registers[c]); kConst
+    // and kField take `index` into the constant and field tables instead.
+    struct Instruction {
+        Op op {Op::kConst};
+        uint8_t dst {0};
+        uint8_t a {0};
+        uint8_t b {0};
+        uint8_t c {0};
+        uint32_t index {0};
+    };
+
+    static constexpr size_t kMaxRegisters = 32;
+
+private:
+    friend class ExpressionCompiler;
+
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::vector<FieldRef> fields_;
+};
+
+}  // namespace trdp::stack
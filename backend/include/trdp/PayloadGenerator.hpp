@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "trdp/DatasetCodec.hpp"
+#include "trdp/Expression.hpp"
+
+namespace trdp::stack {
+
+enum class GeneratorKind : uint8_t { kCounter, kSawtooth, kSine, kRandom, kSequence, kExpression };
+
+// Accepts "counter", "sawtooth" (or "ramp"), "sine", "random", "sequence" and
+// "expression".
+std::optional<GeneratorKind> parseGeneratorKind(std::string_view name);
+std::string_view generatorKindName(GeneratorKind kind);
+
+// How one dataset element changes from cycle to cycle. Periods count publish
+// cycles, not milliseconds, so the waveform follows the telegram's rate.
+//   counter:  start + step * cycle, wrapping within [min, max] when max > min
+//             and at the field's type range otherwise
+//   sawtooth: rises from min towards max over `period` cycles, then restarts
+//   sine:     oscillates between min and max with the given period
+//   random:   uniform in [min, max]
+//   sequence: steps through `values`, then repeats
+//   expression: evaluates `expression` (see Expression), which may read
+//             other fields of the payload being published
+struct GeneratorSpec {
+    std::string field;
+    GeneratorKind kind {GeneratorKind::kCounter};
+    double start {0.0};
+    double step {1.0};
+    double min {0.0};
+    double max {0.0};
+    uint32_t period {10};
+    std::vector<double> values;
+    std::string expression;
+};
+
+// A generator bound to one element of a compiled dataset. Values are written
+// straight into the big-endian wire payload, so evaluating a generator is a
+// few arithmetic operations and a store of field.width bytes.
+class FieldGenerator {
+public:
+    // Throws std::invalid_argument when the spec does not fit the layout,
+    // e.g. for unknown, text or whole-array fields or an empty sequence.
+    FieldGenerator(DatasetLayoutPtr layout, GeneratorSpec spec);
+
+    const GeneratorSpec &spec() const noexcept { return spec_; }
+
+    // Writes the value for publish cycle `cycle` (`seconds` of nominal time
+    // into the run) into `wire`, which holds at least layout->size bytes, and
+    // returns the (offset, length) range it touched.
+    std::pair<size_t, size_t> apply(uint8_t *wire, uint64_t cycle, double seconds);
+
+private:
+    FieldScalar counterValue(uint64_t cycle) const;
+    FieldScalar fromReal(double value) const;
+
+    DatasetLayoutPtr layout_;
+    GeneratorSpec spec_;
+    const DatasetField *field_ {nullptr};
+    uint32_t index_ {0};
+    Expression expression_;
+    std::mt19937_64 random_;
+};
+
+}  // namespace trdp::stack
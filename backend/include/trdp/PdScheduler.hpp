@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace trdp::stack {
+
+// PdScheduler keeps the publish deadlines of cyclic PD telegrams in a
+// min-heap so the engine can sleep until the earliest deadline instead of
+// polling every telegram. Rescheduling an id lazily invalidates its previous
+// heap entry. The class is not thread-safe; the engine guards it with its
+// state mutex.
+class PdScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct DueEntry {
+        int id {0};
+        TimePoint deadline;
+    };
+
+    void schedule(int id, TimePoint deadline);
+    void clear();
+
+    // Removes every entry whose deadline is at or before `now` and appends it
+    // to `out` in deadline order.
+    void collectDue(TimePoint now, std::vector<DueEntry> &out);
+    std::optional<TimePoint> nextDeadline();
+
+    // Advances `deadline` by whole periods so that the result lies after
+    // `now`, keeping the original phase instead of re-basing on `now`.
+    static TimePoint advance(TimePoint deadline, std::chrono::milliseconds period, TimePoint now);
+
+private:
+    struct Entry {
+        TimePoint deadline;
+        int id {0};
+        uint64_t generation {0};
+    };
+
+    struct Later {
+        bool operator()(const Entry &lhs, const Entry &rhs) const { return lhs.deadline > rhs.deadline; }
+    };
+
+    bool isCurrent(const Entry &entry) const;
+    void dropStale();
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> heap_;
+    std::unordered_map<int, uint64_t> generations_;
+    uint64_t next_generation_ {1};
+};
+
+}  // namespace trdp::stack
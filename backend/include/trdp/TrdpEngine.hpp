@@ -1,17 +1,32 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "network/NetworkConfigService.hpp"
+#include "trdp/DatasetCodec.hpp"
+#include "trdp/PayloadGenerator.hpp"
+#include "trdp/PdScheduler.hpp"
 #include "trdp/TrdpConfigService.hpp"
+#include "trdp/TrdpWire.hpp"
+#include "trdp/UdpTransport.hpp"
+#include "util/LatencyHistogram.hpp"
+#include "util/Metrics.hpp"
+#include "util/TrafficRollup.hpp"
+#include "util/TrdpLogWriter.hpp"
 
 namespace trdp::db {
 class Database;
@@ -23,12 +38,63 @@ struct TrdpXmlConfig;
 
 namespace trdp::stack {
 
+// Largest PD dataset a single TRDP process data frame can carry.
+constexpr size_t kMaxPdPayloadSize = kMaxPdDatasetSize;
+
 struct PdMessage {
     int id {0};
     std::string name;
     int cycle_time_ms {0};
     std::vector<uint8_t> payload;
     std::string timestamp;
+    // Engine-wide change counter value of the last payload update.
+    uint64_t version {0};
+    // Compiled layout of the telegram's dataset; null when the configuration
+    // does not describe it and the payload is opaque.
+    DatasetLayoutPtr dataset;
+};
+
+// Immutable PD state shared between the engine and its readers. A new
+// instance is published for every change, so holders never see it mutate.
+using PdMessagePtr = std::shared_ptr<const PdMessage>;
+
+// Telegrams whose payload changed after a version cursor; receiving or
+// sending the same bytes again does not count as a change. `version` is the
+// high-water mark to pass back on the next query; `reset` means the
+// configuration was reloaded after the cursor, so `messages` is the
+// complete list.
+struct PdDelta {
+    uint64_t version {0};
+    bool reset {false};
+    std::vector<PdMessagePtr> messages;
+};
+
+// A new value for one dataset field, see updateOutgoingPdFields(). `name` is
+// a field name or "name[index]" for a single element of an array field.
+// Numeric fields take one value per addressed element; CHAR8 fields may take
+// `text` instead.
+struct PdFieldUpdate {
+    std::string name;
+    std::vector<FieldScalar> values;
+    std::optional<std::string> text;
+};
+
+// Timing of one PD telegram since the configuration was loaded; durations
+// are nanoseconds. Publishers fill `interval_deviation`, the difference
+// between consecutive cyclic sends and the cycle time (early and late alike);
+// the first send after an update restarted the cadence is not counted.
+// Subscribers fill `inter_arrival`, the time between consecutive frames, and
+// `update_latency`, the time from the frame's arrival until the new payload
+// is visible to readers. Arrival is the kernel receive timestamp when the
+// transport provides one, else the stack's wake-up or the receive callback.
+struct PdTimingStats {
+    int id {0};
+    std::string name;
+    bool is_outgoing {true};
+    int cycle_time_ms {0};
+    util::LatencySnapshot interval_deviation;
+    util::LatencySnapshot inter_arrival;
+    util::LatencySnapshot update_latency;
 };
 
 struct MdMessage {
@@ -40,77 +106,206 @@ struct MdMessage {
     std::string timestamp;
 };
 
+// Retention limits for MD history; the oldest messages are dropped once
+// either limit is reached.
+struct MdHistoryOptions {
+    size_t max_messages {1000};
+    size_t max_payload_bytes {4 * 1024 * 1024};
+};
+
+// Where receive-to-callback latency is timed from: the kernel receive
+// timestamp of the datagram (built-in UDP transport) or the moment select()
+// reported the stack's sockets readable (libtrdp, which hides the datagram).
+enum class ReceiveClock : uint8_t { kNone, kKernelTimestamp, kSocketWakeup };
+
+std::string_view receiveClockName(ReceiveClock clock);
+
+struct TrafficCounts {
+    uint64_t packets {0};
+    // Dataset bytes, without TRDP and UDP headers.
+    uint64_t bytes {0};
+};
+
+// Cumulative counters since the engine was created.
+struct TrdpEngineMetrics {
+    TrafficCounts pd_in;
+    TrafficCounts pd_out;
+    TrafficCounts md_in;
+    TrafficCounts md_out;
+    // PD sends the stack refused (tlp_put() or the built-in transport) and
+    // failed tlc_process() calls.
+    uint64_t put_errors {0};
+    uint64_t process_errors {0};
+    // How long after its deadline each cyclic publisher was picked up by the
+    // worker thread.
+    util::LatencySnapshot scheduler_lateness;
+};
+
+struct TrdpEngineOptions {
+    util::TrdpLogWriterOptions log_writer;
+    util::TrafficRollupOptions rollup;
+    // Store every PD telegram in trdp_logs. With rollups enabled this can be
+    // turned off to keep only per-second aggregates of PD traffic.
+    bool log_pd_packets {true};
+    MdHistoryOptions md_history;
+    // Socket I/O of the built-in UDP transport (used without libtrdp).
+    UdpIoBackend io_backend {UdpIoBackend::kAuto};
+};
+
 class TrdpEngine {
 public:
-    explicit TrdpEngine(db::Database *database = nullptr);
+    explicit TrdpEngine(db::Database *database = nullptr, TrdpEngineOptions options = {});
     ~TrdpEngine();
 
     bool loadConfiguration(const config::TrdpConfig &config, const network::NetworkConfig &net_cfg);
     void start();
     void stop();
 
-    std::vector<PdMessage> listOutgoingPd() const;
-    std::vector<PdMessage> listIncomingPd() const;
+    // Snapshots never block the TRDP callbacks; telegrams that have not
+    // changed since the last read are served from a cached immutable message.
+    std::vector<PdMessagePtr> listOutgoingPd() const;
+    std::vector<PdMessagePtr> listIncomingPd() const;
+    PdMessagePtr findOutgoingPd(int msg_id) const;
+    PdDelta outgoingPdSince(uint64_t version) const;
+    PdDelta incomingPdSince(uint64_t version) const;
     void updateOutgoingPdPayload(int msg_id, const std::vector<uint8_t> &payload);
+    // Writes individual fields of a publisher's dataset in place, leaving the
+    // rest of the payload untouched. All updates are checked before any byte
+    // changes; unknown fields and unrepresentable values throw
+    // std::invalid_argument. Cyclic publishers carry the new values on their
+    // next cycle, acyclic ones send them right away.
+    void updateOutgoingPdFields(int msg_id, const std::vector<PdFieldUpdate> &updates);
+    // Replaces the generators of a cyclic publisher; an empty list removes
+    // them. Generators run in the publish path right before each send and
+    // last until the configuration is reloaded. Specs that do not fit the
+    // dataset throw std::invalid_argument.
+    void setOutgoingPdGenerators(int msg_id, const std::vector<GeneratorSpec> &specs);
+    std::vector<GeneratorSpec> outgoingPdGenerators(int msg_id) const;
 
-    std::vector<MdMessage> listOutgoingMd() const;
-    std::vector<MdMessage> listIncomingMd() const;
+    // Returns retained messages with an id greater than `since_id`, oldest
+    // first, stopping after `limit` entries when it is non-zero.
+    std::vector<MdMessage> listOutgoingMd(int since_id = 0, size_t limit = 0) const;
+    std::vector<MdMessage> listIncomingMd(int since_id = 0, size_t limit = 0) const;
     MdMessage sendMdMessage(const std::string &destination, const std::vector<uint8_t> &payload);
     MdMessage sendMdMessage(const std::string &destination, int msg_id,
                            const std::vector<uint8_t> &payload);
 
+    util::TrdpLogWriterStats logWriterStats() const;
+    TrdpEngineMetrics metrics() const;
+    // Time from the arrival of a PD or MD datagram until its receive callback
+    // runs, over all telegrams since the stack was last initialized.
+    util::LatencySnapshot receiveLatency() const { return receive_latency_.snapshot(); }
+    ReceiveClock receiveClock() const { return receive_clock_.load(std::memory_order_relaxed); }
+    // Per-telegram timing histograms: publishers in comId order, then
+    // subscribers in configuration order.
+    std::vector<PdTimingStats> pdTimingStats() const;
+
 private:
+    // trdp_bench drives the receive and logging paths directly through this.
+    friend struct TrdpEngineBenchAccess;
+
     struct PdRuntimeState;
     struct MdRuntimeState;
+    struct PdSlot;
+    struct PdTable;
+    class MdHistory;
     class TrdpStackAdapter;
 
     bool initializeStackLocked(const network::NetworkConfig &net_cfg);
     void teardownStackLocked();
     void rebuildStateFromConfig(const std::string &xml_content);
     void runEventLoop();
-    void scheduleNextCycle(PdRuntimeState &state);
-    void handleIncomingPd(int msg_id, const std::vector<uint8_t> &payload, const std::string &src_ip,
-                          const std::string &dst_ip);
+    void waitForNextDeadline();
+    void armPublisherLocked(PdRuntimeState &state, PdScheduler::TimePoint first_deadline);
+    void wakeWorkerLocked();
+    void scheduleNextCycle(PdRuntimeState &state, PdScheduler::TimePoint now);
+    void applyGeneratorsLocked(PdRuntimeState &state);
+    void putOutgoingPd(PdRuntimeState &state, uint64_t version, const uint8_t *payload, size_t size,
+                       const std::string &src_ip, const std::string &dst_ip);
+    // `rx_time_ns` is when the frame arrived (CLOCK_REALTIME), 0 if the
+    // transport does not know.
+    void handleIncomingPd(PdRuntimeState &state, const uint8_t *payload, size_t size, uint32_t src_ip,
+                          uint32_t dst_ip, int64_t rx_time_ns);
     void handleIncomingMd(int msg_id, const std::vector<uint8_t> &payload, const std::string &src_ip,
                           const std::string &dst_ip);
-    void logTrdpEvent(const std::string &direction, const std::string &type, int msg_id,
-                      const std::string &src_ip, const std::string &dst_ip,
-                      const std::vector<uint8_t> &payload);
+    void logTrdpEvent(std::string_view direction, std::string_view type, int msg_id, std::string_view src_ip,
+                      std::string_view dst_ip, const uint8_t *payload, size_t size);
     static std::string sanitizeEndpoint(const std::string &endpoint);
     static std::string extractIp(const std::string &endpoint);
     static uint16_t extractPort(const std::string &endpoint, uint16_t fallback);
-    static void pdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size,
-                                 const char *src_ip, const char *dst_ip);
+    static void pdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size, uint32_t src_ip,
+                                 uint32_t dst_ip, int64_t rx_time_ns = 0);
     static void mdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size,
                                  const char *src_ip, const char *dst_ip);
     void ensureWorker();
     void stopWorker();
     void clearAllStateLocked();
     static std::string nowIso8601();
-    bool buildStateFromTrdpConfig(const config::TrdpXmlConfig &config);
+    static std::string formatIso8601(int64_t unix_ns);
+    bool buildStateFromTrdpConfig(const config::TrdpXmlConfig &config, PdTable &outgoing, PdTable &incoming);
+    PdDelta changesSince(const std::shared_ptr<const PdTable> &table, uint64_t version) const;
+    static std::vector<PdMessagePtr> snapshotTable(const std::shared_ptr<const PdTable> &table);
+    static std::shared_ptr<PdSlot> findSlot(const std::shared_ptr<const PdTable> &table, int msg_id);
+    std::shared_ptr<PdSlot> appendSlot(PdTable &table, const PdMessage &message, size_t capacity, uint32_t src_ip,
+                                       uint32_t dst_ip);
+    void storeSlot(PdSlot &slot, const uint8_t *payload, size_t size, uint32_t src_ip, uint32_t dst_ip);
+    void patchSlot(PdSlot &slot, const uint8_t *payload, size_t size,
+                   const std::vector<std::pair<size_t, size_t>> &ranges);
+    static void touchSlot(PdSlot &slot);
+    static uint64_t slotVersion(const PdSlot &slot);
+    static PdMessagePtr readSlot(PdSlot &slot);
 
     bool running_ {false};
     std::atomic<bool> stack_ready_ {false};
     std::optional<config::TrdpConfig> loaded_config_;
     std::optional<network::NetworkConfig> network_config_;
-    std::vector<PdMessage> outgoing_pd_;
-    std::vector<PdMessage> incoming_pd_;
-    std::vector<MdMessage> outgoing_md_;
-    std::vector<MdMessage> incoming_md_;
-    std::unordered_map<int, size_t> outgoing_pd_index_;
-    std::unordered_map<int, size_t> incoming_pd_index_;
-    std::unordered_map<int, size_t> outgoing_md_index_;
-    std::unordered_map<int, size_t> incoming_md_index_;
+    // Rebuilt on every configuration load and swapped with
+    // std::atomic_load/atomic_store; slots are updated in place.
+    std::shared_ptr<const PdTable> outgoing_pd_table_;
+    std::shared_ptr<const PdTable> incoming_pd_table_;
+    // Bumped on every PD payload store; never reset, so cursors stay valid
+    // across configuration reloads.
+    std::atomic<uint64_t> pd_version_ {0};
+    std::unique_ptr<MdHistory> outgoing_md_;
+    std::unique_ptr<MdHistory> incoming_md_;
+    // Publishers are keyed by comId; subscribers are kept apart so a
+    // telegram that is both sent and received does not collide.
     std::unordered_map<int, std::shared_ptr<PdRuntimeState>> pd_runtime_;
+    std::vector<std::shared_ptr<PdRuntimeState>> pd_subscriber_runtime_;
     std::unordered_map<int, std::shared_ptr<MdRuntimeState>> md_runtime_;
+    PdScheduler pd_scheduler_;
+    std::condition_variable scheduler_cv_;
+    bool scheduler_dirty_ {false};
+    // eventfd that interrupts a worker blocked on transport sockets.
+    int wake_fd_ {-1};
     int next_pd_id_ {1};
     int next_md_id_ {1};
     int next_md_msg_id_ {1};
     int next_md_runtime_id_ {1};
+    UdpIoBackend io_backend_ {UdpIoBackend::kAuto};
+    util::LatencyHistogram receive_latency_;
+    std::atomic<ReceiveClock> receive_clock_ {ReceiveClock::kNone};
+    struct TrafficCounters {
+        util::ShardedCounter packets;
+        util::ShardedCounter bytes;
+    };
+    TrafficCounters pd_in_;
+    TrafficCounters pd_out_;
+    TrafficCounters md_in_;
+    TrafficCounters md_out_;
+    util::ShardedCounter put_errors_;
+    util::ShardedCounter process_errors_;
+    util::LatencyHistogram scheduler_lateness_;
     db::Database *database_ {nullptr};
+    std::unique_ptr<util::TrdpLogWriter> log_writer_;
+    std::unique_ptr<util::TrafficRollup> rollup_;
+    bool log_pd_packets_ {true};
     std::unique_ptr<TrdpStackAdapter> stack_adapter_;
     mutable std::mutex state_mutex_;
     std::mutex engine_mutex_;
+    // Taken shared by API threads sending through stack_adapter_ and
+    // exclusively while the stack is brought up or torn down.
+    std::shared_mutex stack_mutex_;
     std::thread worker_thread_;
     std::atomic<bool> stop_worker_ {true};
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace trdp::stack {
+
+// TRDP message types (IEC 61375-2-3), two ASCII characters on the wire.
+enum class TrdpMessageType : uint16_t {
+    kPdData = 0x5064,        // "Pd"
+    kPdPullRequest = 0x5072,  // "Pr"
+    kPdPullReply = 0x5070,    // "Pp"
+    kPdError = 0x5065,        // "Pe"
+    kMdNotify = 0x4D6E,       // "Mn"
+    kMdRequest = 0x4D72,      // "Mr"
+    kMdReply = 0x4D70,        // "Mp"
+    kMdReplyQuery = 0x4D71,   // "Mq"
+    kMdConfirm = 0x4D63,      // "Mc"
+    kMdError = 0x4D65,        // "Me"
+};
+
+constexpr uint16_t kTrdpProtocolVersion = 0x0100;
+constexpr size_t kPdHeaderSize = 40;
+constexpr size_t kMdHeaderSize = 116;
+// Largest dataset a PD frame carries (IEC 61375-2-3 limits PD to 1432 bytes).
+constexpr size_t kMaxPdDatasetSize = 1432;
+// Largest dataset an MD frame can carry in a single UDP datagram.
+constexpr size_t kMaxMdDatasetSize = 65507 - kMdHeaderSize;
+
+bool isPdMessage(TrdpMessageType type);
+bool isMdMessage(TrdpMessageType type);
+
+// CRC-32 (IEEE 802.3) as used for the header frame check sequence.
+uint32_t trdpFcs(const uint8_t *data, size_t size);
+
+// Builds a frame (header followed by the dataset) in `out`, which must hold
+// the header size plus `size` bytes, and returns the frame size. Header
+// fields are big-endian; the FCS is stored little-endian like the reference
+// stack does. Topography counters are left at 0 (not checked).
+size_t encodePdFrame(uint8_t *out, TrdpMessageType type, uint32_t sequence, uint32_t com_id, const uint8_t *data,
+                     size_t size);
+size_t encodeMdFrame(uint8_t *out, TrdpMessageType type, uint32_t sequence, uint32_t com_id, const uint8_t *data,
+                     size_t size);
+
+// A validated frame; `data` points into the buffer passed to decodeFrame().
+struct TrdpFrame {
+    TrdpMessageType type {TrdpMessageType::kPdData};
+    uint32_t sequence {0};
+    uint32_t com_id {0};
+    const uint8_t *data {nullptr};
+    size_t size {0};
+};
+
+// Rejects frames that are truncated, of another major protocol version or an
+// unknown message type, fail the FCS, or declare more data than they carry.
+std::optional<TrdpFrame> decodeFrame(const uint8_t *frame, size_t size);
+
+}  // namespace trdp::stack
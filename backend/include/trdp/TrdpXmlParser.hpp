@@ -30,8 +30,22 @@ struct TrdpInterfaceDefinition {
     std::vector<TrdpTelegramDefinition> telegrams;
 };
 
+struct TrdpDatasetElement {
+    std::string name;
+    // Element type name or id, or the id/name of a nested dataset.
+    std::string type;
+    int array_size {1};
+};
+
+struct TrdpDatasetDefinition {
+    int id {0};
+    std::string name;
+    std::vector<TrdpDatasetElement> elements;
+};
+
 struct TrdpXmlConfig {
     std::vector<TrdpInterfaceDefinition> interfaces;
+    std::vector<TrdpDatasetDefinition> datasets;
     bool empty() const { return interfaces.empty(); }
 };
 
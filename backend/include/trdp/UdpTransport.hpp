@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "network/NetworkConfigService.hpp"
+#include "trdp/TrdpWire.hpp"
+
+namespace trdp::stack {
+
+constexpr uint16_t kDefaultPdPort = 17224;
+constexpr uint16_t kDefaultMdPort = 17225;
+
+// How the transport waits for and moves datagrams. kAuto picks io_uring when
+// the kernel supports multishot receive into provided buffer rings (Linux
+// 6.0) and epoll otherwise; an explicit kIoUring falls back the same way.
+enum class UdpIoBackend : uint8_t { kAuto, kEpoll, kIoUring };
+
+// Accepts "auto", "epoll" and "io_uring".
+std::optional<UdpIoBackend> parseUdpIoBackend(std::string_view name);
+std::string_view udpIoBackendName(UdpIoBackend backend);
+
+// A frame handed to the receive handler. Addresses are host order; `dst_ip`
+// is the address the datagram was sent to, e.g. a multicast group.
+// `rx_time_ns` is the kernel receive time (CLOCK_REALTIME), 0 if unknown.
+struct UdpFrame {
+    TrdpFrame frame;
+    uint32_t src_ip {0};
+    uint32_t dst_ip {0};
+    uint16_t src_port {0};
+    int64_t rx_time_ns {0};
+};
+
+struct UdpTransportStats {
+    uint64_t frames_sent {0};
+    uint64_t frames_received {0};
+    uint64_t send_errors {0};
+    // Datagrams that were truncated or failed frame validation.
+    uint64_t frames_rejected {0};
+    // System calls issued; frames / calls is the achieved batch size. The
+    // io_uring backend receives without any.
+    uint64_t send_calls {0};
+    uint64_t receive_calls {0};
+};
+
+// Minimal TRDP transport over plain UDP sockets, used when libtrdp is not
+// installed. It frames PD and MD telegrams (header, sequence counter, FCS)
+// and moves them in batches: with epoll through sendmmsg()/recvmmsg(), with
+// io_uring through one submission per flush and multishot receives that
+// complete straight into registered buffers. It does not implement MD
+// sessions (request/reply/confirm), PD pull or TCP; received MD frames of any
+// type are delivered as-is.
+//
+// Queueing and flushing may be called from any thread. receive() and
+// wait() belong to the single thread that drives the transport.
+class UdpTransport {
+public:
+    using FrameHandler = void (*)(void *context, const UdpFrame &frame);
+
+    UdpTransport();
+    ~UdpTransport();
+    UdpTransport(const UdpTransport &) = delete;
+    UdpTransport &operator=(const UdpTransport &) = delete;
+
+    // Binds the PD and MD ports on all interfaces, sends multicast through
+    // the interface of `cfg.local_ip` and joins `cfg.multicast_groups`.
+    // Returns false with a reason in `error` when a socket cannot be set up.
+    bool open(const network::NetworkConfig &cfg, UdpIoBackend backend, std::string &error);
+    void close();
+    bool isOpen() const noexcept { return pd_socket_ >= 0; }
+    // The backend in use after open(); never kAuto.
+    UdpIoBackend backend() const noexcept { return backend_; }
+    // Why io_uring was requested but not used; empty otherwise.
+    const std::string &fallbackReason() const noexcept { return fallback_reason_; }
+
+    // Joins a multicast group (host order) on both sockets; addresses that
+    // are not multicast or already joined are ignored.
+    bool joinGroup(uint32_t group);
+
+    // Frames the dataset into a send slot; nothing is sent before flush(),
+    // except that a full batch is flushed right away. Returns false for a
+    // dataset that does not fit a frame.
+    bool queuePd(uint32_t com_id, uint32_t dst_ip, uint16_t dst_port, const uint8_t *data, size_t size);
+    bool queueMd(TrdpMessageType type, uint32_t com_id, uint32_t dst_ip, uint16_t dst_port, const uint8_t *data,
+                 size_t size);
+    // Sends everything queued; returns the number of frames sent.
+    size_t flush();
+
+    // Reads whatever is pending on both sockets without blocking and calls
+    // `handler` for every valid frame. Returns the number of frames handled.
+    size_t receive(FrameHandler handler, void *context);
+
+    // Blocks until a socket is readable, `wake_fd` (when >= 0) is readable or
+    // `deadline` passes; a null deadline waits indefinitely.
+    void wait(const std::chrono::steady_clock::time_point *deadline, int wake_fd);
+
+    uint16_t pdPort() const noexcept { return pd_port_; }
+    uint16_t mdPort() const noexcept { return md_port_; }
+    UdpTransportStats stats() const;
+
+private:
+    struct SendQueue;
+    struct ReceiveRing;
+    struct Uring;
+
+    bool queueFrame(SendQueue &queue, TrdpMessageType type, uint32_t com_id, uint32_t dst_ip, uint16_t dst_port,
+                    const uint8_t *data, size_t size);
+    size_t flushLocked(SendQueue &queue);
+    size_t drain(int socket, ReceiveRing &ring, FrameHandler handler, void *context);
+    bool deliver(const uint8_t *datagram, size_t size, bool truncated, const void *source, const void *control,
+                 size_t control_size, FrameHandler handler, void *context);
+    uint32_t nextSequence(TrdpMessageType type, uint32_t com_id);
+    bool openEpoll(std::string &error);
+    void waitEpoll(const std::chrono::steady_clock::time_point *deadline, int wake_fd);
+    bool openUring(std::string &reason);
+    size_t reapUring(FrameHandler handler, void *context);
+    void waitUring(const std::chrono::steady_clock::time_point *deadline, int wake_fd);
+
+    int pd_socket_ {-1};
+    int md_socket_ {-1};
+    uint16_t pd_port_ {kDefaultPdPort};
+    uint16_t md_port_ {kDefaultMdPort};
+    uint32_t interface_ip_ {0};
+    std::unordered_set<uint32_t> groups_;
+    UdpIoBackend backend_ {UdpIoBackend::kEpoll};
+    std::string fallback_reason_;
+    int epoll_fd_ {-1};
+    // Wake descriptor currently registered with epoll_fd_.
+    int epoll_wake_fd_ {-1};
+    // Submission queue access is serialized by send_mutex_; completions are
+    // only consumed by the thread calling receive().
+    std::unique_ptr<Uring> uring_;
+
+    std::mutex send_mutex_;
+    std::unique_ptr<SendQueue> pd_queue_;
+    std::unique_ptr<SendQueue> md_queue_;
+    // Per (message type, ComId) sequence counters, as the standard requires.
+    std::unordered_map<uint64_t, uint32_t> sequences_;
+
+    std::unique_ptr<ReceiveRing> pd_ring_;
+    std::unique_ptr<ReceiveRing> md_ring_;
+
+    std::atomic<uint64_t> frames_sent_ {0};
+    std::atomic<uint64_t> frames_received_ {0};
+    std::atomic<uint64_t> send_errors_ {0};
+    std::atomic<uint64_t> frames_rejected_ {0};
+    std::atomic<uint64_t> send_calls_ {0};
+    std::atomic<uint64_t> receive_calls_ {0};
+};
+
+}  // namespace trdp::stack
@@ -15,10 +15,17 @@ struct TelegramEndpoint {
     std::string endpoint;
 };
 
+struct ParsedDatasetElement {
+    std::string name;
+    std::string type;
+    int array_size {1};
+};
+
 struct ParsedDataset {
     int dataset_id {0};
     int com_id {0};
     std::string name;
+    std::vector<ParsedDatasetElement> elements;
 };
 
 struct ParsedTelegram {
@@ -60,6 +67,8 @@ public:
 class TrdpXmlLoader {
 public:
     ParsedTrdpConfig parse(const std::string &xml_content) const;
+    // Only the <dataset> (or <data-set>) definitions of a document.
+    std::vector<ParsedDataset> parseDatasets(const std::string &xml_content) const;
 };
 
 }  // namespace trdp::xml
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace trdp::xml {
+
+struct XmlAttribute {
+    std::string_view name;
+    std::string_view value;
+};
+
+enum class XmlTokenType { kStartTag, kEndTag, kText };
+
+struct XmlToken {
+    XmlTokenType type {XmlTokenType::kText};
+    // Tag name for start and end tags.
+    std::string_view name;
+    // Character data for text tokens, the raw attribute segment for start tags.
+    std::string_view text;
+    bool self_closing {false};
+    // Byte range of the token in the source buffer.
+    size_t begin {0};
+    size_t end {0};
+};
+
+// XmlTokenizer walks a document once, front to back, and hands out tokens
+// whose views point into the caller's buffer. Comments, processing
+// instructions and DOCTYPE declarations are skipped; CDATA sections come back
+// as text. Entities are not expanded. A truncated tag ends the stream.
+class XmlTokenizer {
+public:
+    explicit XmlTokenizer(std::string_view xml) : xml_(xml) {}
+
+    bool next(XmlToken &token);
+
+    // Splits a start tag's attribute segment into name/value pairs appended to
+    // `out`. Values may use either quote style; malformed pairs are skipped.
+    static void parseAttributes(std::string_view segment, std::vector<XmlAttribute> &out);
+
+private:
+    std::string_view xml_;
+    size_t pos_ {0};
+};
+
+struct XmlNode {
+    std::string_view name;
+    // Raw markup between the start and end tag; empty for <tag/>.
+    std::string_view body;
+    uint32_t first_attribute {0};
+    uint32_t attribute_count {0};
+    // Nodes are stored in document order, so a node's descendants occupy the
+    // index range (own index, subtree_end).
+    uint32_t subtree_end {0};
+};
+
+// XmlDocument indexes every element of a buffer in a single tokenizer pass.
+// It does not copy the text: the buffer must outlive the document.
+// Unmatched end tags are ignored and elements left open at the end of the
+// input are closed there.
+class XmlDocument {
+public:
+    explicit XmlDocument(std::string_view xml);
+
+    const std::vector<XmlNode> &nodes() const noexcept { return nodes_; }
+
+    // Elements named `tag` below `scope` (the whole document when null), in
+    // document order. Matches nested inside another match are not reported.
+    std::vector<const XmlNode *> find(std::string_view tag, const XmlNode *scope = nullptr) const;
+
+    const XmlAttribute *findAttribute(const XmlNode &node, std::string_view name) const;
+    // Value of attribute `name`, or an empty view when it is absent.
+    std::string_view attribute(const XmlNode &node, std::string_view name) const;
+
+private:
+    std::string_view xml_;
+    std::vector<XmlNode> nodes_;
+    std::vector<XmlAttribute> attributes_;
+};
+
+}  // namespace trdp::xml
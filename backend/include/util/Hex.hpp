@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace trdp::util {
+
+// Hex conversion shared by the JSON and XML payload paths. The kernels are
+// picked once at startup: AVX2 or SSSE3 when the CPU supports them, a table
+// driven scalar loop otherwise.
+
+// Writes `size` bytes as 2 * `size` lowercase hex digits to `out`.
+void hexEncode(const uint8_t *data, size_t size, char *out);
+
+// Reads 2 * `size` hex digits (either case) from `hex` into `size` bytes.
+// Returns false, leaving `out` partially written, on any non-hex character.
+bool hexDecode(const char *hex, size_t size, uint8_t *out);
+
+// Lenient decoding for configuration payloads: characters that are not hex
+// digits are skipped and an odd digit count gets a leading zero.
+std::vector<uint8_t> parseLooseHex(std::string_view raw);
+
+// Name of the active kernel ("avx2", "ssse3" or "scalar").
+const char *hexKernelName();
+
+}  // namespace trdp::util
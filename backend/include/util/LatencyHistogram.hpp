@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trdp::util {
+
+// A point-in-time copy of a LatencyHistogram. Durations are nanoseconds.
+struct LatencySnapshot {
+    uint64_t count {0};
+    int64_t min_ns {0};
+    int64_t max_ns {0};
+    int64_t sum_ns {0};
+    // Per-bucket counts, indexed like LatencyHistogram::bucketIndex().
+    std::vector<uint64_t> buckets;
+
+    double meanNs() const { return count > 0 ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0; }
+    // Smallest recorded value that `fraction` (0..1) of the samples do not
+    // exceed, resolved to the upper edge of its bucket and capped at max_ns.
+    int64_t percentileNs(double fraction) const;
+    // Adds the samples of `other` to this snapshot.
+    void merge(const LatencySnapshot &other);
+};
+
+// Log-linear histogram in the style of HdrHistogram: every power of two is
+// split into 16 linear sub-buckets, so any recorded value is resolved to
+// within 1/16 (about 6 %) from 1 ns up to 2^36 ns (about 69 s); longer values
+// land in the last bucket while min/max stay exact. Recording is a handful of
+// relaxed atomic operations and never blocks, so the worker thread can record
+// while HTTP threads take snapshots; a snapshot taken concurrently with
+// record() may be off by the samples in flight.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kMaxValueBits = 36;
+    static constexpr size_t kBucketCount = static_cast<size_t>(kMaxValueBits - kSubBucketBits + 1)
+                                           << kSubBucketBits;
+
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    // Negative values (clock steps) are recorded as 0.
+    void record(int64_t value_ns) noexcept;
+    LatencySnapshot snapshot() const;
+    void reset() noexcept;
+
+    static size_t bucketIndex(uint64_t value) noexcept;
+    // Largest value that maps to `index`.
+    static uint64_t bucketUpperBound(size_t index) noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<int64_t> sum_ {0};
+    std::atomic<int64_t> min_;
+    std::atomic<int64_t> max_ {0};
+};
+
+}  // namespace trdp::util
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "util/TrdpLogPartitions.hpp"
+#include "util/TrdpLogWriter.hpp"
+
 namespace trdp::db {
 class Database;
 }
@@ -12,7 +16,7 @@ class Database;
 namespace trdp::util {
 
 struct TrdpLogEntry {
-    int id {0};
+    int64_t id {0};
     std::string direction;
     std::string type;
     int msg_id {0};
@@ -20,10 +24,67 @@ struct TrdpLogEntry {
     std::string dst_ip;
     std::vector<uint8_t> payload;
     std::string timestamp;
+    // PD rows stand for a run of records with the same payload, received or
+    // sent between `timestamp` and `last_timestamp`; other rows have a
+    // count of 1 and both timestamps equal.
+    int64_t repeat_count {1};
+    std::string last_timestamp;
+};
+
+struct TrdpLogQuery {
+    int limit {100};
+    // Rows to skip. Every skipped row is still read, so deep pages should
+    // pass the id of the last row of the previous page as `before_id`
+    // instead.
+    int offset {0};
+    // Only rows with a smaller id; each page costs the same however deep
+    // it is.
+    std::optional<int64_t> before_id;
+    // "PD"/"MD" and "IN"/"OUT", case-insensitive; other values are ignored.
+    std::optional<std::string> type;
+    std::optional<std::string> direction;
+    std::optional<int> msg_id;
+    std::optional<std::string> src_ip;
+    // Unix seconds; rows whose run overlaps [from, to) are returned and only
+    // partitions overlapping the window are read.
+    std::optional<int64_t> from;
+    std::optional<int64_t> to;
+    // Expand every row of the page into one entry per repeat, with
+    // timestamps spread evenly over the run; at most kMaxExpandedEntries
+    // entries are returned.
+    bool expand_runs {false};
+};
+
+// One trdp_rollups bucket. Gaps are unset when the bucket saw a single
+// packet of its series.
+struct RollupEntry {
+    int resolution_s {0};
+    int64_t bucket_start {0};
+    std::string direction;
+    int msg_id {0};
+    std::string src_ip;
+    std::string dst_ip;
+    uint64_t packets {0};
+    uint64_t bytes {0};
+    std::optional<int64_t> min_gap_ns;
+    std::optional<int64_t> max_gap_ns;
+    uint64_t changes {0};
+    std::vector<uint8_t> last_payload;
+};
+
+// `resolution_s` must be 1, 60 or 3600; `from` and `to` bound bucket_start
+// (unix seconds, `to` exclusive).
+struct RollupQuery {
+    int resolution_s {60};
+    std::optional<int> msg_id;
+    std::optional<std::string> direction;
+    std::optional<int64_t> from;
+    std::optional<int64_t> to;
+    int limit {100};
 };
 
 struct AppLogEntry {
-    int id {0};
+    int64_t id {0};
     std::string level;
     std::string message;
     std::string timestamp;
@@ -31,18 +92,32 @@ struct AppLogEntry {
 
 class LogService {
 public:
-    explicit LogService(db::Database &database);
+    // `writer` must be the options of the engine's TrdpLogWriter; the
+    // partition layout and the longest PD run are taken from it.
+    explicit LogService(db::Database &database, const TrdpLogWriterOptions &writer = {});
+
+    // Newest rows first, read from the time partitions newest first and
+    // then from rows logged to the main database before partitioning.
+    std::vector<TrdpLogEntry> getTrdpLogs(const TrdpLogQuery &query);
+    std::vector<LogPartition> trdpLogPartitions() const { return partitions_.list(); }
+    const TrdpLogStorageOptions &trdpLogStorage() const noexcept { return partitions_.options(); }
+
+    static constexpr size_t kMaxExpandedEntries = 10000;
 
-    std::vector<TrdpLogEntry> getTrdpLogs(int limit, int offset,
-                                          std::optional<std::string> type_filter,
-                                          std::optional<std::string> direction_filter);
+    // Newest buckets first. Throws std::invalid_argument for an unknown
+    // resolution.
+    std::vector<RollupEntry> getRollups(const RollupQuery &query);
 
-    std::vector<AppLogEntry> getAppLogs(int limit, int offset, std::optional<std::string> level_filter);
+    // `level_filter` is case-insensitive; levels are stored upper case.
+    std::vector<AppLogEntry> getAppLogs(int limit, int offset, std::optional<std::string> level_filter,
+                                        std::optional<int64_t> before_id = std::nullopt);
 
     void appendAppLog(const std::string &level, const std::string &message);
 
 private:
     db::Database &database_;
+    TrdpLogPartitions partitions_;
+    std::chrono::seconds max_run_duration_;
 };
 
 }  // namespace trdp::util
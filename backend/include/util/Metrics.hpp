@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "util/LatencyHistogram.hpp"
+
+namespace trdp::util {
+
+constexpr size_t kMetricShards = 16;
+
+// Shard of the calling thread; threads are spread round-robin over
+// kMetricShards the first time they record.
+size_t metricShard() noexcept;
+
+// Monotonic counter for hot paths. Each thread adds to its own cache-line
+// sized shard, so threads recording at the same time never write the same
+// line; value() sums the shards.
+class ShardedCounter {
+public:
+    void add(uint64_t amount = 1) noexcept {
+        shards_[metricShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    uint64_t value() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value {0};
+    };
+    std::array<Shard, kMetricShards> shards_ {};
+};
+
+// Label set of one sample, e.g. {{"direction", "in"}, {"type", "pd"}}.
+using MetricLabels = std::vector<std::pair<std::string_view, std::string_view>>;
+
+// Builds an OpenMetrics text exposition. Declare each family once with
+// family() and then add its samples; finish() appends the "# EOF" marker.
+// Latency histograms are exported as summaries in seconds.
+class OpenMetricsWriter {
+public:
+    // `type` is "counter", "gauge" or "summary". Counter sample names get
+    // the "_total" suffix automatically.
+    void family(std::string_view name, std::string_view type, std::string_view help, std::string_view unit = {});
+    void counter(std::string_view name, uint64_t value, const MetricLabels &labels = {});
+    void gauge(std::string_view name, double value, const MetricLabels &labels = {});
+    void summary(std::string_view name, const LatencySnapshot &latency, const MetricLabels &labels = {});
+
+    std::string finish();
+
+private:
+    void sample(std::string_view name, std::string_view suffix, const MetricLabels &labels, std::string_view extra_label,
+                std::string_view extra_value);
+    void number(double value);
+
+    std::string out_;
+};
+
+}  // namespace trdp::util
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace trdp::db {
+class Database;
+}
+
+namespace trdp::util {
+
+// Bucket lengths kept in trdp_rollups, in seconds.
+constexpr int kRollupResolutions[] = {1, 60, 3600};
+
+struct TrafficRollupOptions {
+    bool enabled {true};
+    // How long buckets of each resolution are kept.
+    std::chrono::seconds second_retention {std::chrono::hours(1)};
+    std::chrono::seconds minute_retention {std::chrono::hours(24 * 7)};
+    std::chrono::seconds hour_retention {std::chrono::hours(24 * 365)};
+};
+
+// TrafficRollup aggregates PD traffic per (direction, comId, source,
+// destination) into 1 s buckets of packet and byte counts, the smallest and
+// largest gap between consecutive packets and the number of payload changes.
+// A background thread writes every closed second to trdp_rollups and adds it
+// to the enclosing minute and hour rows, so those are current to the last
+// second. Buckets older than their retention are pruned once a minute. The
+// buckets still open are written when the rollup is destroyed.
+class TrafficRollup {
+public:
+    TrafficRollup(db::Database &database, TrafficRollupOptions options = {});
+    ~TrafficRollup();
+
+    TrafficRollup(const TrafficRollup &) = delete;
+    TrafficRollup &operator=(const TrafficRollup &) = delete;
+
+    void record(std::string_view direction, int msg_id, std::string_view src_ip, std::string_view dst_ip,
+                const uint8_t *payload, size_t size);
+
+private:
+    struct Bucket {
+        std::string direction;
+        int msg_id {0};
+        std::string src_ip;
+        std::string dst_ip;
+        int64_t start {0};
+        uint64_t packets {0};
+        uint64_t bytes {0};
+        // -1 while the bucket holds no gap.
+        int64_t min_gap_ns {-1};
+        int64_t max_gap_ns {-1};
+        uint64_t changes {0};
+        std::vector<uint8_t> last_payload;
+    };
+
+    // Open bucket of one key; bucket.last_payload always holds the latest
+    // payload, also while the bucket is empty.
+    struct Series {
+        Bucket bucket;
+        std::optional<std::chrono::steady_clock::time_point> last_packet;
+    };
+
+    void run();
+    // Moves buckets that started before `before` (unix seconds) to pending_.
+    void closeBucketsLocked(int64_t before);
+    void closeBucketLocked(Bucket &bucket);
+    void writeBuckets(const std::vector<Bucket> &buckets, size_t count);
+    void prune(int64_t now);
+
+    db::Database &database_;
+    TrafficRollupOptions options_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unordered_map<std::string, Series> series_;
+    std::string key_;
+    // Closed buckets are the first pending_count_ of pending_. The thread
+    // swaps pending_ with flushing_ to write them, so both vectors keep
+    // their buckets and closing a bucket copies into storage allocated by
+    // an earlier second; record() does not allocate once a series is known.
+    std::vector<Bucket> pending_;
+    size_t pending_count_ {0};
+    std::vector<Bucket> flushing_;
+    bool stopping_ {false};
+    int64_t last_prune_ {0};
+
+    std::thread thread_;
+};
+
+}  // namespace trdp::util
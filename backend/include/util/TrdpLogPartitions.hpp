@@ -0,0 +1,77 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace trdp::util {
+
+enum class LogPartitionSpan { kHour, kDay };
+
+struct TrdpLogStorageOptions {
+    // Where the partition files live; empty means the directory returned
+    // by TrdpLogPartitions::defaultDirectory() for the main database.
+    std::filesystem::path directory;
+    LogPartitionSpan span {LogPartitionSpan::kDay};
+    // Partitions that ended longer ago than this are deleted.
+    std::chrono::hours max_age {24 * 30};
+    // Oldest partitions are deleted while all of them together take more
+    // than this many bytes; 0 means no limit.
+    uint64_t max_bytes {0};
+};
+
+// One partition file. `start` and `end` are unix seconds, `end` exclusive.
+struct LogPartition {
+    std::filesystem::path path;
+    int64_t start {0};
+    int64_t end {0};
+    uint64_t bytes {0};
+};
+
+// TRDP logs are stored in one SQLite file per hour or day, named after the
+// UTC start of its span (trdp_logs-2024010112.db or trdp_logs-20240101.db),
+// each holding a trdp_logs table. Expired partitions are removed by
+// unlinking their file, which costs the same however many rows it holds.
+// Row ids are unique across partitions and grow with time, so ordering by id
+// within and across partitions gives the same order.
+class TrdpLogPartitions {
+public:
+    explicit TrdpLogPartitions(TrdpLogStorageOptions options);
+
+    const TrdpLogStorageOptions &options() const noexcept { return options_; }
+
+    // Existing partitions of either span, oldest first: by start, and by
+    // row id where an hourly and a daily partition overlap. Other files
+    // are ignored.
+    std::vector<LogPartition> list() const;
+    // The partition covering `unix_seconds`, whether or not it exists yet.
+    LogPartition partitionAt(int64_t unix_seconds) const;
+
+    // Deletes partitions past max_age and, oldest first, those over
+    // max_bytes. `keep` (the partition being written) is never deleted.
+    // Returns the number of partitions removed.
+    size_t enforceRetention(int64_t now, const std::filesystem::path &keep) const;
+
+    // Opens (and creates) a partition for writing and makes sure it has the
+    // trdp_logs table. Throws std::runtime_error on failure.
+    static sqlite3 *openForWriting(const std::filesystem::path &path);
+    // Returns nullptr when the file cannot be opened, e.g. because
+    // retention removed it in the meantime.
+    static sqlite3 *openForReading(const std::filesystem::path &path);
+
+    // "<directory of db>/<db name without extension>-trdp_logs".
+    static std::filesystem::path defaultDirectory(const std::string &database_path);
+
+private:
+    // Start and end of the partition a file name stands for.
+    static std::optional<LogPartition> parseName(const std::string &file_name);
+
+    TrdpLogStorageOptions options_;
+};
+
+}  // namespace trdp::util
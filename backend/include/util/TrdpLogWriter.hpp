@@ -0,0 +1,158 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "util/LatencyHistogram.hpp"
+#include "util/TrdpLogPartitions.hpp"
+
+namespace trdp::db {
+class Database;
+}
+
+namespace trdp::util {
+
+enum class LogOverflowPolicy { kDropOldest, kBlock };
+
+struct TrdpLogWriterOptions {
+    size_t queue_capacity {8192};
+    size_t batch_size {256};
+    std::chrono::milliseconds flush_interval {100};
+    LogOverflowPolicy overflow_policy {LogOverflowPolicy::kDropOldest};
+    // Store consecutive PD records with an unchanged payload as one row per
+    // (comId, direction, source, destination) with a repeat count. A run
+    // that has lasted max_run_duration is closed and the next record starts
+    // a new row, so steady telegrams still show up among recent logs.
+    bool deduplicate_pd {true};
+    std::chrono::seconds max_run_duration {60};
+    TrdpLogStorageOptions storage;
+    // Source of record timestamps; checks substitute a clock that crosses
+    // partition boundaries when they need it to.
+    std::chrono::system_clock::time_point (*clock)() {&std::chrono::system_clock::now};
+};
+
+struct TrdpLogWriterStats {
+    uint64_t enqueued {0};
+    uint64_t written {0};
+    uint64_t dropped {0};
+    // Written records that extended an existing run instead of adding a row.
+    uint64_t deduplicated {0};
+    size_t queue_depth {0};
+    // Duration of each batch transaction, BEGIN to COMMIT.
+    LatencySnapshot write_latency;
+};
+
+// TrdpLogWriter persists trdp_logs rows on a dedicated thread. Producers copy
+// records into a bounded ring of preallocated slots; the writer drains them in
+// batches through a cached INSERT statement inside a single transaction, so
+// the TRDP worker never waits on SQLite. Repeated PD payloads are folded into
+// runs (see TrdpLogWriterOptions::deduplicate_pd); a run's repeat_count and
+// last_timestamp are updated once per batch, not once per record.
+//
+// Rows go to the time partition of their timestamp (see TrdpLogPartitions)
+// through the writer's own connection, never the shared database handle.
+// The writer assigns row ids itself, continuing after the highest id found
+// at startup, and applies the retention limits once a minute. Records are
+// stamped when they take their ring slot, never earlier than the record
+// before them, so ids grow with timestamps across partitions; keyset paging
+// in LogService relies on that.
+class TrdpLogWriter {
+public:
+    TrdpLogWriter(db::Database &database, TrdpLogWriterOptions options = {});
+    ~TrdpLogWriter();
+
+    TrdpLogWriter(const TrdpLogWriter &) = delete;
+    TrdpLogWriter &operator=(const TrdpLogWriter &) = delete;
+
+    void enqueue(std::string_view direction, std::string_view type, int msg_id, std::string_view src_ip,
+                 std::string_view dst_ip, const uint8_t *payload, size_t size);
+
+    // Blocks until every record enqueued so far has been written.
+    void flush();
+
+    TrdpLogWriterStats stats() const;
+    const TrdpLogWriterOptions &options() const noexcept { return options_; }
+
+private:
+    struct Record {
+        char direction[4] {};
+        char type[4] {};
+        int msg_id {0};
+        std::string src_ip;
+        std::string dst_ip;
+        std::vector<uint8_t> payload;
+        std::chrono::system_clock::time_point timestamp;
+    };
+
+    // An open run of identical PD payloads; writer thread only.
+    struct Run {
+        int64_t row_id {0};
+        std::vector<uint8_t> payload;
+        int64_t repeat_count {1};
+        std::chrono::system_clock::time_point first;
+        std::chrono::system_clock::time_point last;
+        bool dirty {false};
+    };
+
+    void run();
+    void writeBatch(std::vector<Record> &batch, size_t count);
+    // Opens the partition covering `unix_seconds` and prepares the
+    // statements on it; open runs belong to the old partition and end.
+    void openPartition(int64_t unix_seconds);
+    void closePartition();
+    // Persists dirty runs and commits; on failure the transaction's records
+    // are counted as dropped.
+    bool commitPartition();
+    void initializeNextId();
+    bool extendRun(const Record &record);
+    void openRun(const Record &record, int64_t row_id);
+    void updateDirtyRuns();
+    void persistRun(Run &run);
+
+    db::Database &database_;
+    TrdpLogWriterOptions options_;
+    TrdpLogPartitions partitions_;
+    // Writer thread only, like the runs below.
+    sqlite3 *partition_db_ {nullptr};
+    LogPartition partition_;
+    int64_t next_id_ {1};
+    std::chrono::steady_clock::time_point next_retention_ {};
+    sqlite3_stmt *insert_stmt_ {nullptr};
+    sqlite3_stmt *update_run_stmt_ {nullptr};
+    std::unordered_map<std::string, Run> runs_;
+    std::vector<Run *> dirty_runs_;
+    std::string run_key_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable drained_;
+    std::vector<Record> ring_;
+    std::chrono::system_clock::time_point last_timestamp_ {};
+    size_t head_ {0};
+    size_t size_ {0};
+    size_t in_flight_ {0};
+    bool flush_requested_ {false};
+    bool stopping_ {false};
+
+    std::atomic<uint64_t> enqueued_ {0};
+    std::atomic<uint64_t> written_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+    std::atomic<uint64_t> deduplicated_ {0};
+    LatencyHistogram write_latency_;
+
+    std::thread thread_;
+};
+
+}  // namespace trdp::util
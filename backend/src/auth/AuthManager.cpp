@@ -6,11 +6,12 @@
 #include <string>
 
 #include "auth/AuthService.hpp"
+#include "http/JsonUtils.hpp"
 #include "httplib.h"
 
 namespace {
 std::string jsonError(const std::string &message) {
-    return std::string{"{\"error\":\""} + message + "\"}";
+    return trdp::http::json::error(message);
 }
 
 bool isValidUsername(const std::string &username) {
@@ -63,6 +64,11 @@ std::optional<User> AuthManager::userFromRequest(const httplib::Request &req) {
     return it->second;
 }
 
+size_t AuthManager::sessionCount() const {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    return sessions_.size();
+}
+
 void AuthManager::handleRegister(const httplib::Request &req, httplib::Response &res) {
     auto username = extractJsonField(req.body, "username");
     auto password = extractJsonField(req.body, "password");
@@ -17,10 +17,10 @@ struct UserRow {
     std::string password_hash;
 };
 
-std::optional<UserRow> fetchUserRow(sqlite3 *db, const std::string &username) {
-    sqlite3_stmt *stmt = nullptr;
+std::optional<UserRow> fetchUserRow(db::Connection &connection, const std::string &username) {
     const char *sql = "SELECT id, username, password_hash, role, created_at FROM users WHERE username = ? LIMIT 1;";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         return std::nullopt;
     }
 
@@ -28,7 +28,6 @@ std::optional<UserRow> fetchUserRow(sqlite3 *db, const std::string &username) {
 
     int rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
         return std::nullopt;
     }
 
@@ -52,14 +51,13 @@ std::optional<UserRow> fetchUserRow(sqlite3 *db, const std::string &username) {
         row.password_hash = reinterpret_cast<const char *>(hash_text);
     }
 
-    sqlite3_finalize(stmt);
     return row;
 }
 
-std::optional<UserRow> fetchUserRowById(sqlite3 *db, long long user_id) {
-    sqlite3_stmt *stmt = nullptr;
+std::optional<UserRow> fetchUserRowById(db::Connection &connection, long long user_id) {
     const char *sql = "SELECT id, username, password_hash, role, created_at FROM users WHERE id = ? LIMIT 1;";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         return std::nullopt;
     }
 
@@ -67,7 +65,6 @@ std::optional<UserRow> fetchUserRowById(sqlite3 *db, long long user_id) {
 
     int rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
         return std::nullopt;
     }
 
@@ -91,14 +88,14 @@ std::optional<UserRow> fetchUserRowById(sqlite3 *db, long long user_id) {
         row.password_hash = reinterpret_cast<const char *>(hash_text);
     }
 
-    sqlite3_finalize(stmt);
     return row;
 }
 
-bool insertUser(sqlite3 *db, const std::string &username, const std::string &password_hash, const std::string &role) {
-    sqlite3_stmt *stmt = nullptr;
+bool insertUser(db::Connection &connection, const std::string &username, const std::string &password_hash,
+                const std::string &role) {
     const char *sql = "INSERT INTO users (username, password_hash, role) VALUES (?, ?, ?);";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -107,27 +104,25 @@ bool insertUser(sqlite3 *db, const std::string &username, const std::string &pas
     sqlite3_bind_text(stmt, 3, role.c_str(), -1, SQLITE_TRANSIENT);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
     return rc == SQLITE_DONE;
 }
 
-bool lookupUserExists(sqlite3 *db, const std::string &username) {
-    sqlite3_stmt *stmt = nullptr;
+bool lookupUserExists(db::Connection &connection, const std::string &username) {
     const char *sql = "SELECT 1 FROM users WHERE username = ? LIMIT 1;";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         return false;
     }
 
     sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
     return rc == SQLITE_ROW;
 }
 
-bool updatePasswordHash(sqlite3 *db, long long user_id, const std::string &password_hash) {
-    sqlite3_stmt *stmt = nullptr;
+bool updatePasswordHash(db::Connection &connection, long long user_id, const std::string &password_hash) {
     const char *sql = "UPDATE users SET password_hash = ? WHERE id = ?;";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         return false;
     }
 
@@ -135,15 +130,14 @@ bool updatePasswordHash(sqlite3 *db, long long user_id, const std::string &passw
     sqlite3_bind_int64(stmt, 2, user_id);
 
     int rc = sqlite3_step(stmt);
-    bool updated = rc == SQLITE_DONE && sqlite3_changes(db) > 0;
-    sqlite3_finalize(stmt);
+    bool updated = rc == SQLITE_DONE && sqlite3_changes(connection.handle()) > 0;
     return updated;
 }
 
-std::vector<User> fetchAllUsers(sqlite3 *db) {
-    sqlite3_stmt *stmt = nullptr;
+std::vector<User> fetchAllUsers(db::Connection &connection) {
     const char *sql = "SELECT id, username, role, created_at FROM users ORDER BY id ASC;";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto stmt = connection.prepare(sql);
+    if (!stmt) {
         throw std::runtime_error{"Failed to load users"};
     }
 
@@ -166,7 +160,6 @@ std::vector<User> fetchAllUsers(sqlite3 *db) {
         users.push_back(std::move(user));
     }
 
-    sqlite3_finalize(stmt);
     return users;
 }
 }  // namespace
@@ -175,11 +168,11 @@ AuthService::AuthService(db::Database &database) : database_(database) {}
 
 bool AuthService::registerUser(const std::string &username, const std::string &password, const std::string &role) {
     const std::string password_hash = PasswordHasher::hash(password);
-    return insertUser(database_.handle(), username, password_hash, role);
+    return insertUser(*database_.writer(), username, password_hash, role);
 }
 
 std::optional<User> AuthService::authenticate(const std::string &username, const std::string &password) {
-    auto row = fetchUserRow(database_.handle(), username);
+    auto row = fetchUserRow(*database_.reader(), username);
     if (!row) {
         return std::nullopt;
     }
@@ -209,11 +202,11 @@ void AuthService::ensureDefaultUsers() {
 }
 
 bool AuthService::userExists(const std::string &username) const {
-    return lookupUserExists(database_.handle(), username);
+    return lookupUserExists(*database_.reader(), username);
 }
 
 User AuthService::getUserById(int id) {
-    auto row = fetchUserRowById(database_.handle(), id);
+    auto row = fetchUserRowById(*database_.reader(), id);
     if (!row) {
         throw std::runtime_error{"user not found"};
     }
@@ -221,7 +214,7 @@ User AuthService::getUserById(int id) {
 }
 
 std::optional<User> AuthService::getUserByUsername(const std::string &username) {
-    auto row = fetchUserRow(database_.handle(), username);
+    auto row = fetchUserRow(*database_.reader(), username);
     if (!row) {
         return std::nullopt;
     }
@@ -230,11 +223,11 @@ std::optional<User> AuthService::getUserByUsername(const std::string &username)
 
 bool AuthService::changePassword(int user_id, const std::string &new_password) {
     const std::string password_hash = PasswordHasher::hash(new_password);
-    return updatePasswordHash(database_.handle(), user_id, password_hash);
+    return updatePasswordHash(*database_.writer(), user_id, password_hash);
 }
 
 std::vector<User> AuthService::listAllUsers() {
-    return fetchAllUsers(database_.handle());
+    return fetchAllUsers(*database_.reader());
 }
 
 bool AuthService::resetPasswordForUser(int target_user_id, const std::string &new_password) {
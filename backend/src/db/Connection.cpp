@@ -0,0 +1,93 @@
+#include "db/Connection.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace trdp::db {
+
+namespace {
+
+constexpr int kBusyTimeoutMs = 5000;
+
+}  // namespace
+
+Statement::~Statement() {
+    release();
+}
+
+Statement::Statement(Statement &&other) noexcept
+    : stmt_(std::exchange(other.stmt_, nullptr)), in_use_(std::exchange(other.in_use_, nullptr)) {}
+
+Statement &Statement::operator=(Statement &&other) noexcept {
+    if (this != &other) {
+        release();
+        stmt_ = std::exchange(other.stmt_, nullptr);
+        in_use_ = std::exchange(other.in_use_, nullptr);
+    }
+    return *this;
+}
+
+void Statement::release() noexcept {
+    if (stmt_ == nullptr) {
+        return;
+    }
+    if (in_use_ != nullptr) {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+        *in_use_ = false;
+    } else {
+        sqlite3_finalize(stmt_);
+    }
+    stmt_ = nullptr;
+    in_use_ = nullptr;
+}
+
+Connection::Connection(const std::string &path, int flags) {
+    if (sqlite3_open_v2(path.c_str(), &db_, flags, nullptr) != SQLITE_OK) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw std::runtime_error{"Unable to open SQLite database at " + path};
+    }
+    sqlite3_busy_timeout(db_, kBusyTimeoutMs);
+}
+
+Connection::~Connection() {
+    for (auto &[sql, cached] : statements_) {
+        sqlite3_finalize(cached.stmt);
+    }
+    if (db_ != nullptr) {
+        sqlite3_close(db_);
+    }
+}
+
+Statement Connection::prepare(const std::string &sql) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end() && !it->second.in_use) {
+        it->second.in_use = true;
+        return Statement(it->second.stmt, &it->second.in_use);
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return {};
+    }
+    if (it != statements_.end() || statements_.size() >= kMaxCachedStatements) {
+        return Statement(stmt, nullptr);
+    }
+    auto &cached = statements_[sql];
+    cached.stmt = stmt;
+    cached.in_use = true;
+    return Statement(stmt, &cached.in_use);
+}
+
+void Connection::exec(const char *sql) {
+    char *err_msg = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::string error = err_msg ? err_msg : "Unknown error";
+        sqlite3_free(err_msg);
+        throw std::runtime_error{std::string{"SQLite statement failed ("} + sql + "): " + error};
+    }
+}
+
+}  // namespace trdp::db
@@ -1,26 +1,91 @@
 #include "db/Database.hpp"
 
+#include <cassert>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace trdp::db {
 
-Database::Database(const std::string &db_path) : db_path_(db_path) {
-    if (sqlite3_open(db_path_.c_str(), &db_) != SQLITE_OK) {
-        throw std::runtime_error{"Unable to open SQLite database at " + db_path_};
+Database::Database(const std::string &db_path, DatabaseOptions options) : db_path_(db_path), options_(options) {
+    const bool in_memory = db_path_.empty() || db_path_ == ":memory:";
+    if (in_memory) {
+        options_.readers = 0;
     }
+    writer_ = std::make_unique<Connection>(db_path_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX);
+    if (!in_memory) {
+        writer_->exec("PRAGMA journal_mode = WAL;");
+    }
+    writer_->exec("PRAGMA synchronous = NORMAL;");
 
     initializeSchema();
 }
 
-Database::~Database() {
-    if (db_ != nullptr) {
-        sqlite3_close(db_);
-        db_ = nullptr;
+Database::~Database() = default;
+
+namespace {
+
+// Leases the calling thread holds. A nested writer() blocks on the
+// non-recursive writer mutex, as does reader() when readers share the
+// writer, and nested reader() calls can exhaust the pool, so debug builds
+// catch the second request before it can deadlock.
+thread_local int leases_held = 0;
+
+}  // namespace
+
+ConnectionLease Database::writer() {
+    assert(leases_held == 0 && "a thread must not ask for a second connection lease");
+    writer_mutex_.lock();
+    return ConnectionLease(this, writer_.get());
+}
+
+ConnectionLease Database::reader() {
+    assert(leases_held == 0 && "a thread must not ask for a second connection lease");
+    if (options_.readers == 0) {
+        return writer();
+    }
+    std::unique_lock<std::mutex> lock(readers_mutex_);
+    reader_released_.wait(lock, [this] { return !idle_readers_.empty() || readers_.size() < options_.readers; });
+    if (idle_readers_.empty()) {
+        // Opened under the lock; this happens once per pool slot.
+        readers_.push_back(std::make_unique<Connection>(db_path_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX));
+        readers_.back()->exec("PRAGMA query_only = ON;");
+        return ConnectionLease(this, readers_.back().get());
+    }
+    Connection *connection = idle_readers_.back();
+    idle_readers_.pop_back();
+    return ConnectionLease(this, connection);
+}
+
+void Database::release(Connection *connection) noexcept {
+    if (connection == writer_.get()) {
+        writer_mutex_.unlock();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex_);
+        idle_readers_.push_back(connection);
+    }
+    reader_released_.notify_one();
+}
+
+ConnectionLease::ConnectionLease(Database *owner, Connection *connection) noexcept
+    : owner_(owner), connection_(connection) {
+    ++leases_held;
+}
+
+ConnectionLease::~ConnectionLease() {
+    if (owner_ != nullptr) {
+        owner_->release(connection_);
+        --leases_held;
     }
 }
 
+ConnectionLease::ConnectionLease(ConnectionLease &&other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr)), connection_(std::exchange(other.connection_, nullptr)) {}
+
 void Database::initializeSchema() {
+    sqlite3 *db = writer_->handle();
     const std::vector<const char *> statements = {
         "CREATE TABLE IF NOT EXISTS users ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -56,7 +121,25 @@ void Database::initializeSchema() {
         "src_ip TEXT,"
         "dst_ip TEXT,"
         "payload BLOB,"
-        "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP);",
+        "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "repeat_count INTEGER NOT NULL DEFAULT 1,"
+        "last_timestamp DATETIME);",
+        // PD traffic per second, minute and hour (resolution in seconds);
+        // bucket_start is unix time.
+        "CREATE TABLE IF NOT EXISTS trdp_rollups ("
+        "resolution INTEGER NOT NULL,"
+        "bucket_start INTEGER NOT NULL,"
+        "direction TEXT NOT NULL,"
+        "msg_id INTEGER NOT NULL,"
+        "src_ip TEXT NOT NULL,"
+        "dst_ip TEXT NOT NULL,"
+        "packets INTEGER NOT NULL,"
+        "bytes INTEGER NOT NULL,"
+        "min_gap_ns INTEGER,"
+        "max_gap_ns INTEGER,"
+        "changes INTEGER NOT NULL,"
+        "last_payload BLOB,"
+        "PRIMARY KEY (resolution, bucket_start, msg_id, direction, src_ip, dst_ip)) WITHOUT ROWID;",
         "CREATE TABLE IF NOT EXISTS app_logs ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "level TEXT NOT NULL,"
@@ -66,12 +149,67 @@ void Database::initializeSchema() {
 
     char *err_msg = nullptr;
     for (const auto *statement : statements) {
-        if (sqlite3_exec(db_, statement, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        if (sqlite3_exec(db, statement, nullptr, nullptr, &err_msg) != SQLITE_OK) {
             std::string error = err_msg ? err_msg : "Unknown error";
             sqlite3_free(err_msg);
             throw std::runtime_error{"Failed to initialize database schema: " + error};
         }
     }
+
+    // Columns added after the first release; CREATE TABLE IF NOT EXISTS
+    // leaves older databases without them.
+    addMissingColumn("trdp_logs", "repeat_count", "INTEGER NOT NULL DEFAULT 1");
+    addMissingColumn("trdp_logs", "last_timestamp", "DATETIME");
+
+    // Log filters are equality matches paged newest first. SQLite appends
+    // the rowid to every index entry, so each index below is ordered by
+    // (column, id): `column = ? AND id < ? ORDER BY id DESC` is a single
+    // backwards range scan, and COUNT(*) is answered from the index alone.
+    // trdp_logs here only holds rows logged before partitioning; the
+    // partitions get the same indexes from TrdpLogPartitions.
+    const std::vector<const char *> indexes = {
+        "CREATE INDEX IF NOT EXISTS idx_trdp_logs_type ON trdp_logs (type);",
+        "CREATE INDEX IF NOT EXISTS idx_trdp_logs_msg_id ON trdp_logs (msg_id);",
+        "CREATE INDEX IF NOT EXISTS idx_trdp_logs_src_ip ON trdp_logs (src_ip);",
+        "CREATE INDEX IF NOT EXISTS idx_trdp_logs_timestamp ON trdp_logs (timestamp);",
+        // Levels used to be stored as passed in; they are upper case now so
+        // that the filter can compare them as they are.
+        "UPDATE app_logs SET level = UPPER(level) WHERE level <> UPPER(level);",
+        "CREATE INDEX IF NOT EXISTS idx_app_logs_level ON app_logs (level);",
+    };
+    for (const auto *statement : indexes) {
+        if (sqlite3_exec(db, statement, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+            std::string error = err_msg ? err_msg : "Unknown error";
+            sqlite3_free(err_msg);
+            throw std::runtime_error{"Failed to create database indexes: " + error};
+        }
+    }
+}
+
+void Database::addMissingColumn(const std::string &table, const std::string &column, const std::string &definition) {
+    sqlite3 *db = writer_->handle();
+    sqlite3_stmt *stmt = nullptr;
+    const std::string pragma = "PRAGMA table_info(" + table + ");";
+    if (sqlite3_prepare_v2(db, pragma.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error{"Failed to inspect table " + table};
+    }
+    bool present = false;
+    while (!present && sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char *name = sqlite3_column_text(stmt, 1);
+        present = name != nullptr && column == reinterpret_cast<const char *>(name);
+    }
+    sqlite3_finalize(stmt);
+    if (present) {
+        return;
+    }
+
+    const std::string alter = "ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";";
+    char *err_msg = nullptr;
+    if (sqlite3_exec(db, alter.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::string error = err_msg ? err_msg : "Unknown error";
+        sqlite3_free(err_msg);
+        throw std::runtime_error{"Failed to add column " + table + "." + column + ": " + error};
+    }
 }
 
 }  // namespace trdp::db
@@ -0,0 +1,101 @@
+#include "http/HttpMetrics.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+#include "httplib.h"
+
+namespace trdp::http {
+
+namespace {
+
+constexpr std::array<std::string_view, 5> kStatusClasses = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+thread_local std::chrono::steady_clock::time_point request_start;
+
+}  // namespace
+
+void HttpMetrics::install(httplib::Server &server) {
+    server.set_pre_routing_handler([](const httplib::Request &, httplib::Response &) {
+        request_start = std::chrono::steady_clock::now();
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+    server.set_logger([this](const httplib::Request &req, const httplib::Response &res) {
+        const auto elapsed = std::chrono::steady_clock::now() - request_start;
+        record(req.method, routeLabel(req), res.status,
+               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    });
+}
+
+void HttpMetrics::record(std::string_view method, std::string label, int status, int64_t latency_ns) {
+    // The method of an unmatched request is whatever the client sent.
+    Route &route = routeFor(label == kUnmatched ? kUnmatched : method, std::move(label));
+    const int status_class = status / 100;
+    if (status_class >= 1 && status_class <= 5) {
+        route.responses[static_cast<size_t>(status_class - 1)].add();
+    }
+    route.latency.record(latency_ns);
+}
+
+HttpMetrics::Route &HttpMetrics::routeFor(std::string_view method, std::string label) {
+    auto key = std::make_pair(std::string(method), std::move(label));
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (auto it = routes_.find(key); it != routes_.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto &route = routes_[key];
+    if (!route) {
+        route = std::make_unique<Route>();
+    }
+    return *route;
+}
+
+void HttpMetrics::appendTo(util::OpenMetricsWriter &writer) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    writer.family("trdp_http_requests", "counter", "HTTP requests served, by route and status class");
+    for (const auto &[key, route] : routes_) {
+        for (size_t i = 0; i < kStatusClasses.size(); ++i) {
+            const uint64_t count = route->responses[i].value();
+            if (count > 0) {
+                writer.counter("trdp_http_requests", count,
+                               {{"method", key.first}, {"route", key.second}, {"code", kStatusClasses[i]}});
+            }
+        }
+    }
+    writer.family("trdp_http_request_duration_seconds", "summary", "Time from routing to the end of the response",
+                  "seconds");
+    for (const auto &[key, route] : routes_) {
+        writer.summary("trdp_http_request_duration_seconds", route->latency.snapshot(),
+                       {{"method", key.first}, {"route", key.second}});
+    }
+}
+
+std::string HttpMetrics::routeLabel(const httplib::Request &req) {
+    // cpp-httplib leaves `matches` empty unless a handler's pattern matched
+    // the whole path.
+    if (req.matches.empty()) {
+        return std::string(kUnmatched);
+    }
+    if (req.path.compare(0, 5, "/api/") != 0 && req.path != "/health" && req.path != "/metrics") {
+        return "/*";
+    }
+    std::string label;
+    size_t end = 0;
+    for (size_t i = 1; i < req.matches.size(); ++i) {
+        if (!req.matches[i].matched) {
+            continue;
+        }
+        const auto position = static_cast<size_t>(req.matches.position(i));
+        label.append(req.path, end, position - end);
+        label += ":id";
+        end = position + static_cast<size_t>(req.matches.length(i));
+    }
+    label.append(req.path, end, std::string::npos);
+    return label;
+}
+
+}  // namespace trdp::http
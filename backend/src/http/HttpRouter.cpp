@@ -1,17 +1,23 @@
 #include "http/HttpRouter.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "auth/AuthManager.hpp"
 #include "auth/AuthService.hpp"
 #include "http/JsonUtils.hpp"
+#include "http/JsonWriter.hpp"
 #include "httplib.h"
 #include "network/NetworkConfigService.hpp"
 #include "trdp/ConfigService.hpp"
@@ -33,34 +39,28 @@ std::optional<int> extractPathId(const httplib::Request &req) {
     }
 }
 
-std::string serializeStringArray(const std::vector<std::string> &values) {
-    std::string payload = "[";
-    for (size_t i = 0; i < values.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
-        }
-        payload += "\"" + json::escape(values[i]) + "\"";
+// Serializes {"config": {...}} for the network configuration endpoints.
+std::string networkConfigResponse(const network::NetworkConfig &config) {
+    json::JsonWriter writer(256);
+    writer.beginObject().key("config").beginObject();
+    writer.key("interface_name").value(config.interface_name);
+    writer.key("local_ip").value(config.local_ip);
+    writer.key("multicast_groups").beginArray();
+    for (const auto &group : config.multicast_groups) {
+        writer.value(group);
     }
-    payload += "]";
-    return payload;
-}
-
-std::string serializeNetworkConfig(const network::NetworkConfig &config) {
-    return std::string{"{"} +
-           "\"interface_name\":\"" + json::escape(config.interface_name) + "\"," +
-           "\"local_ip\":\"" + json::escape(config.local_ip) + "\"," +
-           "\"multicast_groups\":" + serializeStringArray(config.multicast_groups) + "," +
-           "\"pd_port\":" + std::to_string(config.pd_port) + "," +
-           "\"md_port\":" + std::to_string(config.md_port) + "}";
+    writer.endArray();
+    writer.key("pd_port").value(config.pd_port);
+    writer.key("md_port").value(config.md_port);
+    writer.endObject().endObject();
+    return writer.take();
 }
 
-std::optional<stack::PdMessage> findPdById(const std::vector<stack::PdMessage> &messages, int id) {
-    for (const auto &msg : messages) {
-        if (msg.id == id) {
-            return msg;
-        }
-    }
-    return std::nullopt;
+// Wraps an already serialized value as {"<name>": value}.
+std::string wrapJson(std::string_view name, std::string_view value) {
+    json::JsonWriter writer(name.size() + value.size() + 8);
+    writer.beginObject().key(name).rawValue(value).endObject();
+    return writer.take();
 }
 
 int queryInt(const httplib::Request &req, const std::string &name, int default_value) {
@@ -74,6 +74,22 @@ int queryInt(const httplib::Request &req, const std::string &name, int default_v
     }
 }
 
+// Parses an unsigned version cursor such as `since`; nullopt when malformed.
+std::optional<uint64_t> parseVersion(const std::string &value) {
+    uint64_t version = 0;
+    const auto *end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, version);
+    if (value.empty() || ec != std::errc{} || ptr != end) {
+        return std::nullopt;
+    }
+    return version;
+}
+
+constexpr int kStreamDefaultIntervalMs = 250;
+constexpr int kStreamMinIntervalMs = 50;
+constexpr int kStreamMaxIntervalMs = 5000;
+constexpr std::chrono::seconds kStreamKeepAlive {15};
+
 std::optional<std::string> queryString(const httplib::Request &req, const std::string &name) {
     if (!req.has_param(name)) {
         return std::nullopt;
@@ -85,6 +101,59 @@ std::optional<std::string> queryString(const httplib::Request &req, const std::s
     return value;
 }
 
+// Accepts "1s", "1m", "1h" or a number of seconds.
+int parseRollupResolution(const std::string &value) {
+    if (value == "1s") {
+        return 1;
+    }
+    if (value == "1m") {
+        return 60;
+    }
+    if (value == "1h") {
+        return 3600;
+    }
+    int seconds = 0;
+    const auto *end = value.data() + value.size();
+    if (std::from_chars(value.data(), end, seconds).ptr != end) {
+        throw std::invalid_argument{"resolution must be 1s, 1m or 1h"};
+    }
+    return seconds;
+}
+
+std::optional<int64_t> queryUnixTime(const httplib::Request &req, const std::string &name) {
+    const auto value = queryString(req, name);
+    if (!value) {
+        return std::nullopt;
+    }
+    int64_t seconds = 0;
+    const auto *end = value->data() + value->size();
+    if (std::from_chars(value->data(), end, seconds).ptr != end) {
+        throw std::invalid_argument{name + " must be a unix time in seconds"};
+    }
+    return seconds;
+}
+
+// Parses a row id cursor such as `before_id`; throws std::invalid_argument
+// when malformed.
+std::optional<int64_t> queryRowId(const httplib::Request &req, const std::string &name) {
+    const auto value = queryString(req, name);
+    if (!value) {
+        return std::nullopt;
+    }
+    int64_t id = 0;
+    const auto *end = value->data() + value->size();
+    if (std::from_chars(value->data(), end, id).ptr != end || id < 0) {
+        throw std::invalid_argument{name + " must be a log row id"};
+    }
+    return id;
+}
+
+// "1", "true" and "yes" switch a flag on; anything else, or no value, is off.
+bool queryFlag(const httplib::Request &req, const std::string &name) {
+    const auto value = queryString(req, name);
+    return value && (*value == "1" || *value == "true" || *value == "yes");
+}
+
 }  // namespace
 
 HttpRouter::HttpRouter(auth::AuthManager &auth_manager, auth::AuthService &auth_service,
@@ -95,14 +164,18 @@ HttpRouter::HttpRouter(auth::AuthManager &auth_manager, auth::AuthService &auth_
       config_service_(config_service),
       network_config_service_(network_config_service),
       trdp_engine_(trdp_engine),
-      log_service_(log_service) {}
+      log_service_(log_service),
+      stream_broadcaster_(trdp_engine) {}
 
 void HttpRouter::registerRoutes(httplib::Server &server) {
+    http_metrics_.install(server);
     registerHealthEndpoint(server);
+    registerMetricsEndpoint(server);
     auth_manager_.registerRoutes(server);
     config_service_.registerRoutes(server);
     registerNetworkConfigEndpoints(server);
     registerTrdpEngineEndpoints(server);
+    registerStreamEndpoints(server);
     registerAccountEndpoints(server);
     registerLogEndpoints(server);
     registerFrontendEndpoints(server);
@@ -114,6 +187,65 @@ void HttpRouter::registerHealthEndpoint(httplib::Server &server) {
     });
 }
 
+void HttpRouter::registerMetricsEndpoint(httplib::Server &server) {
+    // OpenMetrics exposition for Prometheus. Like /health it needs no
+    // session so that scrapers can reach it.
+    server.Get("/metrics", [this](const httplib::Request &, httplib::Response &res) {
+        const auto engine = trdp_engine_.metrics();
+        const auto log_writer = trdp_engine_.logWriterStats();
+        util::OpenMetricsWriter writer;
+
+        writer.family("trdp_packets", "counter", "TRDP telegrams sent and received");
+        writer.family("trdp_bytes", "counter", "TRDP dataset bytes sent and received", "bytes");
+        const std::pair<const char *, const stack::TrafficCounts *> traffic[] = {
+            {"pd", &engine.pd_in}, {"pd", &engine.pd_out}, {"md", &engine.md_in}, {"md", &engine.md_out}};
+        for (size_t i = 0; i < std::size(traffic); ++i) {
+            const util::MetricLabels labels = {{"type", traffic[i].first}, {"direction", i % 2 == 0 ? "in" : "out"}};
+            writer.counter("trdp_packets", traffic[i].second->packets, labels);
+        }
+        for (size_t i = 0; i < std::size(traffic); ++i) {
+            const util::MetricLabels labels = {{"type", traffic[i].first}, {"direction", i % 2 == 0 ? "in" : "out"}};
+            writer.counter("trdp_bytes", traffic[i].second->bytes, labels);
+        }
+
+        writer.family("trdp_stack_errors", "counter", "Failed TRDP stack calls");
+        writer.counter("trdp_stack_errors", engine.put_errors, {{"call", "tlp_put"}});
+        writer.counter("trdp_stack_errors", engine.process_errors, {{"call", "tlc_process"}});
+
+        writer.family("trdp_scheduler_lateness_seconds", "summary",
+                      "Delay between a PD cycle deadline and the worker picking it up", "seconds");
+        writer.summary("trdp_scheduler_lateness_seconds", engine.scheduler_lateness);
+
+        writer.family("trdp_receive_latency_seconds", "summary",
+                      "Time from datagram arrival to the receive callback", "seconds");
+        writer.summary("trdp_receive_latency_seconds", trdp_engine_.receiveLatency(),
+                       {{"clock", stack::receiveClockName(trdp_engine_.receiveClock())}});
+
+        writer.family("trdp_log_queue_depth", "gauge", "TRDP log records waiting for the database writer");
+        writer.gauge("trdp_log_queue_depth", static_cast<double>(log_writer.queue_depth));
+        writer.family("trdp_log_records", "counter", "TRDP log records by outcome");
+        writer.counter("trdp_log_records", log_writer.enqueued, {{"outcome", "enqueued"}});
+        writer.counter("trdp_log_records", log_writer.written, {{"outcome", "written"}});
+        writer.counter("trdp_log_records", log_writer.dropped, {{"outcome", "dropped"}});
+        writer.counter("trdp_log_records", log_writer.deduplicated, {{"outcome", "deduplicated"}});
+        writer.family("trdp_sqlite_write_duration_seconds", "summary",
+                      "Duration of each TRDP log batch transaction", "seconds");
+        writer.summary("trdp_sqlite_write_duration_seconds", log_writer.write_latency);
+
+        http_metrics_.appendTo(writer);
+        writer.family("trdp_http_streams", "gauge", "Open /api/stream connections");
+        writer.gauge("trdp_http_streams", static_cast<double>(stream_broadcaster_.subscribers()));
+        writer.family("trdp_http_stream_frames", "counter", "Live update frames serialized for all streams");
+        writer.counter("trdp_http_stream_frames", stream_broadcaster_.framesBuilt());
+
+        writer.family("trdp_auth_sessions", "gauge", "Logged-in user sessions");
+        writer.gauge("trdp_auth_sessions", static_cast<double>(auth_manager_.sessionCount()));
+
+        res.status = 200;
+        res.set_content(writer.finish(), "application/openmetrics-text; version=1.0.0; charset=utf-8");
+    });
+}
+
 void HttpRouter::registerNetworkConfigEndpoints(httplib::Server &server) {
     server.Get("/api/network/config", [this](const httplib::Request &req, httplib::Response &res) {
         auto user = auth_manager_.userFromRequest(req);
@@ -131,9 +263,8 @@ void HttpRouter::registerNetworkConfigEndpoints(httplib::Server &server) {
                 return;
             }
 
-            std::string payload = "{\"config\":" + serializeNetworkConfig(*config) + "}";
             res.status = 200;
-            res.set_content(payload, "application/json");
+            res.set_content(networkConfigResponse(*config), "application/json");
         } catch (const std::exception &ex) {
             res.status = 500;
             res.set_content(json::error(ex.what()), "application/json");
@@ -171,9 +302,8 @@ void HttpRouter::registerNetworkConfigEndpoints(httplib::Server &server) {
 
         try {
             auto stored = network_config_service_.saveConfig(config);
-            std::string payload = "{\"config\":" + serializeNetworkConfig(stored) + "}";
             res.status = 200;
-            res.set_content(payload, "application/json");
+            res.set_content(networkConfigResponse(stored), "application/json");
             config_service_.ensureTrdpEngineLoaded();
         } catch (const std::exception &ex) {
             res.status = 500;
@@ -191,6 +321,17 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
             return;
         }
 
+        if (req.has_param("since")) {
+            auto since = parseVersion(req.get_param_value("since"));
+            if (!since) {
+                res.status = 400;
+                res.set_content(json::error("since must be a non-negative integer"), "application/json");
+                return;
+            }
+            res.status = 200;
+            res.set_content(json::pdDeltaJson(trdp_engine_.outgoingPdSince(*since), true), "application/json");
+            return;
+        }
         auto messages = trdp_engine_.listOutgoingPd();
         res.status = 200;
         res.set_content(json::pdListJson(messages, true), "application/json");
@@ -204,6 +345,17 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
             return;
         }
 
+        if (req.has_param("since")) {
+            auto since = parseVersion(req.get_param_value("since"));
+            if (!since) {
+                res.status = 400;
+                res.set_content(json::error("since must be a non-negative integer"), "application/json");
+                return;
+            }
+            res.status = 200;
+            res.set_content(json::pdDeltaJson(trdp_engine_.incomingPdSince(*since), false), "application/json");
+            return;
+        }
         auto messages = trdp_engine_.listIncomingPd();
         res.status = 200;
         res.set_content(json::pdListJson(messages, false), "application/json");
@@ -223,8 +375,7 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
             res.set_content(json::error("invalid PD message id"), "application/json");
             return;
         }
-        auto messages = trdp_engine_.listOutgoingPd();
-        auto message = findPdById(messages, *msg_id);
+        auto message = trdp_engine_.findOutgoingPd(*msg_id);
         if (!message) {
             res.status = 404;
             res.set_content(json::error("PD message not found"), "application/json");
@@ -261,11 +412,16 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
             res.set_content(json::error("payload_hex must be an even-length hex string"), "application/json");
             return;
         }
+        if (payload_bytes->size() > stack::kMaxPdPayloadSize) {
+            res.status = 400;
+            res.set_content(json::error("payload exceeds " + std::to_string(stack::kMaxPdPayloadSize) + " bytes"),
+                            "application/json");
+            return;
+        }
 
         try {
             trdp_engine_.updateOutgoingPdPayload(*msg_id, *payload_bytes);
-            auto messages = trdp_engine_.listOutgoingPd();
-            auto message = findPdById(messages, *msg_id);
+            auto message = trdp_engine_.findOutgoingPd(*msg_id);
             if (!message) {
                 res.status = 404;
                 res.set_content(json::error("PD message not found"), "application/json");
@@ -284,6 +440,186 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
         }
     });
 
+    server.Get(R"(/api/pd/outgoing/(\d+)/fields)", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        auto msg_id = extractPathId(req);
+        if (!msg_id) {
+            res.status = 400;
+            res.set_content(json::error("invalid PD message id"), "application/json");
+            return;
+        }
+        auto message = trdp_engine_.findOutgoingPd(*msg_id);
+        if (!message) {
+            res.status = 404;
+            res.set_content(json::error("PD message not found"), "application/json");
+            return;
+        }
+        if (!message->dataset) {
+            res.status = 409;
+            res.set_content(json::error("PD message has no dataset layout"), "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(json::pdFieldsJson(*message), "application/json");
+    });
+
+    server.Patch(R"(/api/pd/outgoing/(\d+)/fields)", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        auto msg_id = extractPathId(req);
+        if (!msg_id) {
+            res.status = 400;
+            res.set_content(json::error("invalid PD message id"), "application/json");
+            return;
+        }
+        auto updates = json::pdFieldUpdates(req.body);
+        if (!updates || updates->empty()) {
+            res.status = 400;
+            res.set_content(json::error("fields must be a non-empty object of field values"), "application/json");
+            return;
+        }
+
+        try {
+            trdp_engine_.updateOutgoingPdFields(*msg_id, *updates);
+            auto message = trdp_engine_.findOutgoingPd(*msg_id);
+            if (!message) {
+                res.status = 404;
+                res.set_content(json::error("PD message not found"), "application/json");
+                return;
+            }
+            res.status = 200;
+            res.set_content(json::pdFieldsJson(*message), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            std::string message = ex.what();
+            if (message.find("not found") != std::string::npos) {
+                res.status = 404;
+            } else {
+                res.status = 500;
+            }
+            res.set_content(json::error(message), "application/json");
+        }
+    });
+
+    server.Get(R"(/api/pd/outgoing/(\d+)/generators)", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        auto msg_id = extractPathId(req);
+        if (!msg_id) {
+            res.status = 400;
+            res.set_content(json::error("invalid PD message id"), "application/json");
+            return;
+        }
+        try {
+            auto specs = trdp_engine_.outgoingPdGenerators(*msg_id);
+            res.status = 200;
+            res.set_content(json::pdGeneratorsJson(*msg_id, specs), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            std::string message = ex.what();
+            if (message.find("not found") != std::string::npos) {
+                res.status = 404;
+            } else {
+                res.status = 500;
+            }
+            res.set_content(json::error(message), "application/json");
+        }
+    });
+
+    server.Put(R"(/api/pd/outgoing/(\d+)/generators)", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        auto msg_id = extractPathId(req);
+        if (!msg_id) {
+            res.status = 400;
+            res.set_content(json::error("invalid PD message id"), "application/json");
+            return;
+        }
+        auto specs = json::pdGeneratorSpecs(req.body);
+        if (!specs) {
+            res.status = 400;
+            res.set_content(json::error("generators must be a list of objects with a field and a type of counter, "
+                                        "sawtooth, sine, random, sequence or expression"),
+                            "application/json");
+            return;
+        }
+
+        try {
+            trdp_engine_.setOutgoingPdGenerators(*msg_id, *specs);
+            res.status = 200;
+            res.set_content(json::pdGeneratorsJson(*msg_id, trdp_engine_.outgoingPdGenerators(*msg_id)),
+                            "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            std::string message = ex.what();
+            if (message.find("not found") != std::string::npos) {
+                res.status = 404;
+            } else {
+                res.status = 500;
+            }
+            res.set_content(json::error(message), "application/json");
+        }
+    });
+
+    server.Delete(R"(/api/pd/outgoing/(\d+)/generators)", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        auto msg_id = extractPathId(req);
+        if (!msg_id) {
+            res.status = 400;
+            res.set_content(json::error("invalid PD message id"), "application/json");
+            return;
+        }
+        try {
+            trdp_engine_.setOutgoingPdGenerators(*msg_id, {});
+            res.status = 200;
+            res.set_content(json::pdGeneratorsJson(*msg_id, {}), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            std::string message = ex.what();
+            if (message.find("not found") != std::string::npos) {
+                res.status = 404;
+            } else {
+                res.status = 500;
+            }
+            res.set_content(json::error(message), "application/json");
+        }
+    });
+
     server.Post("/api/md/send", [this](const httplib::Request &req, httplib::Response &res) {
         auto user = auth_manager_.userFromRequest(req);
         if (!user) {
@@ -333,10 +669,109 @@ void HttpRouter::registerTrdpEngineEndpoints(httplib::Server &server) {
             return;
         }
 
-        auto messages = trdp_engine_.listIncomingMd();
+        const int since_id = std::max(queryInt(req, "since_id", 0), 0);
+        const int limit = std::max(queryInt(req, "limit", 0), 0);
+        auto messages = trdp_engine_.listIncomingMd(since_id, static_cast<size_t>(limit));
         res.status = 200;
         res.set_content(json::mdIncomingListJson(messages), "application/json");
     });
+
+    server.Get("/api/stats/receive-latency", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        res.status = 200;
+        res.set_content(json::receiveLatencyJson(stack::receiveClockName(trdp_engine_.receiveClock()),
+                                                 trdp_engine_.receiveLatency()),
+                        "application/json");
+    });
+
+    server.Get("/api/stats/telegrams", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        res.status = 200;
+        res.set_content(json::pdTimingListJson(trdp_engine_.pdTimingStats()), "application/json");
+    });
+
+    server.Get("/api/stats/rollups", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        try {
+            util::RollupQuery query;
+            if (auto resolution = queryString(req, "resolution")) {
+                query.resolution_s = parseRollupResolution(*resolution);
+            }
+            if (req.has_param("msg_id")) {
+                query.msg_id = queryInt(req, "msg_id", 0);
+            }
+            query.direction = queryString(req, "direction");
+            query.from = queryUnixTime(req, "from");
+            query.to = queryUnixTime(req, "to");
+            query.limit = queryInt(req, "limit", query.limit);
+            auto rollups = log_service_.getRollups(query);
+            res.status = 200;
+            res.set_content(json::rollupListJson(query.resolution_s, rollups), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            res.status = 500;
+            res.set_content(json::error(ex.what()), "application/json");
+        }
+    });
+}
+
+void HttpRouter::registerStreamEndpoints(httplib::Server &server) {
+    // Server-Sent Events feed of PD and MD changes. Each frame carries only
+    // the telegrams whose payload changed since the previous frame, so bursts
+    // on one comId collapse into its latest value at the client's interval.
+    // Frames are built once per tick for all connections (see
+    // StreamBroadcaster); this handler only waits for them and writes them.
+    server.Get("/api/stream", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
+        }
+
+        const auto interval = std::chrono::milliseconds(std::clamp(
+            queryInt(req, "interval_ms", kStreamDefaultIntervalMs), kStreamMinIntervalMs, kStreamMaxIntervalMs));
+        std::shared_ptr<StreamBroadcaster::Subscription> subscription = stream_broadcaster_.subscribe(interval);
+        if (!subscription) {
+            res.status = 503;
+            res.set_header("Retry-After", "5");
+            res.set_content(json::error("too many open streams"), "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider(
+            "text/event-stream", [subscription](size_t, httplib::DataSink &sink) {
+                if (auto frame = subscription->next(kStreamKeepAlive)) {
+                    return sink.write(frame->data(), frame->size());
+                }
+                // Nothing changed for a while. A comment line lets dead
+                // connections surface as write errors.
+                static constexpr char kKeepAlive[] = ": keep-alive\n\n";
+                return sink.write(kKeepAlive, sizeof(kKeepAlive) - 1);
+            });
+    });
 }
 
 void HttpRouter::registerAccountEndpoints(httplib::Server &server) {
@@ -349,7 +784,7 @@ void HttpRouter::registerAccountEndpoints(httplib::Server &server) {
         try {
             auto fresh_user = auth_service_.getUserById(static_cast<int>(user->id));
             res.status = 200;
-            res.set_content("{\"user\":" + json::userJson(fresh_user) + "}", "application/json");
+            res.set_content(wrapJson("user", json::userJson(fresh_user)), "application/json");
         } catch (const std::exception &ex) {
             res.status = 404;
             res.set_content(json::error(ex.what()), "application/json");
@@ -405,7 +840,7 @@ void HttpRouter::registerAccountEndpoints(httplib::Server &server) {
         try {
             auto users = auth_service_.listAllUsers();
             res.status = 200;
-            res.set_content("{\"users\":" + json::userListJson(users) + "}", "application/json");
+            res.set_content(wrapJson("users", json::userListJson(users)), "application/json");
         } catch (const std::exception &ex) {
             res.status = 500;
             res.set_content(json::error(ex.what()), "application/json");
@@ -476,7 +911,7 @@ void HttpRouter::registerFrontendEndpoints(httplib::Server &server) {
         frontend_available_ = true;
     }
 
-    server.Get(R"(^/(?!api/)(?!health$).*)", [this](const httplib::Request &req, httplib::Response &res) {
+    server.Get(R"(^/(?!api/)(?!health$)(?!metrics$).*)", [this](const httplib::Request &req, httplib::Response &res) {
         if (frontend_available_ && serveFrontendAsset(req, res)) {
             return;
         }
@@ -490,7 +925,7 @@ void HttpRouter::registerFrontendEndpoints(httplib::Server &server) {
 }
 
 bool HttpRouter::serveFrontendAsset(const httplib::Request &req, httplib::Response &res) const {
-    if (!frontend_available_ || isApiRequest(req.path) || req.path == "/health") {
+    if (!frontend_available_ || isApiRequest(req.path) || req.path == "/health" || req.path == "/metrics") {
         return false;
     }
 
@@ -629,23 +1064,46 @@ void HttpRouter::registerLogEndpoints(httplib::Server &server) {
             return;
         }
 
-        int limit = queryInt(req, "limit", 100);
-        int offset = queryInt(req, "offset", 0);
-        if (limit <= 0) {
-            limit = 1;
+        util::TrdpLogQuery query;
+        query.limit = queryInt(req, "limit", 100);
+        query.offset = queryInt(req, "offset", 0);
+        query.type = queryString(req, "type");
+        query.direction = queryString(req, "direction");
+        if (req.has_param("msg_id")) {
+            query.msg_id = queryInt(req, "msg_id", 0);
         }
-        if (limit > 500) {
-            limit = 500;
+        query.src_ip = queryString(req, "src_ip");
+        query.expand_runs = queryFlag(req, "expand");
+
+        try {
+            query.before_id = queryRowId(req, "before_id");
+            query.from = queryUnixTime(req, "from");
+            query.to = queryUnixTime(req, "to");
+            auto logs = log_service_.getTrdpLogs(query);
+            res.status = 200;
+            res.set_content(json::trdpLogListJson(logs), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
+        } catch (const std::exception &ex) {
+            res.status = 500;
+            res.set_content(json::error(ex.what()), "application/json");
         }
-        if (offset < 0) {
-            offset = 0;
+    });
+
+    server.Get("/api/logs/trdp/partitions", [this](const httplib::Request &req, httplib::Response &res) {
+        auto user = auth_manager_.userFromRequest(req);
+        if (!user) {
+            res.status = 401;
+            res.set_content(json::error("authentication required"), "application/json");
+            return;
         }
 
         try {
-            auto logs = log_service_.getTrdpLogs(limit, offset, queryString(req, "type"),
-                                                 queryString(req, "direction"));
             res.status = 200;
-            res.set_content(json::trdpLogListJson(logs), "application/json");
+            res.set_content(json::logPartitionListJson(log_service_.trdpLogStorage(),
+                                                       log_service_.trdpLogPartitions()),
+                            "application/json");
         } catch (const std::exception &ex) {
             res.status = 500;
             res.set_content(json::error(ex.what()), "application/json");
@@ -673,9 +1131,12 @@ void HttpRouter::registerLogEndpoints(httplib::Server &server) {
         }
 
         try {
-            auto logs = log_service_.getAppLogs(limit, offset, queryString(req, "level"));
+            auto logs = log_service_.getAppLogs(limit, offset, queryString(req, "level"), queryRowId(req, "before_id"));
             res.status = 200;
             res.set_content(json::appLogListJson(logs), "application/json");
+        } catch (const std::invalid_argument &ex) {
+            res.status = 400;
+            res.set_content(json::error(ex.what()), "application/json");
         } catch (const std::exception &ex) {
             res.status = 500;
             res.set_content(json::error(ex.what()), "application/json");
@@ -2,10 +2,15 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cmath>
 #include <sstream>
+#include <string_view>
 
 #include "auth/User.hpp"
+#include "http/JsonWriter.hpp"
 #include "trdp/TrdpEngine.hpp"
+#include "util/Hex.hpp"
 #include "util/LogService.hpp"
 
 namespace trdp::http::json {
@@ -22,52 +27,476 @@ std::string trimCopy(const std::string &value) {
 }
 
 std::string bytesToHexSpan(const uint8_t *data, size_t size) {
-    if (data == nullptr || size == 0) {
-        return "";
-    }
-    static constexpr char kHex[] = "0123456789abcdef";
     std::string hex;
-    hex.reserve(size * 2);
-    for (size_t i = 0; i < size; ++i) {
-        const uint8_t byte = data[i];
-        hex.push_back(kHex[(byte >> 4) & 0x0F]);
-        hex.push_back(kHex[byte & 0x0F]);
-    }
+    appendHex(hex, data, size);
     return hex;
 }
 
+void writePdMessage(JsonWriter &writer, const stack::PdMessage &message, bool include_cycle_time) {
+    writer.beginObject();
+    writer.key("id").value(message.id);
+    writer.key("name").value(message.name);
+    if (include_cycle_time) {
+        writer.key("cycle_time_ms").value(message.cycle_time_ms);
+    }
+    writer.key("payload_hex").hexValue(message.payload);
+    writer.key("version").value(message.version);
+    writer.key("last_update_utc").value(message.timestamp);
+    writer.endObject();
+}
+
+void writePdList(JsonWriter &writer, const std::vector<std::shared_ptr<const stack::PdMessage>> &messages,
+                 bool include_cycle_time) {
+    writer.beginArray();
+    for (const auto &message : messages) {
+        writePdMessage(writer, *message, include_cycle_time);
+    }
+    writer.endArray();
+}
+
+void writeFieldScalar(JsonWriter &writer, const stack::DatasetField &field, const stack::FieldScalar &value) {
+    if (field.kind == stack::FieldKind::kBool) {
+        writer.value(std::get<uint64_t>(value) != 0U);
+    } else if (const auto *number = std::get_if<int64_t>(&value)) {
+        writer.value(*number);
+    } else if (const auto *number = std::get_if<uint64_t>(&value)) {
+        writer.value(*number);
+    } else {
+        writer.value(std::get<double>(value));
+    }
+}
+
+// Describes the dataset and decodes `payload` into a name -> value map. CHAR8
+// arrays become strings and other arrays JSON arrays.
+void writeDataset(JsonWriter &writer, const stack::DatasetLayout &layout, const std::vector<uint8_t> &payload) {
+    writer.key("dataset").beginObject();
+    writer.key("id").value(layout.dataset_id);
+    writer.key("name").value(layout.name);
+    writer.key("size").value(layout.size);
+    writer.key("fields").beginArray();
+    for (const auto &field : layout.fields) {
+        writer.beginObject();
+        writer.key("name").value(field.name);
+        writer.key("type").value(stack::fieldTypeName(field.type));
+        writer.key("offset").value(field.offset);
+        writer.key("count").value(field.count);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+
+    std::vector<uint8_t> host(layout.size);
+    stack::wireToHost(layout, payload.data(), payload.size(), host.data());
+    writer.key("fields").beginObject();
+    for (const auto &field : layout.fields) {
+        writer.key(field.name);
+        if (field.kind == stack::FieldKind::kChar && field.count > 1) {
+            writer.value(stack::loadText(field, host.data()));
+        } else if (field.count == 1) {
+            writeFieldScalar(writer, field, stack::loadElement(field, host.data(), 0));
+        } else {
+            writer.beginArray();
+            for (uint32_t i = 0; i < field.count; ++i) {
+                writeFieldScalar(writer, field, stack::loadElement(field, host.data(), i));
+            }
+            writer.endArray();
+        }
+    }
+    writer.endObject();
+}
+
+// Strict cursor over a JSON document, for request bodies that carry nested
+// values the flat field helpers cannot extract.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : text_(text) {}
+
+    bool consume(char ch) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ch) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char ch) {
+        skipSpace();
+        return pos_ < text_.size() && text_[pos_] == ch;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return pos_ == text_.size();
+    }
+
+    std::optional<std::string> string() {
+        if (!consume('"')) {
+            return std::nullopt;
+        }
+        std::string out;
+        while (pos_ < text_.size()) {
+            const char ch = text_[pos_++];
+            if (ch == '"') {
+                return out;
+            }
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                return std::nullopt;
+            }
+            if (ch != '\\') {
+                out.push_back(ch);
+                continue;
+            }
+            if (pos_ == text_.size()) {
+                return std::nullopt;
+            }
+            switch (text_[pos_++]) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    auto code = codeUnit();
+                    if (!code) {
+                        return std::nullopt;
+                    }
+                    uint32_t point = *code;
+                    if (point >= 0xD800 && point <= 0xDBFF) {
+                        if (text_.compare(pos_, 2, "\\u") != 0) {
+                            return std::nullopt;
+                        }
+                        pos_ += 2;
+                        auto low = codeUnit();
+                        if (!low || *low < 0xDC00 || *low > 0xDFFF) {
+                            return std::nullopt;
+                        }
+                        point = 0x10000 + ((point - 0xD800) << 10) + (*low - 0xDC00);
+                    }
+                    appendUtf8(out, point);
+                    break;
+                }
+                default:
+                    return std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Integers become int64/uint64 (negative/non-negative) and numbers with a
+    // fraction or exponent doubles; true and false read as 1 and 0.
+    std::optional<stack::FieldScalar> scalar() {
+        skipSpace();
+        if (literal("true")) {
+            return stack::FieldScalar {uint64_t {1}};
+        }
+        if (literal("false")) {
+            return stack::FieldScalar {uint64_t {0}};
+        }
+        const size_t begin = pos_;
+        bool integral = true;
+        while (pos_ < text_.size()) {
+            const char ch = text_[pos_];
+            if (ch == '.' || ch == 'e' || ch == 'E') {
+                integral = false;
+            } else if (!std::isdigit(static_cast<unsigned char>(ch)) && ch != '-' && ch != '+') {
+                break;
+            }
+            ++pos_;
+        }
+        const char *first = text_.data() + begin;
+        const char *last = text_.data() + pos_;
+        if (first == last || *first == '+') {
+            return std::nullopt;
+        }
+        std::from_chars_result result {};
+        stack::FieldScalar value;
+        if (!integral) {
+            double number = 0.0;
+            result = std::from_chars(first, last, number);
+            value = number;
+        } else if (*first == '-') {
+            int64_t number = 0;
+            result = std::from_chars(first, last, number);
+            value = number;
+        } else {
+            uint64_t number = 0;
+            result = std::from_chars(first, last, number);
+            value = number;
+        }
+        if (result.ec != std::errc() || result.ptr != last) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool skipValue(int depth = 0) {
+        if (depth > 64) {
+            return false;
+        }
+        if (peek('"')) {
+            return string().has_value();
+        }
+        const bool is_object = peek('{');
+        if (is_object || peek('[')) {
+            ++pos_;
+            const char close = is_object ? '}' : ']';
+            if (consume(close)) {
+                return true;
+            }
+            do {
+                if (is_object && (!string() || !consume(':'))) {
+                    return false;
+                }
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(close);
+        }
+        return literal("null") || scalar().has_value();
+    }
+
+private:
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool literal(std::string_view word) {
+        skipSpace();
+        if (text_.compare(pos_, word.size(), word) != 0) {
+            return false;
+        }
+        pos_ += word.size();
+        return true;
+    }
+
+    std::optional<uint32_t> codeUnit() {
+        uint32_t value = 0;
+        if (pos_ + 4 > text_.size()) {
+            return std::nullopt;
+        }
+        auto result = std::from_chars(text_.data() + pos_, text_.data() + pos_ + 4, value, 16);
+        if (result.ec != std::errc() || result.ptr != text_.data() + pos_ + 4) {
+            return std::nullopt;
+        }
+        pos_ += 4;
+        return value;
+    }
+
+    static void appendUtf8(std::string &out, uint32_t point) {
+        if (point < 0x80) {
+            out.push_back(static_cast<char>(point));
+        } else if (point < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (point >> 6)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+        } else if (point < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (point >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (point >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+        }
+    }
+
+    std::string_view text_;
+    size_t pos_ {0};
+};
+
+std::optional<std::vector<stack::PdFieldUpdate>> readFieldUpdates(JsonReader &reader) {
+    std::vector<stack::PdFieldUpdate> updates;
+    if (!reader.consume('{')) {
+        return std::nullopt;
+    }
+    if (reader.consume('}')) {
+        return updates;
+    }
+    do {
+        stack::PdFieldUpdate update;
+        auto name = reader.string();
+        if (!name || !reader.consume(':')) {
+            return std::nullopt;
+        }
+        update.name = std::move(*name);
+        if (reader.peek('"')) {
+            update.text = reader.string();
+            if (!update.text) {
+                return std::nullopt;
+            }
+        } else if (reader.consume('[')) {
+            if (!reader.consume(']')) {
+                do {
+                    auto value = reader.scalar();
+                    if (!value) {
+                        return std::nullopt;
+                    }
+                    update.values.push_back(*value);
+                } while (reader.consume(','));
+                if (!reader.consume(']')) {
+                    return std::nullopt;
+                }
+            }
+        } else {
+            auto value = reader.scalar();
+            if (!value) {
+                return std::nullopt;
+            }
+            update.values.push_back(*value);
+        }
+        updates.push_back(std::move(update));
+    } while (reader.consume(','));
+    if (!reader.consume('}')) {
+        return std::nullopt;
+    }
+    return updates;
+}
+
+std::optional<double> readNumber(JsonReader &reader) {
+    auto value = reader.scalar();
+    if (!value) {
+        return std::nullopt;
+    }
+    if (const auto *number = std::get_if<int64_t>(&*value)) {
+        return static_cast<double>(*number);
+    }
+    if (const auto *number = std::get_if<uint64_t>(&*value)) {
+        return static_cast<double>(*number);
+    }
+    return std::get<double>(*value);
+}
+
+std::optional<stack::GeneratorSpec> readGeneratorSpec(JsonReader &reader) {
+    stack::GeneratorSpec spec;
+    bool has_field = false;
+    bool has_kind = false;
+    if (!reader.consume('{')) {
+        return std::nullopt;
+    }
+    if (!reader.consume('}')) {
+        do {
+            auto key = reader.string();
+            if (!key || !reader.consume(':')) {
+                return std::nullopt;
+            }
+            if (*key == "field") {
+                auto field = reader.string();
+                if (!field) {
+                    return std::nullopt;
+                }
+                spec.field = std::move(*field);
+                has_field = true;
+            } else if (*key == "type") {
+                auto type = reader.string();
+                auto kind = type ? stack::parseGeneratorKind(*type) : std::nullopt;
+                if (!kind) {
+                    return std::nullopt;
+                }
+                spec.kind = *kind;
+                has_kind = true;
+            } else if (*key == "expression") {
+                auto expression = reader.string();
+                if (!expression) {
+                    return std::nullopt;
+                }
+                spec.expression = std::move(*expression);
+            } else if (*key == "values") {
+                if (!reader.consume('[')) {
+                    return std::nullopt;
+                }
+                if (!reader.consume(']')) {
+                    do {
+                        auto number = readNumber(reader);
+                        if (!number) {
+                            return std::nullopt;
+                        }
+                        spec.values.push_back(*number);
+                    } while (reader.consume(','));
+                    if (!reader.consume(']')) {
+                        return std::nullopt;
+                    }
+                }
+            } else if (*key == "start" || *key == "step" || *key == "min" || *key == "max" || *key == "period") {
+                auto number = readNumber(reader);
+                if (!number) {
+                    return std::nullopt;
+                }
+                if (*key == "period") {
+                    if (*number < 1.0 || *number > 4294967295.0 || std::trunc(*number) != *number) {
+                        return std::nullopt;
+                    }
+                    spec.period = static_cast<uint32_t>(*number);
+                } else {
+                    double &target = *key == "start" ? spec.start :
+                                     *key == "step"  ? spec.step :
+                                     *key == "min"   ? spec.min :
+                                                       spec.max;
+                    target = *number;
+                }
+            } else if (!reader.skipValue()) {
+                return std::nullopt;
+            }
+        } while (reader.consume(','));
+        if (!reader.consume('}')) {
+            return std::nullopt;
+        }
+    }
+    if (!has_field || !has_kind) {
+        return std::nullopt;
+    }
+    return spec;
+}
+
+// Summary of a latency histogram in nanoseconds: count, mean, extremes and
+// the usual percentiles.
+void writeLatency(JsonWriter &writer, const util::LatencySnapshot &latency) {
+    writer.beginObject();
+    writer.key("count").value(latency.count);
+    writer.key("mean_ns").value(static_cast<int64_t>(std::llround(latency.meanNs())));
+    writer.key("min_ns").value(latency.min_ns);
+    writer.key("p50_ns").value(latency.percentileNs(0.50));
+    writer.key("p90_ns").value(latency.percentileNs(0.90));
+    writer.key("p99_ns").value(latency.percentileNs(0.99));
+    writer.key("p999_ns").value(latency.percentileNs(0.999));
+    writer.key("max_ns").value(latency.max_ns);
+    writer.endObject();
+}
+
+void writeUser(JsonWriter &writer, const auth::User &user) {
+    writer.beginObject();
+    writer.key("id").value(user.id);
+    writer.key("username").value(user.username);
+    writer.key("role").value(user.role);
+    writer.key("created_at").value(user.created_at);
+    writer.endObject();
+}
+
+// Rough per-entry size used to reserve the output buffer up front.
+size_t estimateSize(size_t entries, size_t payload_bytes) {
+    return 2 + entries * 160 + payload_bytes * 2;
+}
+
 }  // namespace
 
 std::string escape(const std::string &value) {
     std::string escaped;
     escaped.reserve(value.size());
-    for (char ch : value) {
-        switch (ch) {
-            case '"':
-                escaped += "\\\"";
-                break;
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                escaped += ch;
-                break;
-        }
-    }
+    appendEscaped(escaped, value);
     return escaped;
 }
 
 std::string error(const std::string &message) {
-    return std::string{"{\"error\":\""} + escape(message) + "\"}";
+    JsonWriter writer;
+    writer.beginObject().key("error").value(message).endObject();
+    return writer.take();
 }
 
 std::optional<std::string> stringField(const std::string &body, const std::string &field_name) {
@@ -148,31 +577,90 @@ std::optional<std::vector<std::string>> stringArrayField(const std::string &body
     return values;
 }
 
-std::optional<std::vector<uint8_t>> parseHex(const std::string &hex) {
-    if (hex.size() % 2 != 0) {
+std::optional<std::vector<stack::PdFieldUpdate>> pdFieldUpdates(const std::string &body) {
+    JsonReader reader(body);
+    std::optional<std::vector<stack::PdFieldUpdate>> updates;
+    if (!reader.consume('{')) {
         return std::nullopt;
     }
-    std::vector<uint8_t> bytes;
-    bytes.reserve(hex.size() / 2);
-    auto hexValue = [](char ch) -> int {
-        if (ch >= '0' && ch <= '9') {
-            return ch - '0';
-        }
-        if (ch >= 'a' && ch <= 'f') {
-            return 10 + (ch - 'a');
-        }
-        if (ch >= 'A' && ch <= 'F') {
-            return 10 + (ch - 'A');
+    if (!reader.consume('}')) {
+        do {
+            auto key = reader.string();
+            if (!key || !reader.consume(':')) {
+                return std::nullopt;
+            }
+            if (*key == "fields") {
+                updates = readFieldUpdates(reader);
+                if (!updates) {
+                    return std::nullopt;
+                }
+            } else if (!reader.skipValue()) {
+                return std::nullopt;
+            }
+        } while (reader.consume(','));
+        if (!reader.consume('}')) {
+            return std::nullopt;
         }
-        return -1;
-    };
-    for (size_t i = 0; i < hex.size(); i += 2) {
-        int hi = hexValue(hex[i]);
-        int lo = hexValue(hex[i + 1]);
-        if (hi < 0 || lo < 0) {
+    }
+    if (!reader.atEnd()) {
+        return std::nullopt;
+    }
+    return updates;
+}
+
+std::optional<std::vector<stack::GeneratorSpec>> pdGeneratorSpecs(const std::string &body) {
+    JsonReader reader(body);
+    std::optional<std::vector<stack::GeneratorSpec>> specs;
+    if (!reader.consume('{')) {
+        return std::nullopt;
+    }
+    if (!reader.consume('}')) {
+        do {
+            auto key = reader.string();
+            if (!key || !reader.consume(':')) {
+                return std::nullopt;
+            }
+            if (*key != "generators") {
+                if (!reader.skipValue()) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+            if (!reader.consume('[')) {
+                return std::nullopt;
+            }
+            specs.emplace();
+            if (reader.consume(']')) {
+                continue;
+            }
+            do {
+                auto spec = readGeneratorSpec(reader);
+                if (!spec) {
+                    return std::nullopt;
+                }
+                specs->push_back(std::move(*spec));
+            } while (reader.consume(','));
+            if (!reader.consume(']')) {
+                return std::nullopt;
+            }
+        } while (reader.consume(','));
+        if (!reader.consume('}')) {
             return std::nullopt;
         }
-        bytes.push_back(static_cast<uint8_t>((hi << 4) | lo));
+    }
+    if (!reader.atEnd()) {
+        return std::nullopt;
+    }
+    return specs;
+}
+
+std::optional<std::vector<uint8_t>> parseHex(const std::string &hex) {
+    if (hex.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    std::vector<uint8_t> bytes(hex.size() / 2);
+    if (!util::hexDecode(hex.data(), bytes.size(), bytes.data())) {
+        return std::nullopt;
     }
     return bytes;
 }
@@ -211,114 +699,285 @@ std::string endpointIp(const std::string &endpoint) {
     return cleaned.substr(0, pos);
 }
 
-std::string pdListJson(const std::vector<stack::PdMessage> &messages, bool include_cycle_time) {
-    std::string payload = "[";
-    for (size_t i = 0; i < messages.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
-        }
-        payload += "{\"id\":" + std::to_string(messages[i].id) + ",";
-        payload += "\"name\":\"" + escape(messages[i].name) + "\",";
-        if (include_cycle_time) {
-            payload += "\"cycle_time_ms\":" + std::to_string(messages[i].cycle_time_ms) + ",";
-        }
-        payload += "\"payload_hex\":\"" + bytesToHex(messages[i].payload) + "\",";
-        payload += "\"last_update_utc\":\"" + escape(messages[i].timestamp) + "\"}";
+std::string pdListJson(const std::vector<std::shared_ptr<const stack::PdMessage>> &messages, bool include_cycle_time) {
+    size_t payload_bytes = 0;
+    for (const auto &message : messages) {
+        payload_bytes += message->payload.size();
     }
-    payload += "]";
-    return payload;
+    JsonWriter writer(estimateSize(messages.size(), payload_bytes));
+    writePdList(writer, messages, include_cycle_time);
+    return writer.take();
+}
+
+std::string pdDeltaJson(const stack::PdDelta &delta, bool include_cycle_time) {
+    size_t payload_bytes = 0;
+    for (const auto &message : delta.messages) {
+        payload_bytes += message->payload.size();
+    }
+    JsonWriter writer(estimateSize(delta.messages.size(), payload_bytes) + 48);
+    writer.beginObject();
+    writer.key("version").value(delta.version);
+    writer.key("reset").value(delta.reset);
+    writer.key("telegrams");
+    writePdList(writer, delta.messages, include_cycle_time);
+    writer.endObject();
+    return writer.take();
 }
 
 std::string pdDetailJson(const stack::PdMessage &message) {
-    std::string payload = "{";
-    payload += "\"id\":" + std::to_string(message.id) + ",";
-    payload += "\"name\":\"" + escape(message.name) + "\",";
-    payload += "\"cycle_time_ms\":" + std::to_string(message.cycle_time_ms) + ",";
-    payload += "\"payload_hex\":\"" + bytesToHex(message.payload) + "\",";
-    payload += "\"payload_ascii\":\"" + escape(payloadAscii(message.payload)) + "\",";
-    payload += "\"last_update_utc\":\"" + escape(message.timestamp) + "\"}";
-    return payload;
+    JsonWriter writer(estimateSize(1, message.payload.size()) + message.payload.size());
+    writer.beginObject();
+    writer.key("id").value(message.id);
+    writer.key("name").value(message.name);
+    writer.key("cycle_time_ms").value(message.cycle_time_ms);
+    writer.key("payload_hex").hexValue(message.payload);
+    writer.key("payload_ascii").value(payloadAscii(message.payload));
+    writer.key("last_update_utc").value(message.timestamp);
+    if (message.dataset) {
+        writeDataset(writer, *message.dataset, message.payload);
+    }
+    writer.endObject();
+    return writer.take();
 }
 
-std::string mdIncomingListJson(const std::vector<stack::MdMessage> &messages) {
-    std::string payload = "[";
-    for (size_t i = 0; i < messages.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
+std::string pdFieldsJson(const stack::PdMessage &message) {
+    JsonWriter writer(estimateSize(1, message.payload.size()));
+    writer.beginObject();
+    writer.key("id").value(message.id);
+    writer.key("version").value(message.version);
+    writer.key("last_update_utc").value(message.timestamp);
+    if (message.dataset) {
+        writeDataset(writer, *message.dataset, message.payload);
+    }
+    writer.endObject();
+    return writer.take();
+}
+
+std::string pdGeneratorsJson(int msg_id, const std::vector<stack::GeneratorSpec> &specs) {
+    JsonWriter writer(64 + specs.size() * 128);
+    writer.beginObject();
+    writer.key("id").value(msg_id);
+    writer.key("generators").beginArray();
+    for (const auto &spec : specs) {
+        writer.beginObject();
+        writer.key("field").value(spec.field);
+        writer.key("type").value(stack::generatorKindName(spec.kind));
+        switch (spec.kind) {
+            case stack::GeneratorKind::kCounter:
+                writer.key("start").value(spec.start);
+                writer.key("step").value(spec.step);
+                if (spec.max > spec.min) {
+                    writer.key("min").value(spec.min);
+                    writer.key("max").value(spec.max);
+                }
+                break;
+            case stack::GeneratorKind::kSawtooth:
+            case stack::GeneratorKind::kSine:
+                writer.key("min").value(spec.min);
+                writer.key("max").value(spec.max);
+                writer.key("period").value(spec.period);
+                break;
+            case stack::GeneratorKind::kRandom:
+                writer.key("min").value(spec.min);
+                writer.key("max").value(spec.max);
+                break;
+            case stack::GeneratorKind::kSequence:
+                writer.key("values").beginArray();
+                for (double value : spec.values) {
+                    writer.value(value);
+                }
+                writer.endArray();
+                break;
+            case stack::GeneratorKind::kExpression:
+                writer.key("expression").value(spec.expression);
+                break;
         }
-        payload += "{\"id\":" + std::to_string(messages[i].id) + ",";
-        payload += "\"source_ip\":\"" + escape(endpointIp(messages[i].source)) + "\",";
-        payload += "\"msg_id\":" + std::to_string(messages[i].msg_id) + ",";
-        payload += "\"payload_hex\":\"" + bytesToHex(messages[i].payload) + "\",";
-        payload += "\"timestamp_utc\":\"" + escape(messages[i].timestamp) + "\"}";
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return writer.take();
+}
+
+std::string mdIncomingListJson(const std::vector<stack::MdMessage> &messages) {
+    size_t payload_bytes = 0;
+    for (const auto &message : messages) {
+        payload_bytes += message.payload.size();
     }
-    payload += "]";
-    return payload;
+    JsonWriter writer(estimateSize(messages.size(), payload_bytes));
+    writer.beginArray();
+    for (const auto &message : messages) {
+        writer.beginObject();
+        writer.key("id").value(message.id);
+        writer.key("source_ip").value(endpointIp(message.source));
+        writer.key("msg_id").value(message.msg_id);
+        writer.key("payload_hex").hexValue(message.payload);
+        writer.key("timestamp_utc").value(message.timestamp);
+        writer.endObject();
+    }
+    writer.endArray();
+    return writer.take();
 }
 
 std::string mdSendResponseJson(const stack::MdMessage &message) {
-    std::string payload = "{";
-    payload += "\"request_id\":" + std::to_string(message.id) + ",";
-    payload += "\"msg_id\":" + std::to_string(message.msg_id) + ",";
-    payload += "\"destination_ip\":\"" + escape(endpointIp(message.destination)) + "\",";
-    payload += "\"payload_hex\":\"" + bytesToHex(message.payload) + "\",";
-    payload += "\"timestamp_utc\":\"" + escape(message.timestamp) + "\",";
-    payload += "\"status\":\"sent\"}";
-    return payload;
+    JsonWriter writer(estimateSize(1, message.payload.size()));
+    writer.beginObject();
+    writer.key("request_id").value(message.id);
+    writer.key("msg_id").value(message.msg_id);
+    writer.key("destination_ip").value(endpointIp(message.destination));
+    writer.key("payload_hex").hexValue(message.payload);
+    writer.key("timestamp_utc").value(message.timestamp);
+    writer.key("status").value("sent");
+    writer.endObject();
+    return writer.take();
 }
 
 std::string trdpLogListJson(const std::vector<util::TrdpLogEntry> &logs) {
-    std::string payload = "[";
-    for (size_t i = 0; i < logs.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
-        }
-        payload += "{\"id\":" + std::to_string(logs[i].id) + ",";
-        payload += "\"direction\":\"" + escape(logs[i].direction) + "\",";
-        payload += "\"type\":\"" + escape(logs[i].type) + "\",";
-        payload += "\"msg_id\":" + std::to_string(logs[i].msg_id) + ",";
-        payload += "\"src_ip\":\"" + escape(logs[i].src_ip) + "\",";
-        payload += "\"dst_ip\":\"" + escape(logs[i].dst_ip) + "\",";
-        payload += "\"payload_hex\":\"" + blobToHex(logs[i].payload.data(), logs[i].payload.size()) + "\",";
-        payload += "\"timestamp_utc\":\"" + escape(logs[i].timestamp) + "\"}";
+    size_t payload_bytes = 0;
+    for (const auto &log : logs) {
+        payload_bytes += log.payload.size();
+    }
+    JsonWriter writer(estimateSize(logs.size(), payload_bytes));
+    writer.beginArray();
+    for (const auto &log : logs) {
+        writer.beginObject();
+        writer.key("id").value(log.id);
+        writer.key("direction").value(log.direction);
+        writer.key("type").value(log.type);
+        writer.key("msg_id").value(log.msg_id);
+        writer.key("src_ip").value(log.src_ip);
+        writer.key("dst_ip").value(log.dst_ip);
+        writer.key("payload_hex").hexValue(log.payload.data(), log.payload.size());
+        writer.key("timestamp_utc").value(log.timestamp);
+        writer.key("last_timestamp_utc").value(log.last_timestamp);
+        writer.key("repeat_count").value(log.repeat_count);
+        writer.endObject();
     }
-    payload += "]";
-    return payload;
+    writer.endArray();
+    return writer.take();
 }
 
 std::string appLogListJson(const std::vector<util::AppLogEntry> &logs) {
-    std::string payload = "[";
-    for (size_t i = 0; i < logs.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
-        }
-        payload += "{\"id\":" + std::to_string(logs[i].id) + ",";
-        payload += "\"level\":\"" + escape(logs[i].level) + "\",";
-        payload += "\"message\":\"" + escape(logs[i].message) + "\",";
-        payload += "\"timestamp_utc\":\"" + escape(logs[i].timestamp) + "\"}";
+    JsonWriter writer(estimateSize(logs.size(), 0));
+    writer.beginArray();
+    for (const auto &log : logs) {
+        writer.beginObject();
+        writer.key("id").value(log.id);
+        writer.key("level").value(log.level);
+        writer.key("message").value(log.message);
+        writer.key("timestamp_utc").value(log.timestamp);
+        writer.endObject();
     }
-    payload += "]";
-    return payload;
+    writer.endArray();
+    return writer.take();
 }
 
 std::string userJson(const auth::User &user) {
-    return std::string{"{"} + "\"id\":" + std::to_string(user.id) + "," +
-           "\"username\":\"" + escape(user.username) + "\"," +
-           "\"role\":\"" + escape(user.role) + "\"," +
-           "\"created_at\":\"" + escape(user.created_at) + "\"}";
+    JsonWriter writer(128);
+    writeUser(writer, user);
+    return writer.take();
 }
 
 std::string userListJson(const std::vector<auth::User> &users) {
-    std::string payload = "[";
-    for (size_t i = 0; i < users.size(); ++i) {
-        if (i != 0) {
-            payload += ",";
+    JsonWriter writer(estimateSize(users.size(), 0));
+    writer.beginArray();
+    for (const auto &user : users) {
+        writeUser(writer, user);
+    }
+    writer.endArray();
+    return writer.take();
+}
+
+std::string receiveLatencyJson(std::string_view clock, const util::LatencySnapshot &latency) {
+    JsonWriter writer(256);
+    writer.beginObject();
+    writer.key("clock").value(clock);
+    writer.key("latency");
+    writeLatency(writer, latency);
+    writer.endObject();
+    return writer.take();
+}
+
+std::string pdTimingListJson(const std::vector<stack::PdTimingStats> &telegrams) {
+    JsonWriter writer(64 + telegrams.size() * 512);
+    writer.beginObject();
+    writer.key("telegrams").beginArray();
+    for (const auto &telegram : telegrams) {
+        writer.beginObject();
+        writer.key("id").value(telegram.id);
+        writer.key("name").value(telegram.name);
+        writer.key("direction").value(telegram.is_outgoing ? "outgoing" : "incoming");
+        writer.key("cycle_time_ms").value(telegram.cycle_time_ms);
+        if (telegram.is_outgoing) {
+            writer.key("interval_deviation");
+            writeLatency(writer, telegram.interval_deviation);
+        } else {
+            writer.key("inter_arrival");
+            writeLatency(writer, telegram.inter_arrival);
+            writer.key("update_latency");
+            writeLatency(writer, telegram.update_latency);
         }
-        payload += userJson(users[i]);
+        writer.endObject();
     }
-    payload += "]";
-    return payload;
+    writer.endArray();
+    writer.endObject();
+    return writer.take();
 }
 
-}  // namespace trdp::http::json
+std::string rollupListJson(int resolution_s, const std::vector<util::RollupEntry> &rollups) {
+    JsonWriter writer(64 + rollups.size() * 384);
+    writer.beginObject();
+    writer.key("resolution_s").value(resolution_s);
+    writer.key("buckets").beginArray();
+    for (const auto &rollup : rollups) {
+        writer.beginObject();
+        writer.key("bucket_start").value(rollup.bucket_start);
+        writer.key("direction").value(rollup.direction);
+        writer.key("msg_id").value(rollup.msg_id);
+        writer.key("src_ip").value(rollup.src_ip);
+        writer.key("dst_ip").value(rollup.dst_ip);
+        writer.key("packets").value(rollup.packets);
+        writer.key("bytes").value(rollup.bytes);
+        writer.key("min_inter_arrival_ns");
+        if (rollup.min_gap_ns) {
+            writer.value(*rollup.min_gap_ns);
+        } else {
+            writer.nullValue();
+        }
+        writer.key("max_inter_arrival_ns");
+        if (rollup.max_gap_ns) {
+            writer.value(*rollup.max_gap_ns);
+        } else {
+            writer.nullValue();
+        }
+        writer.key("payload_changes").value(rollup.changes);
+        writer.key("last_payload_hex").hexValue(rollup.last_payload);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return writer.take();
+}
 
+std::string logPartitionListJson(const util::TrdpLogStorageOptions &storage,
+                                 const std::vector<util::LogPartition> &partitions) {
+    JsonWriter writer(96 + partitions.size() * 128);
+    writer.beginObject();
+    writer.key("span").value(storage.span == util::LogPartitionSpan::kHour ? "hour" : "day");
+    writer.key("max_age_hours").value(static_cast<int64_t>(storage.max_age.count()));
+    writer.key("max_bytes").value(storage.max_bytes);
+    writer.key("partitions").beginArray();
+    for (const auto &partition : partitions) {
+        writer.beginObject();
+        writer.key("file").value(partition.path.filename().string());
+        writer.key("start").value(partition.start);
+        writer.key("end").value(partition.end);
+        writer.key("bytes").value(partition.bytes);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return writer.take();
+}
+
+}  // namespace trdp::http::json
@@ -0,0 +1,176 @@
+#include "http/JsonWriter.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+
+#include "util/Hex.hpp"
+
+namespace trdp::http::json {
+
+namespace {
+
+// 0 leaves the byte as is, 'u' selects a \u00XX escape, anything else is the
+// character that follows the backslash.
+constexpr std::array<char, 256> makeEscapeTable() {
+    std::array<char, 256> table {};
+    for (int ch = 0; ch < 0x20; ++ch) {
+        table[ch] = 'u';
+    }
+    table['"'] = '"';
+    table['\\'] = '\\';
+    table['\b'] = 'b';
+    table['\f'] = 'f';
+    table['\n'] = 'n';
+    table['\r'] = 'r';
+    table['\t'] = 't';
+    return table;
+}
+
+constexpr std::array<char, 256> kEscapeTable = makeEscapeTable();
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+}  // namespace
+
+void appendHex(std::string &out, const uint8_t *data, size_t size) {
+    if (data == nullptr || size == 0) {
+        return;
+    }
+    const size_t offset = out.size();
+    out.resize(offset + size * 2);
+    util::hexEncode(data, size, out.data() + offset);
+}
+
+void appendEscaped(std::string &out, std::string_view value) {
+    size_t run_start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char escape = kEscapeTable[static_cast<unsigned char>(value[i])];
+        if (escape == 0) {
+            continue;
+        }
+        out.append(value.data() + run_start, i - run_start);
+        out.push_back('\\');
+        if (escape == 'u') {
+            const auto byte = static_cast<unsigned char>(value[i]);
+            out.append("u00");
+            out.push_back(kHexDigits[byte >> 4]);
+            out.push_back(kHexDigits[byte & 0x0F]);
+        } else {
+            out.push_back(escape);
+        }
+        run_start = i + 1;
+    }
+    out.append(value.data() + run_start, value.size() - run_start);
+}
+
+JsonWriter &JsonWriter::beginObject() {
+    open('{');
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+    close('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+    open('[');
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+    close(']');
+    return *this;
+}
+
+JsonWriter &JsonWriter::key(std::string_view name) {
+    separate();
+    buffer_.push_back('"');
+    appendEscaped(buffer_, name);
+    buffer_.append("\":");
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view text) {
+    separate();
+    buffer_.push_back('"');
+    appendEscaped(buffer_, text);
+    buffer_.push_back('"');
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(bool flag) {
+    separate();
+    buffer_.append(flag ? "true" : "false");
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        return nullValue();
+    }
+    separate();
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer_.append(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+JsonWriter &JsonWriter::nullValue() {
+    separate();
+    buffer_.append("null");
+    return *this;
+}
+
+JsonWriter &JsonWriter::hexValue(const uint8_t *data, size_t size) {
+    separate();
+    buffer_.push_back('"');
+    appendHex(buffer_, data, size);
+    buffer_.push_back('"');
+    return *this;
+}
+
+JsonWriter &JsonWriter::rawValue(std::string_view json) {
+    separate();
+    buffer_.append(json);
+    return *this;
+}
+
+void JsonWriter::clear() {
+    buffer_.clear();
+    has_members_ = 0;
+    depth_ = 0;
+    after_key_ = false;
+}
+
+void JsonWriter::separate() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (depth_ == 0) {
+        return;
+    }
+    const uint64_t bit = uint64_t {1} << ((depth_ - 1) & 63);
+    if ((has_members_ & bit) != 0) {
+        buffer_.push_back(',');
+    }
+    has_members_ |= bit;
+}
+
+void JsonWriter::open(char bracket) {
+    separate();
+    buffer_.push_back(bracket);
+    ++depth_;
+    has_members_ &= ~(uint64_t {1} << ((depth_ - 1) & 63));
+}
+
+void JsonWriter::close(char bracket) {
+    buffer_.push_back(bracket);
+    if (depth_ > 0) {
+        --depth_;
+    }
+}
+
+}  // namespace trdp::http::json
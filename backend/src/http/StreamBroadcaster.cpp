@@ -0,0 +1,235 @@
+#include "http/StreamBroadcaster.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "http/JsonUtils.hpp"
+
+namespace trdp::http {
+
+namespace {
+
+void appendSseEvent(std::string &frame, const char *event, const std::string &data) {
+    frame += "event: ";
+    frame += event;
+    frame += "\ndata: ";
+    frame += data;
+    frame += "\n\n";
+}
+
+// Events for the given changes; empty when there are none. The PD events
+// are sent whenever `reset` is set, even with an empty list.
+std::string buildFrame(const stack::PdDelta &outgoing, const stack::PdDelta &incoming,
+                       const std::vector<stack::MdMessage> &md) {
+    std::string frame;
+    if (outgoing.reset || !outgoing.messages.empty()) {
+        appendSseEvent(frame, "pd-outgoing", json::pdDeltaJson(outgoing, true));
+    }
+    if (incoming.reset || !incoming.messages.empty()) {
+        appendSseEvent(frame, "pd-incoming", json::pdDeltaJson(incoming, false));
+    }
+    if (!md.empty()) {
+        appendSseEvent(frame, "md-incoming", json::mdIncomingListJson(md));
+    }
+    return frame;
+}
+
+}  // namespace
+
+StreamBroadcaster::StreamBroadcaster(stack::TrdpEngine &engine, size_t max_subscribers)
+    : engine_(engine), max_subscribers_(max_subscribers) {
+    thread_ = std::thread(&StreamBroadcaster::run, this);
+}
+
+StreamBroadcaster::~StreamBroadcaster() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    frame_ready_.notify_all();
+    thread_.join();
+}
+
+std::unique_ptr<StreamBroadcaster::Subscription> StreamBroadcaster::subscribe(std::chrono::milliseconds interval) {
+    Subscriber subscriber;
+    subscriber.interval_ticks = static_cast<uint64_t>(
+        std::clamp<int64_t>((interval.count() + kTick.count() - 1) / kTick.count(), 1,
+                            static_cast<int64_t>(kHistoryTicks)));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_.size() >= max_subscribers_) {
+        return nullptr;
+    }
+    const auto it = subscribers_.insert(subscribers_.end(), std::move(subscriber));
+    wake_.notify_all();
+    return std::unique_ptr<Subscription>(new Subscription(*this, it));
+}
+
+size_t StreamBroadcaster::subscribers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.size();
+}
+
+uint64_t StreamBroadcaster::framesBuilt() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_built_;
+}
+
+void StreamBroadcaster::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto deadline = std::chrono::steady_clock::now();
+    while (!stopping_) {
+        if (subscribers_.empty()) {
+            // Nothing is kept while idle; the next subscriber starts from
+            // the complete lists anyway.
+            history_.clear();
+            pd_outgoing_version_ = 0;
+            pd_incoming_version_ = 0;
+            md_id_ = 0;
+            wake_.wait(lock, [this] { return stopping_ || !subscribers_.empty(); });
+            deadline = std::chrono::steady_clock::now();
+            continue;
+        }
+        // The first subscriber is served right away, later ticks follow the
+        // cadence; after a stall the cadence restarts instead of catching up.
+        const auto now = std::chrono::steady_clock::now();
+        if (deadline + kTick < now) {
+            deadline = now;
+        }
+        if (wake_.wait_until(lock, deadline, [this] { return stopping_; })) {
+            break;
+        }
+        deadline += kTick;
+        collectLocked(lock);
+        publishLocked();
+        frame_ready_.notify_all();
+    }
+}
+
+void StreamBroadcaster::collectLocked(std::unique_lock<std::mutex> &lock) {
+    // The cursors only change on this thread, so the engine is queried
+    // without holding the lock.
+    const uint64_t outgoing_version = pd_outgoing_version_;
+    const uint64_t incoming_version = pd_incoming_version_;
+    const int md_id = md_id_;
+    lock.unlock();
+    Tick tick;
+    tick.outgoing = engine_.outgoingPdSince(outgoing_version);
+    tick.incoming = engine_.incomingPdSince(incoming_version);
+    tick.md = engine_.listIncomingMd(md_id);
+    lock.lock();
+
+    tick.number = ++tick_;
+    pd_outgoing_version_ = tick.outgoing.version;
+    pd_incoming_version_ = tick.incoming.version;
+    if (!tick.md.empty()) {
+        md_id_ = tick.md.back().id;
+    }
+    history_.push_back(std::move(tick));
+    if (history_.size() > kHistoryTicks) {
+        history_.pop_front();
+    }
+}
+
+void StreamBroadcaster::publishLocked() {
+    // Frames built on this tick, shared by every subscriber that needs the
+    // same one.
+    std::map<int, std::shared_ptr<const std::string>> snapshots;
+    std::map<uint64_t, std::shared_ptr<const std::string>> deltas;
+    const uint64_t oldest = history_.front().number;
+    for (auto &subscriber : subscribers_) {
+        // A subscriber that has not taken its last frame yet is left for a
+        // later tick, whose frame then also covers this one.
+        if (subscriber.pending || (subscriber.last_tick != 0 && tick_ % subscriber.interval_ticks != 0)) {
+            continue;
+        }
+        if (subscriber.last_tick == 0 || subscriber.last_tick + 1 < oldest) {
+            // New, or so far behind that its changes have left the history.
+            auto &frame = snapshots[subscriber.md_id];
+            if (!frame) {
+                frame = snapshotFrame(subscriber.md_id);
+            }
+            subscriber.pending = frame;
+        } else {
+            auto &frame = deltas[subscriber.last_tick];
+            if (!frame) {
+                frame = deltaFrame(subscriber.last_tick);
+            }
+            // Null when nothing changed.
+            subscriber.pending = frame->empty() ? nullptr : frame;
+        }
+        subscriber.last_tick = tick_;
+        subscriber.md_id = md_id_;
+    }
+}
+
+std::shared_ptr<const std::string> StreamBroadcaster::snapshotFrame(int md_id) {
+    auto md = engine_.listIncomingMd(md_id);
+    // Later messages belong to the next tick's frame.
+    md.erase(std::find_if(md.begin(), md.end(),
+                          [this](const stack::MdMessage &message) { return message.id > md_id_; }),
+             md.end());
+    ++frames_built_;
+    return std::make_shared<const std::string>(buildFrame(engine_.outgoingPdSince(0), engine_.incomingPdSince(0), md));
+}
+
+std::shared_ptr<const std::string> StreamBroadcaster::deltaFrame(uint64_t from_tick) {
+    stack::PdDelta outgoing;
+    stack::PdDelta incoming;
+    std::map<int, stack::PdMessagePtr> outgoing_changes;
+    std::map<int, stack::PdMessagePtr> incoming_changes;
+    std::vector<stack::MdMessage> md;
+    // A reset delta holds the complete list, so changes before it are
+    // superseded.
+    auto merge = [](const stack::PdDelta &delta, stack::PdDelta &merged, std::map<int, stack::PdMessagePtr> &changes) {
+        if (delta.reset) {
+            changes.clear();
+            merged.reset = true;
+        }
+        for (const auto &message : delta.messages) {
+            changes[message->id] = message;
+        }
+        merged.version = delta.version;
+    };
+    for (const auto &tick : history_) {
+        if (tick.number <= from_tick) {
+            continue;
+        }
+        merge(tick.outgoing, outgoing, outgoing_changes);
+        merge(tick.incoming, incoming, incoming_changes);
+        md.insert(md.end(), tick.md.begin(), tick.md.end());
+    }
+    for (auto &entry : outgoing_changes) {
+        outgoing.messages.push_back(std::move(entry.second));
+    }
+    for (auto &entry : incoming_changes) {
+        incoming.messages.push_back(std::move(entry.second));
+    }
+    auto frame = std::make_shared<const std::string>(buildFrame(outgoing, incoming, md));
+    if (!frame->empty()) {
+        ++frames_built_;
+    }
+    return frame;
+}
+
+std::shared_ptr<const std::string> StreamBroadcaster::next(Subscriber &subscriber, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    frame_ready_.wait_for(lock, timeout, [&] { return stopping_ || subscriber.pending != nullptr; });
+    return std::exchange(subscriber.pending, nullptr);
+}
+
+void StreamBroadcaster::unsubscribe(std::list<Subscriber>::iterator subscriber) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(subscriber);
+}
+
+StreamBroadcaster::Subscription::~Subscription() {
+    owner_.unsubscribe(subscriber_);
+}
+
+std::shared_ptr<const std::string> StreamBroadcaster::Subscription::next(std::chrono::milliseconds timeout) {
+    return owner_.next(*subscriber_, timeout);
+}
+
+}  // namespace trdp::http
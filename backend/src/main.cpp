@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "auth/AuthManager.hpp"
 #include "auth/AuthService.hpp"
@@ -12,22 +16,110 @@
 #include "trdp/TrdpEngine.hpp"
 #include "util/LogService.hpp"
 
+namespace {
+
+long envLong(const char *name, long fallback) {
+    const char *value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    char *end = nullptr;
+    const long parsed = std::strtol(value, &end, 10);
+    if (end == value || parsed <= 0) {
+        return fallback;
+    }
+    return parsed;
+}
+
+trdp::util::TrdpLogStorageOptions logStorageFromEnvironment() {
+    trdp::util::TrdpLogStorageOptions storage;
+    if (const char *directory = std::getenv("TRDP_LOG_DIR"); directory != nullptr && *directory != '\0') {
+        storage.directory = directory;
+    }
+    if (const char *span = std::getenv("TRDP_LOG_PARTITION"); span != nullptr && std::string{span} == "hour") {
+        storage.span = trdp::util::LogPartitionSpan::kHour;
+    }
+    storage.max_age = std::chrono::hours(envLong("TRDP_LOG_MAX_AGE_H", static_cast<long>(storage.max_age.count())));
+    storage.max_bytes = static_cast<uint64_t>(envLong("TRDP_LOG_MAX_MB", 0)) * 1024 * 1024;
+    return storage;
+}
+
+trdp::stack::TrdpEngineOptions engineOptionsFromEnvironment() {
+    trdp::stack::TrdpEngineOptions options;
+    auto &log_writer = options.log_writer;
+    log_writer.storage = logStorageFromEnvironment();
+    log_writer.queue_capacity =
+        static_cast<size_t>(envLong("TRDP_LOG_QUEUE_CAPACITY", static_cast<long>(log_writer.queue_capacity)));
+    log_writer.batch_size =
+        static_cast<size_t>(envLong("TRDP_LOG_BATCH_SIZE", static_cast<long>(log_writer.batch_size)));
+    log_writer.flush_interval =
+        std::chrono::milliseconds(envLong("TRDP_LOG_FLUSH_MS", static_cast<long>(log_writer.flush_interval.count())));
+    if (const char *policy = std::getenv("TRDP_LOG_OVERFLOW"); policy != nullptr && std::string{policy} == "block") {
+        log_writer.overflow_policy = trdp::util::LogOverflowPolicy::kBlock;
+    }
+    if (const char *dedup = std::getenv("TRDP_LOG_DEDUP"); dedup != nullptr && std::string{dedup} == "off") {
+        log_writer.deduplicate_pd = false;
+    }
+    log_writer.max_run_duration =
+        std::chrono::seconds(envLong("TRDP_LOG_RUN_MAX_S", static_cast<long>(log_writer.max_run_duration.count())));
+    if (const char *raw = std::getenv("TRDP_LOG_PD"); raw != nullptr && std::string{raw} == "off") {
+        options.log_pd_packets = false;
+    }
+    auto &rollup = options.rollup;
+    if (const char *enabled = std::getenv("TRDP_ROLLUPS"); enabled != nullptr && std::string{enabled} == "off") {
+        rollup.enabled = false;
+    }
+    rollup.second_retention = std::chrono::hours(
+        envLong("TRDP_ROLLUP_1S_HOURS", std::chrono::duration_cast<std::chrono::hours>(rollup.second_retention).count()));
+    rollup.minute_retention = std::chrono::hours(
+        24 * envLong("TRDP_ROLLUP_1M_DAYS",
+                     std::chrono::duration_cast<std::chrono::hours>(rollup.minute_retention).count() / 24));
+    rollup.hour_retention = std::chrono::hours(
+        24 * envLong("TRDP_ROLLUP_1H_DAYS",
+                     std::chrono::duration_cast<std::chrono::hours>(rollup.hour_retention).count() / 24));
+    auto &md_history = options.md_history;
+    md_history.max_messages =
+        static_cast<size_t>(envLong("TRDP_MD_HISTORY_MESSAGES", static_cast<long>(md_history.max_messages)));
+    md_history.max_payload_bytes =
+        static_cast<size_t>(envLong("TRDP_MD_HISTORY_BYTES", static_cast<long>(md_history.max_payload_bytes)));
+    if (const char *backend = std::getenv("TRDP_IO_BACKEND"); backend != nullptr && *backend != '\0') {
+        if (const auto parsed = trdp::stack::parseUdpIoBackend(backend)) {
+            options.io_backend = *parsed;
+        } else {
+            std::cerr << "Ignoring unknown TRDP_IO_BACKEND '" << backend << "'" << std::endl;
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
 int main() {
     try {
-        trdp::db::Database database{"trdp_studio.db"};
+        trdp::db::DatabaseOptions database_options;
+        database_options.readers =
+            static_cast<size_t>(envLong("TRDP_DB_READERS", static_cast<long>(database_options.readers)));
+        trdp::db::Database database{"trdp_studio.db", database_options};
+        const auto engine_options = engineOptionsFromEnvironment();
         trdp::auth::AuthService auth_service{database};
         auth_service.ensureDefaultUsers();
         trdp::auth::AuthManager auth_manager{auth_service};
         trdp::network::NetworkConfigService network_config_service{database};
-        trdp::stack::TrdpEngine trdp_engine{&database};
+        trdp::stack::TrdpEngine trdp_engine{&database, engine_options};
         trdp::config::TrdpConfigService trdp_config_service{database};
         trdp::config::ConfigService config_service{auth_manager, trdp_config_service, network_config_service,
                                                   trdp_engine};
-        trdp::util::LogService log_service{database};
+        trdp::util::LogService log_service{database, engine_options.log_writer};
         trdp::http::HttpRouter router{auth_manager, auth_service, config_service, network_config_service,
                                       trdp_engine, log_service};
 
         httplib::Server server;
+        // cpp-httplib's default pool, plus one thread per live update stream
+        // so that open streams never starve the REST API.
+        const size_t workers =
+            std::max(8u, std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() - 1 : 0u) +
+            router.maxStreams();
+        server.new_task_queue = [workers] { return new httplib::ThreadPool(workers); };
         router.registerRoutes(server);
 
         std::cout << "TRDP backend listening on http://0.0.0.0:8080" << std::endl;
@@ -24,14 +24,14 @@ constexpr const char *kUpsertSql =
 NetworkConfigService::NetworkConfigService(db::Database &database) : database_(database) {}
 
 std::optional<NetworkConfig> NetworkConfigService::loadConfig() {
-    sqlite3_stmt *stmt = nullptr;
-    if (sqlite3_prepare_v2(database_.handle(), kSelectSql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(kSelectSql);
+    if (!stmt) {
         throw std::runtime_error("failed to prepare network_config select");
     }
 
     int rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
         return std::nullopt;
     }
 
@@ -52,28 +52,28 @@ std::optional<NetworkConfig> NetworkConfigService::loadConfig() {
         config.multicast_groups = splitGroups(reinterpret_cast<const char *>(groups));
     }
 
-    sqlite3_finalize(stmt);
     return config;
 }
 
 NetworkConfig NetworkConfigService::saveConfig(const NetworkConfig &config) {
-    sqlite3_stmt *stmt = nullptr;
-    if (sqlite3_prepare_v2(database_.handle(), kUpsertSql, -1, &stmt, nullptr) != SQLITE_OK) {
-        throw std::runtime_error("failed to prepare network_config upsert");
-    }
+    {
+        auto connection = database_.writer();
+        auto stmt = connection->prepare(kUpsertSql);
+        if (!stmt) {
+            throw std::runtime_error("failed to prepare network_config upsert");
+        }
 
-    std::string stored_groups = joinGroups(config.multicast_groups);
+        std::string stored_groups = joinGroups(config.multicast_groups);
 
-    sqlite3_bind_text(stmt, 1, config.interface_name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, config.local_ip.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, stored_groups.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 4, config.pd_port);
-    sqlite3_bind_int(stmt, 5, config.md_port);
+        sqlite3_bind_text(stmt, 1, config.interface_name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, config.local_ip.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, stored_groups.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, config.pd_port);
+        sqlite3_bind_int(stmt, 5, config.md_port);
 
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error("failed to persist network config");
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            throw std::runtime_error("failed to persist network config");
+        }
     }
 
     auto stored = loadConfig();
@@ -8,6 +8,8 @@
 #include <vector>
 
 #include "auth/AuthManager.hpp"
+#include "http/JsonUtils.hpp"
+#include "http/JsonWriter.hpp"
 #include "httplib.h"
 #include "network/NetworkConfigService.hpp"
 #include "trdp/PlanBuilder.hpp"
@@ -211,16 +213,8 @@ void ConfigService::handleListConfigs(const httplib::Request &req, httplib::Resp
 
     try {
         auto configs = config_service_.listConfigsForUser(*user_id);
-        std::string payload = "{\"configs\":[";
-        for (size_t i = 0; i < configs.size(); ++i) {
-            if (i != 0) {
-                payload += ",";
-            }
-            payload += serializeConfigMetadata(configs[i]);
-        }
-        payload += "]}";
         res.status = 200;
-        res.set_content(payload, "application/json");
+        res.set_content(serializeConfigList(configs), "application/json");
     } catch (const std::exception &ex) {
         res.status = 500;
         res.set_content(jsonError(ex.what()), "application/json");
@@ -244,9 +238,8 @@ void ConfigService::handleCreateConfig(const httplib::Request &req, httplib::Res
 
     try {
         auto config = config_service_.createConfig(*user_id, *name, *xml);
-        std::string payload = "{\"config\":" + serializeConfigWithXml(config) + "}";
         res.status = 201;
-        res.set_content(payload, "application/json");
+        res.set_content(serializeConfigResponse(config), "application/json");
     } catch (const std::exception &ex) {
         res.status = 500;
         res.set_content(jsonError(ex.what()), "application/json");
@@ -274,7 +267,7 @@ void ConfigService::handleGetConfig(const httplib::Request &req, httplib::Respon
             return;
         }
 
-        std::string payload = "{\"config\":" + serializeConfigWithXml(*config) + "}";
+        std::string payload = serializeConfigResponse(*config);
         res.status = 200;
         res.set_content(payload, "application/json");
     } catch (const std::exception &ex) {
@@ -414,79 +407,63 @@ std::optional<std::string> ConfigService::extractJsonField(const std::string &bo
     return parseJsonStringToken(body, cursor);
 }
 
-std::string ConfigService::escapeJson(const std::string &value) {
-    std::string escaped;
-    escaped.reserve(value.size());
-    for (char ch : value) {
-        switch (ch) {
-            case '"':
-                escaped += "\\\"";
-                break;
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                escaped += ch;
-                break;
-        }
-    }
-    return escaped;
-}
-
 std::string ConfigService::jsonError(const std::string &message) {
-    return std::string{"{\"error\":\""} + escapeJson(message) + "\"}";
+    return http::json::error(message);
 }
 
-std::string ConfigService::serializeConfigMetadata(const TrdpConfig &config) {
-    return "{\"id\":" + std::to_string(config.id) + ",\"name\":\"" + escapeJson(config.name) +
-           "\",\"validation_status\":\"" + escapeJson(config.validation_status) +
-           "\",\"created_at\":\"" + escapeJson(config.created_at) + "\"}";
+std::string ConfigService::serializeConfigList(const std::vector<TrdpConfig> &configs) {
+    http::json::JsonWriter writer(16 + configs.size() * 128);
+    writer.beginObject().key("configs").beginArray();
+    for (const auto &config : configs) {
+        writer.beginObject();
+        writer.key("id").value(config.id);
+        writer.key("name").value(config.name);
+        writer.key("validation_status").value(config.validation_status);
+        writer.key("created_at").value(config.created_at);
+        writer.endObject();
+    }
+    writer.endArray().endObject();
+    return writer.take();
 }
 
-std::string ConfigService::serializeConfigWithXml(const TrdpConfig &config) {
-    return "{\"id\":" + std::to_string(config.id) + ",\"user_id\":" + std::to_string(config.user_id) +
-           ",\"name\":\"" + escapeJson(config.name) +
-           "\",\"xml\":\"" + escapeJson(config.xml_content) +
-           "\",\"validation_status\":\"" + escapeJson(config.validation_status) +
-           "\",\"created_at\":\"" + escapeJson(config.created_at) + "\"}";
+std::string ConfigService::serializeConfigResponse(const TrdpConfig &config) {
+    http::json::JsonWriter writer(config.xml_content.size() + config.xml_content.size() / 8 + 192);
+    writer.beginObject().key("config").beginObject();
+    writer.key("id").value(config.id);
+    writer.key("user_id").value(config.user_id);
+    writer.key("name").value(config.name);
+    writer.key("xml").value(config.xml_content);
+    writer.key("validation_status").value(config.validation_status);
+    writer.key("created_at").value(config.created_at);
+    writer.endObject().endObject();
+    return writer.take();
 }
 
 std::string ConfigService::serializePlanSections(const std::vector<TrdpPlanSection> &sections) {
-    std::string json = "{\"plan\":[";
-    for (std::size_t i = 0; i < sections.size(); ++i) {
-        const auto &section = sections[i];
-        if (i != 0) {
-            json += ",";
-        }
-        json += "{\"name\":\"" + escapeJson(section.name) + "\",\"steps\":[";
-        for (std::size_t j = 0; j < section.steps.size(); ++j) {
-            const auto &step = section.steps[j];
-            if (j != 0) {
-                json += ",";
-            }
-            json += "{\"title\":\"" + escapeJson(step.title) + "\",\"description\":\"" +
-                    escapeJson(step.description) + "\",\"api_calls\":[";
-            for (std::size_t k = 0; k < step.api_calls.size(); ++k) {
-                if (k != 0) {
-                    json += ",";
-                }
-                json += "\"" + escapeJson(step.api_calls[k]) + "\"";
+    http::json::JsonWriter writer(1024);
+    writer.beginObject().key("plan").beginArray();
+    for (const auto &section : sections) {
+        writer.beginObject();
+        writer.key("name").value(section.name);
+        writer.key("steps").beginArray();
+        for (const auto &step : section.steps) {
+            writer.beginObject();
+            writer.key("title").value(step.title);
+            writer.key("description").value(step.description);
+            writer.key("api_calls").beginArray();
+            for (const auto &call : step.api_calls) {
+                writer.value(call);
             }
-            json += "]}";
+            writer.endArray();
+            writer.endObject();
         }
-        json += "]}";
+        writer.endArray();
+        writer.endObject();
     }
-    json += "],\"sections\":" + std::to_string(sections.size()) + "}";
-    return json;
+    writer.endArray();
+    writer.key("sections").value(sections.size());
+    writer.endObject();
+    return writer.take();
 }
 
 }  // namespace trdp::config
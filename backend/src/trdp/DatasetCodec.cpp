@@ -0,0 +1,568 @@
+#include "trdp/DatasetCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cfloat>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "trdp/TrdpXmlParser.hpp"
+#include "trdp/XmlUtils.hpp"
+
+namespace trdp::stack {
+
+namespace {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool kHostBigEndian = true;
+#else
+constexpr bool kHostBigEndian = false;
+#endif
+
+// Upper bound for a compiled dataset; MD payloads top out well below this.
+constexpr size_t kMaxDatasetSize = 1U << 20;
+
+struct TypeInfo {
+    FieldType type;
+    FieldKind kind;
+    uint16_t width;
+    std::string_view name;
+};
+
+constexpr std::array<TypeInfo, 16> kTypes = {{
+    {FieldType::kBool8, FieldKind::kBool, 1, "BOOL8"},
+    {FieldType::kChar8, FieldKind::kChar, 1, "CHAR8"},
+    {FieldType::kUtf16, FieldKind::kUnsigned, 2, "UTF16"},
+    {FieldType::kInt8, FieldKind::kSigned, 1, "INT8"},
+    {FieldType::kInt16, FieldKind::kSigned, 2, "INT16"},
+    {FieldType::kInt32, FieldKind::kSigned, 4, "INT32"},
+    {FieldType::kInt64, FieldKind::kSigned, 8, "INT64"},
+    {FieldType::kUInt8, FieldKind::kUnsigned, 1, "UINT8"},
+    {FieldType::kUInt16, FieldKind::kUnsigned, 2, "UINT16"},
+    {FieldType::kUInt32, FieldKind::kUnsigned, 4, "UINT32"},
+    {FieldType::kUInt64, FieldKind::kUnsigned, 8, "UINT64"},
+    {FieldType::kReal32, FieldKind::kReal, 4, "REAL32"},
+    {FieldType::kReal64, FieldKind::kReal, 8, "REAL64"},
+    {FieldType::kTimeDate32, FieldKind::kUnsigned, 4, "TIMEDATE32"},
+    {FieldType::kTimeDate48, FieldKind::kUnsigned, 6, "TIMEDATE48"},
+    {FieldType::kTimeDate64, FieldKind::kUnsigned, 8, "TIMEDATE64"},
+}};
+
+const TypeInfo &typeInfo(FieldType type) {
+    return kTypes[static_cast<size_t>(type) - 1];
+}
+
+struct TypeAlias {
+    std::string_view alias;
+    FieldType type;
+};
+
+constexpr std::array<TypeAlias, 9> kTypeAliases = {{
+    {"BOOL", FieldType::kBool8},
+    {"BOOLEAN", FieldType::kBool8},
+    {"CHAR", FieldType::kChar8},
+    {"STRING", FieldType::kChar8},
+    {"FLOAT", FieldType::kReal32},
+    {"DOUBLE", FieldType::kReal64},
+    {"TIMEDATE", FieldType::kTimeDate32},
+    {"INT", FieldType::kInt32},
+    {"UINT", FieldType::kUInt32},
+}};
+
+bool equalsUpper(std::string_view text, std::string_view upper) {
+    if (text.size() != upper.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(text[i])) != upper[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t swap16(uint16_t value) {
+    return static_cast<uint16_t>((value >> 8) | (value << 8));
+}
+
+uint32_t swap32(uint32_t value) {
+    return ((value & 0x000000FFU) << 24) | ((value & 0x0000FF00U) << 8) | ((value & 0x00FF0000U) >> 8) |
+           ((value & 0xFF000000U) >> 24);
+}
+
+uint64_t swap64(uint64_t value) {
+    return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(value))) << 32) |
+           swap32(static_cast<uint32_t>(value >> 32));
+}
+
+// Byte-swaps `count` consecutive elements of `width` bytes in place. The
+// fixed-width loops compile to bswap (or vector shuffles) per element.
+void swapElements(uint8_t *data, uint16_t width, size_t count) {
+    switch (width) {
+        case 2:
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t value;
+                std::memcpy(&value, data + i * 2, 2);
+                value = swap16(value);
+                std::memcpy(data + i * 2, &value, 2);
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t value;
+                std::memcpy(&value, data + i * 4, 4);
+                value = swap32(value);
+                std::memcpy(data + i * 4, &value, 4);
+            }
+            break;
+        case 8:
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t value;
+                std::memcpy(&value, data + i * 8, 8);
+                value = swap64(value);
+                std::memcpy(data + i * 8, &value, 8);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i) {
+                std::reverse(data + i * width, data + (i + 1) * width);
+            }
+            break;
+    }
+}
+
+void applySwapRuns(const DatasetLayout &layout, uint8_t *data) {
+    for (const auto &run : layout.swap_runs) {
+        swapElements(data + run.offset, run.width, run.count);
+    }
+}
+
+// Unsigned values of any width, including 6-byte TIMEDATE48, in host order.
+uint64_t loadUnsigned(const uint8_t *data, uint16_t width) {
+    uint64_t value = 0;
+    if constexpr (kHostBigEndian) {
+        std::memcpy(reinterpret_cast<uint8_t *>(&value) + (sizeof(value) - width), data, width);
+    } else {
+        std::memcpy(&value, data, width);
+    }
+    return value;
+}
+
+void storeUnsigned(uint8_t *data, uint16_t width, uint64_t value) {
+    if constexpr (kHostBigEndian) {
+        std::memcpy(data, reinterpret_cast<const uint8_t *>(&value) + (sizeof(value) - width), width);
+    } else {
+        std::memcpy(data, &value, width);
+    }
+}
+
+int64_t loadSigned(const uint8_t *data, uint16_t width) {
+    switch (width) {
+        case 1: {
+            int8_t value;
+            std::memcpy(&value, data, 1);
+            return value;
+        }
+        case 2: {
+            int16_t value;
+            std::memcpy(&value, data, 2);
+            return value;
+        }
+        case 4: {
+            int32_t value;
+            std::memcpy(&value, data, 4);
+            return value;
+        }
+        default: {
+            int64_t value;
+            std::memcpy(&value, data, 8);
+            return value;
+        }
+    }
+}
+
+bool isIntegral(double value) {
+    return std::isfinite(value) && std::trunc(value) == value;
+}
+
+std::optional<int64_t> asSigned(const FieldScalar &value) {
+    if (const auto *number = std::get_if<int64_t>(&value)) {
+        return *number;
+    }
+    if (const auto *number = std::get_if<uint64_t>(&value)) {
+        if (*number > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            return std::nullopt;
+        }
+        return static_cast<int64_t>(*number);
+    }
+    const double real = std::get<double>(value);
+    if (!isIntegral(real) || real < -9223372036854775808.0 || real >= 9223372036854775808.0) {
+        return std::nullopt;
+    }
+    return static_cast<int64_t>(real);
+}
+
+std::optional<uint64_t> asUnsigned(const FieldScalar &value) {
+    if (const auto *number = std::get_if<uint64_t>(&value)) {
+        return *number;
+    }
+    if (const auto *number = std::get_if<int64_t>(&value)) {
+        if (*number < 0) {
+            return std::nullopt;
+        }
+        return static_cast<uint64_t>(*number);
+    }
+    const double real = std::get<double>(value);
+    if (!isIntegral(real) || real < 0.0 || real >= 18446744073709551616.0) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(real);
+}
+
+double asReal(const FieldScalar &value) {
+    if (const auto *number = std::get_if<int64_t>(&value)) {
+        return static_cast<double>(*number);
+    }
+    if (const auto *number = std::get_if<uint64_t>(&value)) {
+        return static_cast<double>(*number);
+    }
+    return std::get<double>(value);
+}
+
+// Element accessors on host-order bytes at `data`.
+FieldScalar loadAt(const DatasetField &field, const uint8_t *data) {
+    switch (field.kind) {
+        case FieldKind::kSigned:
+            return loadSigned(data, field.width);
+        case FieldKind::kReal:
+            if (field.width == 4) {
+                float value;
+                std::memcpy(&value, data, 4);
+                return static_cast<double>(value);
+            } else {
+                double value;
+                std::memcpy(&value, data, 8);
+                return value;
+            }
+        case FieldKind::kBool:
+        case FieldKind::kChar:
+        case FieldKind::kUnsigned:
+            break;
+    }
+    return loadUnsigned(data, field.width);
+}
+
+bool storeAt(const DatasetField &field, uint8_t *data, const FieldScalar &value) {
+    const unsigned bits = field.width * 8U;
+    switch (field.kind) {
+        case FieldKind::kReal: {
+            const double real = asReal(value);
+            if (field.width == 4) {
+                if (std::isfinite(real) && std::fabs(real) > FLT_MAX) {
+                    return false;
+                }
+                const auto narrowed = static_cast<float>(real);
+                std::memcpy(data, &narrowed, 4);
+            } else {
+                std::memcpy(data, &real, 8);
+            }
+            return true;
+        }
+        case FieldKind::kSigned: {
+            const auto number = asSigned(value);
+            if (!number) {
+                return false;
+            }
+            if (bits < 64) {
+                const int64_t limit = int64_t {1} << (bits - 1);
+                if (*number < -limit || *number >= limit) {
+                    return false;
+                }
+            }
+            storeUnsigned(data, field.width, static_cast<uint64_t>(*number));
+            return true;
+        }
+        case FieldKind::kBool:
+        case FieldKind::kChar:
+        case FieldKind::kUnsigned: {
+            const auto number = asUnsigned(value);
+            if (!number) {
+                return false;
+            }
+            if (field.kind == FieldKind::kBool && *number > 1U) {
+                return false;
+            }
+            if (bits < 64 && *number >= (uint64_t {1} << bits)) {
+                return false;
+            }
+            storeUnsigned(data, field.width, *number);
+            return true;
+        }
+    }
+    return false;
+}
+
+class DatasetCompiler {
+public:
+    DatasetCompiler(const std::vector<config::TrdpDatasetDefinition> &definitions, std::vector<std::string> *errors)
+        : definitions_(definitions), errors_(errors) {}
+
+    DatasetLayouts run() {
+        DatasetLayouts layouts;
+        for (const auto &definition : definitions_) {
+            if (definition.id <= 0) {
+                report("Dataset '" + definition.name + "' has no id");
+                continue;
+            }
+            auto layout = std::make_shared<DatasetLayout>();
+            layout->dataset_id = definition.id;
+            layout->name = definition.name;
+            std::vector<const config::TrdpDatasetDefinition *> stack;
+            std::string error;
+            if (!append(definition, "", *layout, stack, error)) {
+                report("Dataset " + std::to_string(definition.id) + ": " + error);
+                continue;
+            }
+            buildSwapRuns(*layout);
+            layouts[definition.id] = std::move(layout);
+        }
+        return layouts;
+    }
+
+private:
+    const config::TrdpDatasetDefinition *resolve(std::string_view type) const {
+        const int id = xml::safeStoi(std::string(type), 0);
+        for (const auto &definition : definitions_) {
+            if ((id > 0 && definition.id == id) || (!definition.name.empty() && definition.name == type)) {
+                return &definition;
+            }
+        }
+        return nullptr;
+    }
+
+    bool append(const config::TrdpDatasetDefinition &definition, const std::string &prefix, DatasetLayout &layout,
+                std::vector<const config::TrdpDatasetDefinition *> &stack, std::string &error) {
+        stack.push_back(&definition);
+        for (size_t i = 0; i < definition.elements.size(); ++i) {
+            const auto &element = definition.elements[i];
+            const std::string name =
+                prefix + (!element.name.empty() ? element.name : "element" + std::to_string(i));
+            if (element.array_size <= 0) {
+                error = "variable-size array '" + name + "' is not supported";
+                return false;
+            }
+            const auto count = static_cast<uint32_t>(element.array_size);
+            if (auto type = parseFieldType(element.type)) {
+                const auto &info = typeInfo(*type);
+                DatasetField field;
+                field.name = name;
+                field.type = info.type;
+                field.kind = info.kind;
+                field.offset = static_cast<uint32_t>(layout.size);
+                field.width = info.width;
+                field.count = count;
+                layout.size += field.size();
+                if (layout.size > kMaxDatasetSize) {
+                    error = "dataset exceeds " + std::to_string(kMaxDatasetSize) + " bytes";
+                    return false;
+                }
+                layout.fields.push_back(std::move(field));
+                continue;
+            }
+            const auto *nested = resolve(element.type);
+            if (nested == nullptr) {
+                error = "unknown type '" + element.type + "' for element '" + name + "'";
+                return false;
+            }
+            if (std::find(stack.begin(), stack.end(), nested) != stack.end()) {
+                error = "element '" + name + "' makes dataset '" + element.type + "' recursive";
+                return false;
+            }
+            for (uint32_t index = 0; index < count; ++index) {
+                const std::string nested_prefix =
+                    count > 1 ? name + "[" + std::to_string(index) + "]." : name + ".";
+                if (!append(*nested, nested_prefix, layout, stack, error)) {
+                    return false;
+                }
+            }
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    static void buildSwapRuns(DatasetLayout &layout) {
+        if constexpr (kHostBigEndian) {
+            return;
+        }
+        for (const auto &field : layout.fields) {
+            if (field.width == 1) {
+                continue;
+            }
+            if (!layout.swap_runs.empty()) {
+                auto &last = layout.swap_runs.back();
+                if (last.width == field.width && last.offset + last.width * last.count == field.offset) {
+                    last.count += field.count;
+                    continue;
+                }
+            }
+            layout.swap_runs.push_back(SwapRun {field.offset, field.width, field.count});
+        }
+    }
+
+    void report(std::string message) {
+        if (errors_ != nullptr) {
+            errors_->push_back(std::move(message));
+        }
+    }
+
+    const std::vector<config::TrdpDatasetDefinition> &definitions_;
+    std::vector<std::string> *errors_;
+};
+
+}  // namespace
+
+std::optional<FieldType> parseFieldType(std::string_view name) {
+    const auto begin = name.find_first_not_of(" \t\n\r");
+    if (begin == std::string_view::npos) {
+        return std::nullopt;
+    }
+    name = name.substr(begin, name.find_last_not_of(" \t\n\r") - begin + 1);
+    if (std::all_of(name.begin(), name.end(), [](unsigned char ch) { return std::isdigit(ch) != 0; })) {
+        const int id = xml::safeStoi(std::string(name), 0);
+        if (id >= 1 && id <= static_cast<int>(kTypes.size())) {
+            return static_cast<FieldType>(id);
+        }
+        return std::nullopt;
+    }
+    for (const auto &info : kTypes) {
+        if (equalsUpper(name, info.name)) {
+            return info.type;
+        }
+    }
+    for (const auto &alias : kTypeAliases) {
+        if (equalsUpper(name, alias.alias)) {
+            return alias.type;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view fieldTypeName(FieldType type) {
+    return typeInfo(type).name;
+}
+
+const DatasetField *DatasetLayout::find(std::string_view field_name) const {
+    for (const auto &field : fields) {
+        if (field.name == field_name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+FieldRef DatasetLayout::resolve(std::string_view reference) const {
+    if (const auto *field = find(reference)) {
+        return FieldRef {field, 0, field->count};
+    }
+    const size_t open = reference.rfind('[');
+    if (open == std::string_view::npos || reference.back() != ']' || open + 2 >= reference.size()) {
+        return {};
+    }
+    const auto *field = find(reference.substr(0, open));
+    if (field == nullptr || field->count < 2) {
+        return {};
+    }
+    uint32_t index = 0;
+    const char *digits = reference.data() + open + 1;
+    const char *digits_end = reference.data() + reference.size() - 1;
+    auto result = std::from_chars(digits, digits_end, index);
+    if (result.ec != std::errc() || result.ptr != digits_end || index >= field->count) {
+        return {};
+    }
+    return FieldRef {field, index, 1};
+}
+
+DatasetLayouts compileDatasets(const std::vector<config::TrdpDatasetDefinition> &definitions,
+                               std::vector<std::string> *errors) {
+    return DatasetCompiler(definitions, errors).run();
+}
+
+void wireToHost(const DatasetLayout &layout, const uint8_t *wire, size_t wire_size, uint8_t *host) {
+    const size_t copied = std::min(wire_size, layout.size);
+    if (copied > 0) {
+        std::memcpy(host, wire, copied);
+    }
+    if (copied < layout.size) {
+        std::memset(host + copied, 0, layout.size - copied);
+    }
+    applySwapRuns(layout, host);
+}
+
+void hostToWire(const DatasetLayout &layout, const uint8_t *host, uint8_t *wire) {
+    if (layout.size == 0) {
+        return;
+    }
+    if (wire != host) {
+        std::memcpy(wire, host, layout.size);
+    }
+    applySwapRuns(layout, wire);
+}
+
+FieldScalar loadElement(const DatasetField &field, const uint8_t *host, uint32_t index) {
+    return loadAt(field, host + field.offset + static_cast<size_t>(index) * field.width);
+}
+
+bool storeElement(const DatasetField &field, uint8_t *host, uint32_t index, const FieldScalar &value) {
+    return storeAt(field, host + field.offset + static_cast<size_t>(index) * field.width, value);
+}
+
+FieldScalar readElement(const DatasetField &field, const uint8_t *wire, uint32_t index) {
+    uint8_t element[8];
+    std::memcpy(element, wire + field.offset + static_cast<size_t>(index) * field.width, field.width);
+    if (!kHostBigEndian && field.width > 1) {
+        std::reverse(element, element + field.width);
+    }
+    return loadAt(field, element);
+}
+
+bool encodeElement(const DatasetField &field, const FieldScalar &value, uint8_t *element) {
+    if (!storeAt(field, element, value)) {
+        return false;
+    }
+    if (!kHostBigEndian && field.width > 1) {
+        std::reverse(element, element + field.width);
+    }
+    return true;
+}
+
+bool writeElement(const DatasetField &field, uint8_t *wire, uint32_t index, const FieldScalar &value) {
+    uint8_t element[8];
+    if (!encodeElement(field, value, element)) {
+        return false;
+    }
+    std::memcpy(wire + field.offset + static_cast<size_t>(index) * field.width, element, field.width);
+    return true;
+}
+
+std::string_view loadText(const DatasetField &field, const uint8_t *data) {
+    const auto *chars = reinterpret_cast<const char *>(data + field.offset);
+    const auto *nul = static_cast<const char *>(std::memchr(chars, '\0', field.size()));
+    return std::string_view(chars, nul != nullptr ? static_cast<size_t>(nul - chars) : field.size());
+}
+
+bool storeText(const DatasetField &field, uint8_t *data, std::string_view text) {
+    if (text.size() > field.size()) {
+        return false;
+    }
+    uint8_t *chars = data + field.offset;
+    if (!text.empty()) {
+        std::memcpy(chars, text.data(), text.size());
+    }
+    std::memset(chars + text.size(), 0, field.size() - text.size());
+    return true;
+}
+
+}  // namespace trdp::stack
@@ -0,0 +1,556 @@
+#include "trdp/Expression.hpp"
+
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace trdp::stack {
+
+namespace {
+
+using Op = Expression::Op;
+
+constexpr size_t kMaxNodes = 4096;
+constexpr size_t kMaxSourceLength = 4096;
+// Recursion depth of the parser. The top level and every parenthesis nest
+// three of the counted calls (parseTernary, parseUnary, parsePrimary), so
+// this allows 64 levels of parentheses; unary operators and ternary
+// branches count one each.
+constexpr size_t kMaxDepth = 3 * (64 + 1);
+constexpr double kPi = 3.141592653589793;
+constexpr double kE = 2.718281828459045;
+
+// Out-of-range and NaN operands of bitwise operators become 0 instead of
+// hitting undefined conversions.
+int64_t toInteger(double value) {
+    if (!(value > -9223372036854775808.0 && value < 9223372036854775808.0)) {
+        return 0;
+    }
+    return static_cast<int64_t>(value);
+}
+
+double truth(bool value) {
+    return value ? 1.0 : 0.0;
+}
+
+// Shared by the interpreter and the constant folder so both agree exactly.
+inline double apply(Op op, double a, double b, double c) {
+    switch (op) {
+        case Op::kNeg: return -a;
+        case Op::kNot: return truth(a == 0.0);
+        case Op::kBitNot: return static_cast<double>(~toInteger(a));
+        case Op::kSin: return std::sin(a);
+        case Op::kCos: return std::cos(a);
+        case Op::kTan: return std::tan(a);
+        case Op::kAsin: return std::asin(a);
+        case Op::kAcos: return std::acos(a);
+        case Op::kAtan: return std::atan(a);
+        case Op::kSqrt: return std::sqrt(a);
+        case Op::kAbs: return std::fabs(a);
+        case Op::kFloor: return std::floor(a);
+        case Op::kCeil: return std::ceil(a);
+        case Op::kRound: return std::round(a);
+        case Op::kExp: return std::exp(a);
+        case Op::kLog: return std::log(a);
+        case Op::kAdd: return a + b;
+        case Op::kSub: return a - b;
+        case Op::kMul: return a * b;
+        case Op::kDiv: return a / b;
+        case Op::kMod: return std::fmod(a, b);
+        case Op::kPow: return std::pow(a, b);
+        case Op::kMin: return b < a ? b : a;
+        case Op::kMax: return b > a ? b : a;
+        case Op::kAtan2: return std::atan2(a, b);
+        case Op::kLess: return truth(a < b);
+        case Op::kLessEqual: return truth(a <= b);
+        case Op::kGreater: return truth(a > b);
+        case Op::kGreaterEqual: return truth(a >= b);
+        case Op::kEqual: return truth(a == b);
+        case Op::kNotEqual: return truth(a != b);
+        case Op::kAnd: return truth(a != 0.0 && b != 0.0);
+        case Op::kOr: return truth(a != 0.0 || b != 0.0);
+        case Op::kBitAnd: return static_cast<double>(toInteger(a) & toInteger(b));
+        case Op::kBitOr: return static_cast<double>(toInteger(a) | toInteger(b));
+        case Op::kBitXor: return static_cast<double>(toInteger(a) ^ toInteger(b));
+        case Op::kShiftLeft:
+            return static_cast<double>(
+                static_cast<int64_t>(static_cast<uint64_t>(toInteger(a)) << (toInteger(b) & 63)));
+        case Op::kShiftRight: return static_cast<double>(toInteger(a) >> (toInteger(b) & 63));
+        case Op::kSelect: return a != 0.0 ? b : c;
+        case Op::kConst:
+        case Op::kField:
+        case Op::kCycle:
+        case Op::kTime:
+            break;
+    }
+    return 0.0;
+}
+
+struct Function {
+    std::string_view name;
+    Op op;
+    int arity;
+};
+
+// clamp is expanded to min/max by the parser.
+constexpr std::array<Function, 19> kFunctions = {{
+    {"sin", Op::kSin, 1},     {"cos", Op::kCos, 1},     {"tan", Op::kTan, 1},     {"asin", Op::kAsin, 1},
+    {"acos", Op::kAcos, 1},   {"atan", Op::kAtan, 1},   {"sqrt", Op::kSqrt, 1},   {"abs", Op::kAbs, 1},
+    {"floor", Op::kFloor, 1}, {"ceil", Op::kCeil, 1},   {"round", Op::kRound, 1}, {"exp", Op::kExp, 1},
+    {"log", Op::kLog, 1},     {"pow", Op::kPow, 2},     {"min", Op::kMin, 2},     {"max", Op::kMax, 2},
+    {"atan2", Op::kAtan2, 2}, {"fmod", Op::kMod, 2},    {"clamp", Op::kMin, 3},
+}};
+
+struct BinaryOperator {
+    std::string_view token;
+    Op op;
+};
+
+// Binary operators by precedence level, loosest first.
+const std::vector<std::vector<BinaryOperator>> kBinaryLevels = {
+    {{"||", Op::kOr}},
+    {{"&&", Op::kAnd}},
+    {{"|", Op::kBitOr}},
+    {{"^", Op::kBitXor}},
+    {{"&", Op::kBitAnd}},
+    {{"==", Op::kEqual}, {"!=", Op::kNotEqual}},
+    {{"<=", Op::kLessEqual}, {">=", Op::kGreaterEqual}, {"<", Op::kLess}, {">", Op::kGreater}},
+    {{"<<", Op::kShiftLeft}, {">>", Op::kShiftRight}},
+    {{"+", Op::kAdd}, {"-", Op::kSub}},
+    {{"*", Op::kMul}, {"/", Op::kDiv}, {"%", Op::kMod}},
+};
+
+// Longest first, so "<=" is never read as "<" followed by "=".
+constexpr std::array<std::string_view, 25> kOperatorTokens = {
+    "||", "&&", "==", "!=", "<=", ">=", "<<", ">>", "|", "^", "&", "<", ">",
+    "+",  "-",  "*",  "/",  "%",  "!",  "~",  "?",  ":", "(", ")", ",",
+};
+
+std::string arityMessage(const Function &function) {
+    return std::string(function.name) + "() takes " + std::to_string(function.arity) +
+           (function.arity == 1 ? " argument" : " arguments");
+}
+
+enum class TokenType { kNumber, kIdentifier, kOperator, kEnd };
+
+struct Token {
+    TokenType type {TokenType::kEnd};
+    std::string_view text;
+    double number {0.0};
+    size_t position {0};
+};
+
+}  // namespace
+
+// Parses into a node list, folding constants as nodes are created, then
+// emits bytecode with registers allocated like a stack: a node's operands
+// occupy the registers right above its own result register.
+class ExpressionCompiler {
+public:
+    ExpressionCompiler(std::string_view source, const DatasetLayout *layout) : source_(source), layout_(layout) {
+        if (source_.size() > kMaxSourceLength) {
+            fail(kMaxSourceLength, "expression longer than " + std::to_string(kMaxSourceLength) + " characters");
+        }
+        tokenize();
+    }
+
+    Expression compile() {
+        const int root = parseTernary();
+        if (current().type != TokenType::kEnd) {
+            fail(current().position, "unexpected '" + std::string(current().text) + "'");
+        }
+        result_.code_.clear();
+        result_.constants_.clear();
+        emit(root, 0);
+        return std::move(result_);
+    }
+
+private:
+    struct Node {
+        Op op {Op::kConst};
+        double value {0.0};
+        uint32_t index {0};
+        std::array<int, 3> args {-1, -1, -1};
+    };
+
+    // Counts one level of parser recursion for as long as it is alive and
+    // fails past kMaxDepth, before the recursion can exhaust the stack.
+    class Nesting {
+    public:
+        explicit Nesting(ExpressionCompiler &compiler) : compiler_(compiler) {
+            if (++compiler_.depth_ > kMaxDepth) {
+                compiler_.fail(compiler_.current().position, "expression nested too deeply");
+            }
+        }
+        ~Nesting() { --compiler_.depth_; }
+
+        Nesting(const Nesting &) = delete;
+        Nesting &operator=(const Nesting &) = delete;
+
+    private:
+        ExpressionCompiler &compiler_;
+    };
+
+    [[noreturn]] void fail(size_t position, const std::string &message) const {
+        throw std::invalid_argument("Expression error at " + std::to_string(position + 1) + ": " + message);
+    }
+
+    void tokenize() {
+        size_t pos = 0;
+        while (pos < source_.size()) {
+            const char ch = source_[pos];
+            if (std::isspace(static_cast<unsigned char>(ch))) {
+                ++pos;
+                continue;
+            }
+            Token token;
+            token.position = pos;
+            if (std::isdigit(static_cast<unsigned char>(ch)) ||
+                (ch == '.' && pos + 1 < source_.size() && std::isdigit(static_cast<unsigned char>(source_[pos + 1])))) {
+                pos = lexNumber(pos, token);
+            } else if (std::isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
+                pos = lexIdentifier(pos, token);
+            } else {
+                for (auto candidate : kOperatorTokens) {
+                    if (source_.compare(pos, candidate.size(), candidate) == 0) {
+                        token.type = TokenType::kOperator;
+                        token.text = candidate;
+                        break;
+                    }
+                }
+                if (token.type != TokenType::kOperator) {
+                    fail(pos, "unexpected character '" + std::string(1, ch) + "'");
+                }
+                pos += token.text.size();
+            }
+            tokens_.push_back(token);
+        }
+        Token end;
+        end.position = source_.size();
+        tokens_.push_back(end);
+    }
+
+    size_t lexNumber(size_t pos, Token &token) {
+        token.type = TokenType::kNumber;
+        const char *begin = source_.data() + pos;
+        const char *end = source_.data() + source_.size();
+        std::from_chars_result result {};
+        if (source_.compare(pos, 2, "0x") == 0 || source_.compare(pos, 2, "0X") == 0) {
+            uint64_t value = 0;
+            result = std::from_chars(begin + 2, end, value, 16);
+            if (result.ptr == begin + 2) {
+                fail(pos, "malformed hex number");
+            }
+            token.number = static_cast<double>(value);
+        } else {
+            result = std::from_chars(begin, end, token.number);
+        }
+        if (result.ec != std::errc()) {
+            fail(pos, "malformed number");
+        }
+        const auto length = static_cast<size_t>(result.ptr - begin);
+        token.text = source_.substr(pos, length);
+        return pos + length;
+    }
+
+    // Field names may contain dots and [index] suffixes, e.g. "hb[1].counter".
+    size_t lexIdentifier(size_t pos, Token &token) {
+        const size_t begin = pos;
+        while (pos < source_.size()) {
+            const char ch = source_[pos];
+            if (std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '.') {
+                ++pos;
+            } else if (ch == '[') {
+                const size_t close = source_.find(']', pos);
+                if (close == std::string_view::npos) {
+                    fail(pos, "missing ']'");
+                }
+                pos = close + 1;
+            } else {
+                break;
+            }
+        }
+        token.type = TokenType::kIdentifier;
+        token.text = source_.substr(begin, pos - begin);
+        return pos;
+    }
+
+    const Token &current() const { return tokens_[cursor_]; }
+
+    bool acceptOperator(std::string_view text) {
+        if (current().type == TokenType::kOperator && current().text == text) {
+            ++cursor_;
+            return true;
+        }
+        return false;
+    }
+
+    void expectOperator(std::string_view text) {
+        if (!acceptOperator(text)) {
+            fail(current().position, "expected '" + std::string(text) + "'");
+        }
+    }
+
+    int addNode(const Node &node) {
+        if (nodes_.size() >= kMaxNodes) {
+            fail(current().position, "expression too long");
+        }
+        nodes_.push_back(node);
+        return static_cast<int>(nodes_.size() - 1);
+    }
+
+    int constant(double value) {
+        Node node;
+        node.value = value;
+        return addNode(node);
+    }
+
+    int make(Op op, int a, int b = -1, int c = -1) {
+        const std::array<int, 3> args {a, b, c};
+        bool folded = true;
+        std::array<double, 3> values {0.0, 0.0, 0.0};
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] < 0) {
+                continue;
+            }
+            if (nodes_[args[i]].op != Op::kConst) {
+                folded = false;
+                break;
+            }
+            values[i] = nodes_[args[i]].value;
+        }
+        if (folded) {
+            return constant(apply(op, values[0], values[1], values[2]));
+        }
+        Node node;
+        node.op = op;
+        node.args = args;
+        return addNode(node);
+    }
+
+    int parseTernary() {
+        const Nesting nesting(*this);
+        const int condition = parseBinary(0);
+        if (!acceptOperator("?")) {
+            return condition;
+        }
+        const int when_true = parseTernary();
+        expectOperator(":");
+        const int when_false = parseTernary();
+        if (nodes_[condition].op == Op::kConst) {
+            return nodes_[condition].value != 0.0 ? when_true : when_false;
+        }
+        return make(Op::kSelect, condition, when_true, when_false);
+    }
+
+    int parseBinary(size_t level) {
+        if (level == kBinaryLevels.size()) {
+            return parseUnary();
+        }
+        int left = parseBinary(level + 1);
+        while (true) {
+            const BinaryOperator *matched = nullptr;
+            for (const auto &candidate : kBinaryLevels[level]) {
+                if (acceptOperator(candidate.token)) {
+                    matched = &candidate;
+                    break;
+                }
+            }
+            if (matched == nullptr) {
+                return left;
+            }
+            left = make(matched->op, left, parseBinary(level + 1));
+        }
+    }
+
+    int parseUnary() {
+        const Nesting nesting(*this);
+        if (acceptOperator("-")) {
+            return make(Op::kNeg, parseUnary());
+        }
+        if (acceptOperator("+")) {
+            return parseUnary();
+        }
+        if (acceptOperator("!")) {
+            return make(Op::kNot, parseUnary());
+        }
+        if (acceptOperator("~")) {
+            return make(Op::kBitNot, parseUnary());
+        }
+        return parsePrimary();
+    }
+
+    int parsePrimary() {
+        const Nesting nesting(*this);
+        const Token token = current();
+        if (token.type == TokenType::kNumber) {
+            ++cursor_;
+            return constant(token.number);
+        }
+        if (acceptOperator("(")) {
+            const int inner = parseTernary();
+            expectOperator(")");
+            return inner;
+        }
+        if (token.type != TokenType::kIdentifier) {
+            fail(token.position, token.type == TokenType::kEnd ? "unexpected end of expression" :
+                                                                 "unexpected '" + std::string(token.text) + "'");
+        }
+        ++cursor_;
+        if (acceptOperator("(")) {
+            return parseCall(token);
+        }
+        return variable(token);
+    }
+
+    int parseCall(const Token &name) {
+        const Function *function = nullptr;
+        for (const auto &candidate : kFunctions) {
+            if (candidate.name == name.text) {
+                function = &candidate;
+                break;
+            }
+        }
+        if (function == nullptr) {
+            fail(name.position, "unknown function '" + std::string(name.text) + "'");
+        }
+        std::array<int, 3> args {-1, -1, -1};
+        int count = 0;
+        if (!acceptOperator(")")) {
+            do {
+                if (count == function->arity) {
+                    fail(current().position, arityMessage(*function));
+                }
+                args[count++] = parseTernary();
+            } while (acceptOperator(","));
+            expectOperator(")");
+        }
+        if (count != function->arity) {
+            fail(name.position, arityMessage(*function));
+        }
+        if (function->name == "clamp") {
+            return make(Op::kMax, make(Op::kMin, args[0], args[2]), args[1]);
+        }
+        return make(function->op, args[0], args[1], args[2]);
+    }
+
+    int variable(const Token &token) {
+        if (token.text == "pi") {
+            return constant(kPi);
+        }
+        if (token.text == "e") {
+            return constant(kE);
+        }
+        Node node;
+        if (token.text == "cycle") {
+            node.op = Op::kCycle;
+            return addNode(node);
+        }
+        if (token.text == "t") {
+            node.op = Op::kTime;
+            return addNode(node);
+        }
+        const FieldRef field = layout_ != nullptr ? layout_->resolve(token.text) : FieldRef {};
+        if (!field) {
+            fail(token.position, "unknown name '" + std::string(token.text) + "'");
+        }
+        if (field.count != 1) {
+            fail(token.position, "field '" + std::string(token.text) + "' is an array; use an element");
+        }
+        node.op = Op::kField;
+        node.index = static_cast<uint32_t>(result_.fields_.size());
+        result_.fields_.push_back(field);
+        return addNode(node);
+    }
+
+    void emit(int index, size_t reg) {
+        if (reg >= Expression::kMaxRegisters) {
+            fail(0, "expression nested too deeply");
+        }
+        const Node &node = nodes_[index];
+        Expression::Instruction instruction;
+        instruction.op = node.op;
+        instruction.dst = static_cast<uint8_t>(reg);
+        switch (node.op) {
+            case Op::kConst:
+                instruction.index = static_cast<uint32_t>(result_.constants_.size());
+                result_.constants_.push_back(node.value);
+                break;
+            case Op::kField:
+                instruction.index = node.index;
+                break;
+            case Op::kCycle:
+            case Op::kTime:
+                break;
+            default: {
+                // Unused operand slots point at a live register; apply()
+                // reads but ignores them.
+                instruction.a = instruction.b = instruction.c = static_cast<uint8_t>(reg);
+                uint8_t *operands[3] = {&instruction.a, &instruction.b, &instruction.c};
+                for (size_t i = 0; i < node.args.size() && node.args[i] >= 0; ++i) {
+                    emit(node.args[i], reg + i);
+                    *operands[i] = static_cast<uint8_t>(reg + i);
+                }
+                break;
+            }
+        }
+        result_.code_.push_back(instruction);
+    }
+
+    std::string_view source_;
+    const DatasetLayout *layout_;
+    std::vector<Token> tokens_;
+    size_t cursor_ {0};
+    size_t depth_ {0};
+    std::vector<Node> nodes_;
+    Expression result_;
+};
+
+Expression::Expression() {
+    code_.push_back(Instruction {});
+    constants_.push_back(0.0);
+}
+
+Expression Expression::compile(std::string_view source, const DatasetLayout *layout) {
+    return ExpressionCompiler(source, layout).compile();
+}
+
+double Expression::evaluate(const uint8_t *wire, uint64_t cycle, double seconds) const {
+    std::array<double, kMaxRegisters> registers;
+    for (const auto &instruction : code_) {
+        double &out = registers[instruction.dst];
+        switch (instruction.op) {
+            case Op::kConst:
+                out = constants_[instruction.index];
+                break;
+            case Op::kField: {
+                const FieldRef &field = fields_[instruction.index];
+                const FieldScalar value = readElement(*field.field, wire, field.index);
+                if (const auto *number = std::get_if<int64_t>(&value)) {
+                    out = static_cast<double>(*number);
+                } else if (const auto *number = std::get_if<uint64_t>(&value)) {
+                    out = static_cast<double>(*number);
+                } else {
+                    out = std::get<double>(value);
+                }
+                break;
+            }
+            case Op::kCycle:
+                out = static_cast<double>(cycle);
+                break;
+            case Op::kTime:
+                out = seconds;
+                break;
+            default:
+                out = apply(instruction.op, registers[instruction.a], registers[instruction.b],
+                            registers[instruction.c]);
+                break;
+        }
+    }
+    return registers[0];
+}
+
+}  // namespace trdp::stack
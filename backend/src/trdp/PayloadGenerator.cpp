@@ -0,0 +1,216 @@
+#include "trdp/PayloadGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace trdp::stack {
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+struct KindName {
+    std::string_view name;
+    GeneratorKind kind;
+};
+
+constexpr std::array<KindName, 7> kKindNames = {{
+    {"counter", GeneratorKind::kCounter},
+    {"sawtooth", GeneratorKind::kSawtooth},
+    {"ramp", GeneratorKind::kSawtooth},
+    {"sine", GeneratorKind::kSine},
+    {"random", GeneratorKind::kRandom},
+    {"sequence", GeneratorKind::kSequence},
+    {"expression", GeneratorKind::kExpression},
+}};
+
+// Bounds of the values a field of the given kind and width can hold.
+double fieldLow(const DatasetField &field) {
+    switch (field.kind) {
+        case FieldKind::kSigned:
+            return -std::ldexp(1.0, field.width * 8 - 1);
+        case FieldKind::kReal:
+            return field.width == 4 ? -static_cast<double>(FLT_MAX) : -DBL_MAX;
+        default:
+            return 0.0;
+    }
+}
+
+double fieldHigh(const DatasetField &field) {
+    switch (field.kind) {
+        case FieldKind::kBool:
+            return 1.0;
+        case FieldKind::kSigned:
+            return std::ldexp(1.0, field.width * 8 - 1) - 1.0;
+        case FieldKind::kReal:
+            return field.width == 4 ? static_cast<double>(FLT_MAX) : DBL_MAX;
+        default:
+            return std::ldexp(1.0, field.width * 8) - 1.0;
+    }
+}
+
+}  // namespace
+
+std::optional<GeneratorKind> parseGeneratorKind(std::string_view name) {
+    for (const auto &entry : kKindNames) {
+        if (entry.name == name) {
+            return entry.kind;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view generatorKindName(GeneratorKind kind) {
+    for (const auto &entry : kKindNames) {
+        if (entry.kind == kind) {
+            return entry.name;
+        }
+    }
+    return "counter";
+}
+
+FieldGenerator::FieldGenerator(DatasetLayoutPtr layout, GeneratorSpec spec)
+    : layout_(std::move(layout)), spec_(std::move(spec)), random_(std::random_device {}()) {
+    if (!layout_) {
+        throw std::invalid_argument("PD message has no dataset layout");
+    }
+    const FieldRef target = layout_->resolve(spec_.field);
+    if (!target) {
+        throw std::invalid_argument("Unknown field '" + spec_.field + "'");
+    }
+    if (target.count != 1) {
+        throw std::invalid_argument("Generator field '" + spec_.field + "' is an array; address one element");
+    }
+    field_ = target.field;
+    index_ = target.index;
+
+    const bool finite = std::isfinite(spec_.start) && std::isfinite(spec_.step) && std::isfinite(spec_.min) &&
+                        std::isfinite(spec_.max) &&
+                        std::all_of(spec_.values.begin(), spec_.values.end(),
+                                    [](double value) { return std::isfinite(value); });
+    if (!finite) {
+        throw std::invalid_argument("Generator values must be finite numbers");
+    }
+    switch (spec_.kind) {
+        case GeneratorKind::kCounter:
+            break;
+        case GeneratorKind::kSawtooth:
+        case GeneratorKind::kSine:
+            if (spec_.max <= spec_.min || spec_.period == 0) {
+                throw std::invalid_argument("Generator for '" + spec_.field + "' needs max > min and a period");
+            }
+            break;
+        case GeneratorKind::kRandom:
+            if (spec_.max < spec_.min) {
+                throw std::invalid_argument("Generator for '" + spec_.field + "' needs max >= min");
+            }
+            break;
+        case GeneratorKind::kSequence:
+            if (spec_.values.empty()) {
+                throw std::invalid_argument("Sequence generator for '" + spec_.field + "' has no values");
+            }
+            break;
+        case GeneratorKind::kExpression:
+            expression_ = Expression::compile(spec_.expression, layout_.get());
+            break;
+    }
+}
+
+std::pair<size_t, size_t> FieldGenerator::apply(uint8_t *wire, uint64_t cycle, double seconds) {
+    FieldScalar value;
+    switch (spec_.kind) {
+        case GeneratorKind::kCounter:
+            value = counterValue(cycle);
+            break;
+        case GeneratorKind::kSawtooth:
+            value = fromReal(spec_.min +
+                             (spec_.max - spec_.min) * static_cast<double>(cycle % spec_.period) / spec_.period);
+            break;
+        case GeneratorKind::kSine: {
+            const double phase = kTwoPi * static_cast<double>(cycle % spec_.period) / spec_.period;
+            const double half = (spec_.max - spec_.min) / 2.0;
+            value = fromReal(spec_.min + half + half * std::sin(phase));
+            break;
+        }
+        case GeneratorKind::kRandom:
+            if (field_->kind == FieldKind::kReal) {
+                value = fromReal(std::uniform_real_distribution<double>(spec_.min, spec_.max)(random_));
+            } else {
+                const double low = std::ceil(std::max(spec_.min, fieldLow(*field_)));
+                const double high = std::floor(std::min(spec_.max, fieldHigh(*field_)));
+                value = low >= high ? fromReal(low) :
+                                      fromReal(static_cast<double>(std::uniform_int_distribution<int64_t>(
+                                          static_cast<int64_t>(std::max(low, -9.2e18)),
+                                          static_cast<int64_t>(std::min(high, 9.2e18)))(random_)));
+            }
+            break;
+        case GeneratorKind::kSequence:
+            value = fromReal(spec_.values[cycle % spec_.values.size()]);
+            break;
+        case GeneratorKind::kExpression:
+            value = fromReal(expression_.evaluate(wire, cycle, seconds));
+            break;
+    }
+    writeElement(*field_, wire, index_, value);
+    return {field_->offset + static_cast<size_t>(index_) * field_->width, field_->width};
+}
+
+FieldScalar FieldGenerator::counterValue(uint64_t cycle) const {
+    if (field_->kind == FieldKind::kReal || spec_.max > spec_.min) {
+        double value = spec_.start + spec_.step * static_cast<double>(cycle);
+        if (spec_.max > spec_.min) {
+            // Integer ranges are inclusive, so the span covers max itself.
+            const double span = spec_.max - spec_.min + (field_->kind == FieldKind::kReal ? 0.0 : 1.0);
+            value = spec_.min + std::fmod(std::fmod(value - spec_.min, span) + span, span);
+        }
+        return fromReal(value);
+    }
+    // Integer counters wrap like the field's own type does.
+    uint64_t raw = static_cast<uint64_t>(std::llround(spec_.start)) +
+                   static_cast<uint64_t>(std::llround(spec_.step)) * cycle;
+    if (field_->kind == FieldKind::kBool) {
+        return FieldScalar {raw & 1U};
+    }
+    const unsigned bits = field_->width * 8U;
+    if (bits < 64) {
+        raw &= (uint64_t {1} << bits) - 1U;
+        if (field_->kind == FieldKind::kSigned && (raw >> (bits - 1)) != 0U) {
+            raw |= ~((uint64_t {1} << bits) - 1U);
+        }
+    }
+    if (field_->kind == FieldKind::kSigned) {
+        return FieldScalar {static_cast<int64_t>(raw)};
+    }
+    return FieldScalar {raw};
+}
+
+// Rounds and clamps to what the field can hold, so a waveform that overshoots
+// the type range saturates instead of being dropped. NaN becomes 0.
+FieldScalar FieldGenerator::fromReal(double value) const {
+    if (std::isnan(value)) {
+        value = 0.0;
+    }
+    value = std::clamp(value, fieldLow(*field_), fieldHigh(*field_));
+    switch (field_->kind) {
+        case FieldKind::kReal:
+            return FieldScalar {value};
+        case FieldKind::kSigned:
+            if (value >= 9223372036854775807.0) {
+                return FieldScalar {std::numeric_limits<int64_t>::max()};
+            }
+            return FieldScalar {static_cast<int64_t>(std::llround(value))};
+        default: {
+            const double rounded = std::round(value);
+            if (rounded >= 18446744073709551615.0) {
+                return FieldScalar {std::numeric_limits<uint64_t>::max()};
+            }
+            return FieldScalar {static_cast<uint64_t>(rounded)};
+        }
+    }
+}
+
+}  // namespace trdp::stack
@@ -0,0 +1,78 @@
+#include "trdp/PdScheduler.hpp"
+
+namespace trdp::stack {
+
+void PdScheduler::schedule(int id, TimePoint deadline) {
+    const uint64_t generation = next_generation_++;
+    generations_[id] = generation;
+    heap_.push(Entry{deadline, id, generation});
+    // Lazy invalidation leaves stale entries behind; compact once they
+    // dominate the heap so memory stays proportional to live telegrams.
+    if (heap_.size() > 2 * generations_.size() + 64) {
+        std::vector<Entry> live;
+        live.reserve(generations_.size());
+        while (!heap_.empty()) {
+            if (isCurrent(heap_.top())) {
+                live.push_back(heap_.top());
+            }
+            heap_.pop();
+        }
+        heap_ = decltype(heap_)(Later{}, std::move(live));
+    }
+}
+
+void PdScheduler::clear() {
+    heap_ = {};
+    generations_.clear();
+}
+
+void PdScheduler::collectDue(TimePoint now, std::vector<DueEntry> &out) {
+    while (!heap_.empty()) {
+        const Entry &top = heap_.top();
+        if (!isCurrent(top)) {
+            heap_.pop();
+            continue;
+        }
+        if (top.deadline > now) {
+            break;
+        }
+        out.push_back(DueEntry{top.id, top.deadline});
+        generations_.erase(top.id);
+        heap_.pop();
+    }
+}
+
+std::optional<PdScheduler::TimePoint> PdScheduler::nextDeadline() {
+    dropStale();
+    if (heap_.empty()) {
+        return std::nullopt;
+    }
+    return heap_.top().deadline;
+}
+
+PdScheduler::TimePoint PdScheduler::advance(TimePoint deadline, std::chrono::milliseconds period, TimePoint now) {
+    if (period.count() <= 0) {
+        return now + std::chrono::hours(24);
+    }
+    deadline += period;
+    if (deadline <= now) {
+        // The publisher fell behind by more than a cycle; skip the missed
+        // cycles rather than bursting them out back to back.
+        const auto missed = (now - deadline) / period + 1;
+        deadline += missed * period;
+    }
+    return deadline;
+}
+
+bool PdScheduler::isCurrent(const Entry &entry) const {
+    auto it = generations_.find(entry.id);
+    return it != generations_.end() && it->second == entry.generation;
+}
+
+void PdScheduler::dropStale() {
+    while (!heap_.empty() && !isCurrent(heap_.top())) {
+        heap_.pop();
+    }
+}
+
+}  // namespace trdp::stack
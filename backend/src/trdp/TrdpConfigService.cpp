@@ -40,10 +40,11 @@ TrdpConfig rowToConfig(sqlite3_stmt *stmt) {
 TrdpConfigService::TrdpConfigService(db::Database &database) : database_(database) {}
 
 std::vector<TrdpConfig> TrdpConfigService::listConfigsForUser(long long user_id) {
-    sqlite3_stmt *stmt = nullptr;
     const char *sql =
         "SELECT id, user_id, name, xml_content, validation_status, created_at FROM xml_configs WHERE user_id = ? ORDER BY created_at DESC;";
-    if (sqlite3_prepare_v2(database_.handle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         throw std::runtime_error("failed to query configs");
     }
 
@@ -54,32 +55,36 @@ std::vector<TrdpConfig> TrdpConfigService::listConfigsForUser(long long user_id)
         configs.push_back(rowToConfig(stmt));
     }
 
-    sqlite3_finalize(stmt);
     return configs;
 }
 
 TrdpConfig TrdpConfigService::createConfig(long long user_id, const std::string &name, const std::string &xml_content) {
     std::string validation_status = validateXml(xml_content);
 
-    sqlite3_stmt *stmt = nullptr;
     const char *sql =
         "INSERT INTO xml_configs (user_id, name, xml_content, validation_status) VALUES (?, ?, ?, ?);";
-    if (sqlite3_prepare_v2(database_.handle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        throw std::runtime_error("failed to prepare insert");
-    }
+    long long new_id = 0;
+    {
+        auto connection = database_.writer();
+        auto stmt = connection->prepare(sql);
+        if (!stmt) {
+            throw std::runtime_error("failed to prepare insert");
+        }
 
-    sqlite3_bind_int64(stmt, 1, user_id);
-    sqlite3_bind_text(stmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, xml_content.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, validation_status.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 1, user_id);
+        sqlite3_bind_text(stmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, xml_content.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, validation_status.c_str(), -1, SQLITE_TRANSIENT);
 
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error("failed to insert config");
-    }
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error("failed to insert config");
+        }
 
-    long long new_id = sqlite3_last_insert_rowid(database_.handle());
+        // The row id of the insert above; the lease keeps other writes
+        // from changing it in between.
+        new_id = sqlite3_last_insert_rowid(connection->handle());
+    }
 
     TrdpConfig config;
     config.id = new_id;
@@ -96,10 +101,11 @@ TrdpConfig TrdpConfigService::createConfig(long long user_id, const std::string
 }
 
 std::optional<TrdpConfig> TrdpConfigService::getConfigById(long long id) {
-    sqlite3_stmt *stmt = nullptr;
     const char *sql =
         "SELECT id, user_id, name, xml_content, validation_status, created_at FROM xml_configs WHERE id = ? LIMIT 1;";
-    if (sqlite3_prepare_v2(database_.handle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         throw std::runtime_error("failed to prepare select");
     }
 
@@ -107,46 +113,43 @@ std::optional<TrdpConfig> TrdpConfigService::getConfigById(long long id) {
 
     int rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
         return std::nullopt;
     }
 
     TrdpConfig config = rowToConfig(stmt);
-    sqlite3_finalize(stmt);
     return config;
 }
 
 std::optional<TrdpConfig> TrdpConfigService::getActiveConfig() {
-    sqlite3_stmt *stmt = nullptr;
     const char *sql =
         "SELECT xc.id, xc.user_id, xc.name, xc.xml_content, xc.validation_status, xc.created_at "
         "FROM active_config ac JOIN xml_configs xc ON ac.xml_config_id = xc.id WHERE ac.id = 1 LIMIT 1;";
-    if (sqlite3_prepare_v2(database_.handle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         throw std::runtime_error("failed to query active config");
     }
 
     int rc = sqlite3_step(stmt);
     if (rc != SQLITE_ROW) {
-        sqlite3_finalize(stmt);
         return std::nullopt;
     }
 
     TrdpConfig config = rowToConfig(stmt);
-    sqlite3_finalize(stmt);
     return config;
 }
 
 void TrdpConfigService::setActiveConfig(long long config_id) {
-    sqlite3_stmt *stmt = nullptr;
     const char *sql =
         "INSERT INTO active_config (id, xml_config_id) VALUES (1, ?) ON CONFLICT(id) DO UPDATE SET xml_config_id = excluded.xml_config_id;";
-    if (sqlite3_prepare_v2(database_.handle(), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.writer();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         throw std::runtime_error("failed to prepare active_config update");
     }
 
     sqlite3_bind_int64(stmt, 1, config_id);
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error("failed to update active config");
     }
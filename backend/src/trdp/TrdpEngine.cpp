@@ -3,12 +3,14 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -16,6 +18,9 @@
 
 #ifdef __linux__
 #include <dlfcn.h>
+#include <sys/eventfd.h>
+#include <sys/select.h>
+#include <unistd.h>
 #endif
 
 #if defined(__has_include)
@@ -32,11 +37,12 @@
 
 #include "db/Database.hpp"
 #include "trdp/TrdpXmlParser.hpp"
+#include "trdp/UdpTransport.hpp"
 #include "trdp/XmlUtils.hpp"
+#include "trdp/xml/XmlTokenizer.hpp"
 
 using trdp::config::TrdpTelegramDirection;
 using trdp::config::TrdpTelegramType;
-using trdp::xml::extractElements;
 using trdp::xml::parseHexPayload;
 using trdp::xml::safeStoi;
 using trdp::xml::toLowerCopy;
@@ -44,6 +50,116 @@ using trdp::xml::trimCopy;
 
 namespace trdp::stack {
 
+namespace {
+// Upper bound on how long the worker may sleep while a native TRDP session
+// needs tlc_process() to be driven.
+constexpr std::chrono::milliseconds kStackPollInterval {10};
+
+constexpr size_t kCacheLineSize = 64;
+
+int64_t unixNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Parses dotted-quad text into a host-order IPv4 address; 0 when invalid.
+uint32_t parseIpv4(const std::string &ip) {
+    unsigned int octets[4];
+    if (ip.empty() || std::sscanf(ip.c_str(), "%u.%u.%u.%u", &octets[0], &octets[1], &octets[2], &octets[3]) != 4) {
+        return 0U;
+    }
+    return ((octets[0] & 0xFFU) << 24) | ((octets[1] & 0xFFU) << 16) | ((octets[2] & 0xFFU) << 8) |
+           (octets[3] & 0xFFU);
+}
+
+// Formats a host-order IPv4 address into `buffer`; empty for 0.
+std::string_view formatIpv4(uint32_t value, char (&buffer)[16]) {
+    if (value == 0U) {
+        return {};
+    }
+    const int length = std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (value >> 24) & 0xFFU,
+                                     (value >> 16) & 0xFFU, (value >> 8) & 0xFFU, value & 0xFFU);
+    return std::string_view(buffer, static_cast<size_t>(std::max(length, 0)));
+}
+
+// Publishers only ever carry their dataset, so their slots are sized to it.
+// Subscribers keep room for a full frame: a peer may send a different size.
+size_t pdSlotCapacity(const PdMessage &message, bool is_outgoing) {
+    if (!is_outgoing || !message.dataset) {
+        return std::max(kMaxPdPayloadSize, message.payload.size());
+    }
+    return std::max(message.dataset->size, message.payload.size());
+}
+
+// Resolves a telegram's dataset reference, which is a dataset id or name.
+DatasetLayoutPtr findDataset(const DatasetLayouts &layouts, const std::string &reference) {
+    if (reference.empty()) {
+        return nullptr;
+    }
+    if (auto it = layouts.find(safeStoi(reference, 0)); it != layouts.end()) {
+        return it->second;
+    }
+    for (const auto &entry : layouts) {
+        if (entry.second->name == reference) {
+            return entry.second;
+        }
+    }
+    return nullptr;
+}
+
+// Wire bytes for one field update, to be copied to `offset`.
+struct FieldPatch {
+    size_t offset {0};
+    std::vector<uint8_t> bytes;
+};
+
+FieldPatch encodeFieldUpdate(const DatasetLayout &layout, const PdFieldUpdate &update) {
+    const FieldRef target = layout.resolve(update.name);
+    if (!target) {
+        throw std::invalid_argument("Unknown field '" + update.name + "'");
+    }
+    const DatasetField &field = *target.field;
+    FieldPatch patch;
+    patch.offset = field.offset + static_cast<size_t>(target.index) * field.width;
+    patch.bytes.resize(static_cast<size_t>(target.count) * field.width);
+    if (update.text) {
+        if (field.kind != FieldKind::kChar || target.count != field.count) {
+            throw std::invalid_argument("Field '" + update.name + "' does not take text");
+        }
+        if (update.text->size() > field.size()) {
+            throw std::invalid_argument("Text for field '" + update.name + "' exceeds " +
+                                        std::to_string(field.size()) + " characters");
+        }
+        std::memcpy(patch.bytes.data(), update.text->data(), update.text->size());
+        return patch;
+    }
+    if (update.values.size() != target.count) {
+        throw std::invalid_argument("Field '" + update.name + "' takes " + std::to_string(target.count) +
+                                    (target.count == 1 ? " value" : " values"));
+    }
+    for (uint32_t i = 0; i < target.count; ++i) {
+        if (!encodeElement(field, update.values[i], patch.bytes.data() + static_cast<size_t>(i) * field.width)) {
+            throw std::invalid_argument("Value out of range for " + std::string(fieldTypeName(field.type)) +
+                                        " field '" + update.name + "'");
+        }
+    }
+    return patch;
+}
+}  // namespace
+
+std::string_view receiveClockName(ReceiveClock clock) {
+    switch (clock) {
+        case ReceiveClock::kKernelTimestamp:
+            return "kernel_timestamp";
+        case ReceiveClock::kSocketWakeup:
+            return "socket_wakeup";
+        case ReceiveClock::kNone:
+            break;
+    }
+    return "none";
+}
+
 struct TrdpEngine::PdRuntimeState {
     TrdpEngine *engine {nullptr};
     int id {0};
@@ -52,9 +168,58 @@ struct TrdpEngine::PdRuntimeState {
     int cycle_ms {0};
     std::string destination;
     std::string source;
+    // Publishers only. Sized to the slot capacity when the telegram is
+    // created and never resized or reassigned, so field updates write into
+    // storage that stays put; the first payload_size bytes are the payload
+    // and the rest are zero. Guarded by state_mutex_.
     std::vector<uint8_t> payload;
+    size_t payload_size {0};
+    // The worker copies the payload here under state_mutex_ and sends the
+    // copy, so a concurrent update never shows up half-written in a frame.
+    // Worker thread only.
+    std::vector<uint8_t> send_buffer;
+    size_t send_size {0};
+    // Updates sent right away from API threads: put_version numbers them
+    // (state_mutex_) and put_sent is the newest one sent (put_mutex), so an
+    // older copy is never sent after a newer one.
+    uint64_t put_version {0};
+    std::mutex put_mutex;
+    uint64_t put_sent {0};
     std::chrono::steady_clock::time_point next_cycle;
+    std::shared_ptr<PdSlot> slot;
     void *native_handle {nullptr};
+    // Evaluated on every publish; generator_ranges is scratch space reused
+    // across cycles so that evaluation does not allocate.
+    std::vector<FieldGenerator> generators;
+    std::vector<std::pair<size_t, size_t>> generator_ranges;
+    uint64_t generator_cycle {0};
+    // Timing histograms, see PdTimingStats. They are created with the state
+    // and only recorded by the worker thread, so each has a single writer
+    // and readers copy them without taking a lock.
+    std::unique_ptr<util::LatencyHistogram> interval_deviation;
+    std::unique_ptr<util::LatencyHistogram> inter_arrival;
+    std::unique_ptr<util::LatencyHistogram> update_latency;
+    // Previous cyclic send or received frame; worker thread only.
+    std::optional<std::chrono::steady_clock::time_point> last_event;
+    // Set under state_mutex_ when an update restarted the publisher's
+    // cadence; the next cyclic send then records no interval deviation.
+    bool rearmed {false};
+
+    void allocatePayload(const std::vector<uint8_t> &initial, size_t capacity) {
+        payload.assign(std::max(capacity, initial.size()), 0);
+        std::copy(initial.begin(), initial.end(), payload.begin());
+        payload_size = initial.size();
+        send_buffer.assign(payload.size(), 0);
+    }
+
+    void createTimingHistograms() {
+        if (is_outgoing) {
+            interval_deviation = std::make_unique<util::LatencyHistogram>();
+        } else {
+            inter_arrival = std::make_unique<util::LatencyHistogram>();
+            update_latency = std::make_unique<util::LatencyHistogram>();
+        }
+    }
 };
 
 struct TrdpEngine::MdRuntimeState {
@@ -68,6 +233,124 @@ struct TrdpEngine::MdRuntimeState {
     void *native_handle {nullptr};
 };
 
+// Fixed-capacity PD telegram state. The payload buffer is allocated once when
+// the slot is created and overwritten in place under a sequence lock, so
+// storing a received telegram never allocates. Readers materialize an
+// immutable PdMessage and reuse it until the sequence moves on. Repeated
+// payloads only restamp the slot, outside the sequence lock, so the message
+// is then just copied, at most once per second shown in its timestamp.
+struct alignas(kCacheLineSize) TrdpEngine::PdSlot {
+    PdSlot(int msg_id, std::string msg_name, int cycle_ms, DatasetLayoutPtr layout, size_t payload_capacity)
+        : id(msg_id),
+          name(std::move(msg_name)),
+          cycle_time_ms(cycle_ms),
+          dataset(std::move(layout)),
+          capacity(payload_capacity),
+          data(std::make_unique<uint8_t[]>(std::max<size_t>(payload_capacity, 1))) {}
+
+    const int id;
+    const std::string name;
+    const int cycle_time_ms;
+    const DatasetLayoutPtr dataset;
+    const size_t capacity;
+
+    // Writer side. An odd sequence marks an update in progress; it does not
+    // move when only timestamp_ns does.
+    std::atomic<uint64_t> sequence {0};
+    std::atomic<size_t> size {0};
+    std::atomic<uint32_t> src_ip {0};
+    std::atomic<uint32_t> dst_ip {0};
+    std::atomic<int64_t> timestamp_ns {0};
+    std::atomic<uint64_t> version {0};
+    std::unique_ptr<uint8_t[]> data;
+
+    // Reader side, kept off the writer's cache line.
+    alignas(kCacheLineSize) std::mutex cache_mutex;
+    uint64_t cached_sequence {0};
+    int64_t cached_second {0};
+    PdMessagePtr cached;
+};
+
+struct TrdpEngine::PdTable {
+    // pd_version_ when the table was built; every slot has a newer version.
+    uint64_t base_version {0};
+    std::vector<std::shared_ptr<PdSlot>> slots;
+    std::unordered_map<int, size_t> index;
+};
+
+// Fixed-capacity MD history. Messages live in a ring in arrival order and the
+// oldest are evicted once the count or payload byte budget is exceeded. Ids
+// are handed out in increasing order, so cursor reads binary-search the ring
+// and only touch messages newer than the cursor.
+class TrdpEngine::MdHistory {
+public:
+    explicit MdHistory(MdHistoryOptions options)
+        : ring_(std::max<size_t>(options.max_messages, 1)), max_payload_bytes_(options.max_payload_bytes) {}
+
+    void push(MdMessage message) {
+        payload_bytes_ += message.payload.size();
+        if (count_ == ring_.size()) {
+            evictOldest();
+        }
+        ring_[(head_ + count_) % ring_.size()] = std::move(message);
+        ++count_;
+        // Always keep the newest message, even if it alone exceeds the budget.
+        while (count_ > 1 && payload_bytes_ > max_payload_bytes_) {
+            evictOldest();
+        }
+    }
+
+    std::vector<MdMessage> since(int since_id, size_t limit) const {
+        size_t low = 0;
+        size_t high = count_;
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (at(mid).id <= since_id) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        size_t available = count_ - low;
+        if (limit > 0) {
+            available = std::min(available, limit);
+        }
+        std::vector<MdMessage> messages;
+        messages.reserve(available);
+        for (size_t i = 0; i < available; ++i) {
+            messages.push_back(at(low + i));
+        }
+        return messages;
+    }
+
+    void clear() {
+        for (auto &message : ring_) {
+            message = MdMessage{};
+        }
+        head_ = 0;
+        count_ = 0;
+        payload_bytes_ = 0;
+    }
+
+private:
+    const MdMessage &at(size_t index) const { return ring_[(head_ + index) % ring_.size()]; }
+
+    void evictOldest() {
+        auto &oldest = ring_[head_];
+        payload_bytes_ -= oldest.payload.size();
+        // Release the payload now instead of when the slot is reused.
+        oldest = MdMessage{};
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+    }
+
+    std::vector<MdMessage> ring_;
+    size_t max_payload_bytes_;
+    size_t head_ {0};
+    size_t count_ {0};
+    size_t payload_bytes_ {0};
+};
+
 class TrdpEngine::TrdpStackAdapter {
 public:
     explicit TrdpStackAdapter(TrdpEngine &engine) : engine_(engine) {}
@@ -85,6 +368,9 @@ public:
                 native_available_ = false;
             }
         }
+        if (!native_available_) {
+            openUdpTransport(cfg);
+        }
         ready_ = true;
         return true;
     }
@@ -97,10 +383,12 @@ public:
             shutdownNativeSession();
         }
         unloadNativeLibrary();
+        udp_.reset();
+        udp_subscribers_.clear();
         ready_ = false;
     }
 
-    bool registerPublisher(PdRuntimeState &state) {
+    bool registerPublisher(PdRuntimeState &state, const uint8_t *payload, size_t size) {
 #if TRDP_HAS_NATIVE_API
         if (native_available_) {
             auto handle = reinterpret_cast<PdPublisherHandle>(state.native_handle);
@@ -109,8 +397,8 @@ public:
                 const TRDP_IP_ADDR_T src_ip = parseEndpointIp(state.source);
                 const TRDP_IP_ADDR_T dest_ip = parseEndpointIp(state.destination);
                 const UINT32 interval = static_cast<UINT32>(std::max(state.cycle_ms, 1)) * 1000U;
-                const UINT8 *data_ptr = state.payload.empty() ? nullptr : state.payload.data();
-                const UINT32 data_len = static_cast<UINT32>(state.payload.size());
+                const UINT8 *data_ptr = size == 0 ? nullptr : payload;
+                const UINT32 data_len = static_cast<UINT32>(size);
                 const TRDP_ERR_T err =
                     tlp_publish_(native_session_, &pub_handle, &state, nullptr, 0u, static_cast<UINT32>(state.id), 0u, 0u,
                                  src_ip, dest_ip, interval, 0u, TRDP_FLAGS_DEFAULT, data_ptr, data_len);
@@ -121,6 +409,10 @@ public:
                 state.native_handle = pub_handle;
             }
         }
+#else
+        (void)state;
+        (void)payload;
+        (void)size;
 #endif
         return true;
     }
@@ -145,6 +437,15 @@ public:
             }
         }
 #endif
+        if (udp_) {
+            udp_subscribers_[static_cast<uint32_t>(state.id)].push_back(UdpSubscriber {&state});
+            const uint32_t group = parseIpv4(TrdpEngine::extractIp(state.destination));
+            if (!udp_->joinGroup(group)) {
+                std::cerr << "Failed to join multicast group " << TrdpEngine::extractIp(state.destination)
+                          << " for comId " << state.id << std::endl;
+                return false;
+            }
+        }
         return true;
     }
 
@@ -168,35 +469,50 @@ public:
                 state.native_handle = listener;
             }
         }
+#else
+        (void)state;
 #endif
         return true;
     }
 
-    bool sendPd(PdRuntimeState &state, const std::vector<uint8_t> &payload) {
-        state.payload = payload;
+    // Sends `payload`, a copy the caller took of state.payload, which this
+    // must not touch: it is only valid under state_mutex_.
+    bool sendPd(PdRuntimeState &state, const uint8_t *payload, size_t size) {
 #if TRDP_HAS_NATIVE_API
         if (native_available_) {
             auto handle = reinterpret_cast<PdPublisherHandle>(state.native_handle);
             if (handle == nullptr) {
-                if (!registerPublisher(state)) {
+                if (!registerPublisher(state, payload, size)) {
                     return false;
                 }
                 handle = reinterpret_cast<PdPublisherHandle>(state.native_handle);
             }
             if (handle != nullptr && tlp_put_ != nullptr && native_session_ != nullptr) {
-                const UINT8 *data_ptr = payload.empty() ? nullptr : payload.data();
-                const TRDP_ERR_T err = tlp_put_(native_session_, handle, data_ptr, static_cast<UINT32>(payload.size()));
+                const UINT8 *data_ptr = size == 0 ? nullptr : payload;
+                const TRDP_ERR_T err = tlp_put_(native_session_, handle, data_ptr, static_cast<UINT32>(size));
                 return err == TRDP_NO_ERR;
             }
             return false;
         }
 #endif
+        if (udp_) {
+            return queueUdpPd(state, payload, size) && udp_->flush() > 0;
+        }
         return true;
     }
 
+    // Cyclic publishing queues frames and sends the whole batch from
+    // iterate(); the native stack sends on its own schedule anyway.
+    bool queuePd(PdRuntimeState &state, const uint8_t *payload, size_t size) {
+        if (udp_) {
+            return queueUdpPd(state, payload, size);
+        }
+        return sendPd(state, payload, size);
+    }
+
+    // The caller has recorded `payload` and `message_id` in `state` under
+    // state_mutex_.
     bool sendMd(MdRuntimeState &state, const std::vector<uint8_t> &payload, int message_id) {
-        state.last_payload = payload;
-        state.last_message_id = message_id;
 #if TRDP_HAS_NATIVE_API
         if (native_available_) {
             if (tlm_notify_ != nullptr && native_session_ != nullptr) {
@@ -214,6 +530,13 @@ public:
             return false;
         }
 #endif
+        if (udp_) {
+            const std::string ip = TrdpEngine::extractIp(state.destination);
+            return udp_->queueMd(TrdpMessageType::kMdNotify, static_cast<uint32_t>(message_id), parseIpv4(ip),
+                                 TrdpEngine::extractPort(state.destination, udp_->mdPort()), payload.data(),
+                                 payload.size()) &&
+                   udp_->flush() > 0;
+        }
         return true;
     }
 
@@ -221,15 +544,54 @@ public:
 #if TRDP_HAS_NATIVE_API
         if (native_available_) {
             if (tlc_process_ != nullptr && native_session_ != nullptr) {
+                if (ready_count_ > 0) {
+                    // Hand over what select() found so the stack reads only
+                    // the sockets that are ready.
+                    INT32 count = ready_count_;
+                    ready_count_ = 0;
+                    const TRDP_ERR_T err = tlc_process_(native_session_, &ready_fds_, &count);
+                    wakeup_ns_ = 0;
+                    return err == TRDP_NO_ERR;
+                }
                 return tlc_process_(native_session_, nullptr, nullptr) == TRDP_NO_ERR;
             }
             return false;
         }
 #endif
+        if (udp_) {
+            udp_->flush();
+            udp_->receive(&TrdpStackAdapter::onUdpFrame, this);
+        }
         return true;
     }
 
     bool ready() const { return ready_; }
+    // A native session whose library lacks tlc_getInterval() is driven by
+    // polling tlc_process() every kStackPollInterval.
+    bool needsPolling() const { return native_available_ && !nativeWaitable(); }
+    // True when the worker should block on the transport's sockets rather
+    // than on the scheduler condition variable.
+    bool hasSockets() const { return udp_ != nullptr || nativeWaitable(); }
+
+    ReceiveClock receiveClock() const {
+        if (udp_) {
+            return ReceiveClock::kKernelTimestamp;
+        }
+        return nativeWaitable() ? ReceiveClock::kSocketWakeup : ReceiveClock::kNone;
+    }
+
+    void waitForTraffic(const std::chrono::steady_clock::time_point *deadline, int wake_fd) {
+        if (udp_) {
+            udp_->wait(deadline, wake_fd);
+            return;
+        }
+#if TRDP_HAS_NATIVE_API
+        waitNative(deadline, wake_fd);
+#else
+        (void)deadline;
+        (void)wake_fd;
+#endif
+    }
 
 private:
 #if TRDP_HAS_NATIVE_API
@@ -253,6 +615,7 @@ private:
                                          const TRDP_MD_CONFIG_T *, const TRDP_PROCESS_CONFIG_T *);
     using CloseSessionFn = TRDP_ERR_T (*)(TRDP_APP_SESSION_T);
     using ProcessFn = TRDP_ERR_T (*)(TRDP_APP_SESSION_T, TRDP_FDS_T *, INT32 *);
+    using GetIntervalFn = TRDP_ERR_T (*)(TRDP_APP_SESSION_T, TRDP_TIME_T *, TRDP_FDS_T *, TRDP_SOCK_T *);
     using PdPublishFn = TRDP_ERR_T (*)(TRDP_APP_SESSION_T, TRDP_PUB_T *, const void *, TRDP_PD_CALLBACK_T, UINT32,
                                        UINT32, UINT32, UINT32, TRDP_IP_ADDR_T, TRDP_IP_ADDR_T, UINT32, UINT32,
                                        TRDP_FLAGS_T, const UINT8 *, UINT32);
@@ -280,7 +643,7 @@ private:
         }
         library_handle_ = dlopen("libtrdp.so", RTLD_LAZY);
         if (library_handle_ == nullptr) {
-            std::cerr << "TRDP native library not found; continuing in simulation mode." << std::endl;
+            std::clog << "TRDP native library not found." << std::endl;
             return false;
         }
 #if TRDP_HAS_NATIVE_API
@@ -294,6 +657,8 @@ private:
         tlp_put_ = reinterpret_cast<PdSendFn>(dlsym(library_handle_, "tlp_put"));
         tlm_notify_ = reinterpret_cast<MdSendFn>(dlsym(library_handle_, "tlm_notify"));
         tlm_addListener_ = reinterpret_cast<MdSubscribeFn>(dlsym(library_handle_, "tlm_addListener"));
+        // Optional: without it the session is polled instead of waited on.
+        tlc_getInterval_ = reinterpret_cast<GetIntervalFn>(dlsym(library_handle_, "tlc_getInterval"));
         return tlc_init_ != nullptr && tlc_openSession_ != nullptr && tlc_closeSession_ != nullptr &&
                tlc_terminate_ != nullptr && tlc_process_ != nullptr && tlp_publish_ != nullptr &&
                tlp_subscribe_ != nullptr && tlp_put_ != nullptr && tlm_notify_ != nullptr &&
@@ -326,6 +691,9 @@ private:
         tlp_put_ = nullptr;
         tlm_notify_ = nullptr;
         tlm_addListener_ = nullptr;
+        tlc_getInterval_ = nullptr;
+        ready_count_ = 0;
+        wakeup_ns_ = 0;
 #else
         tlc_process_ = nullptr;
 #endif
@@ -429,20 +797,23 @@ private:
 
     static void pdNativeCallback(void *ref_con, TRDP_APP_SESSION_T, const TRDP_PD_INFO_T *info, UINT8 *payload,
                                  UINT32 size) {
-        const uint8_t *data_ptr = payload;
-        std::string src_ip;
-        std::string dst_ip;
-        if (info != nullptr) {
-            src_ip = formatIp(info->srcIpAddr);
-            dst_ip = formatIp(info->destIpAddr);
+        int64_t rx_time_ns = 0;
+        if (ref_con != nullptr && info != nullptr && info->resultCode == TRDP_NO_ERR) {
+            auto &adapter = *static_cast<PdRuntimeState *>(ref_con)->engine->stack_adapter_;
+            adapter.recordWakeupLatency();
+            // libtrdp reports no receive time; select() returning is the
+            // closest to it.
+            rx_time_ns = adapter.wakeup_ns_;
         }
-        TrdpEngine::pdCallbackBridge(ref_con, data_ptr, size,
-                                     src_ip.empty() ? nullptr : src_ip.c_str(),
-                                     dst_ip.empty() ? nullptr : dst_ip.c_str());
+        TrdpEngine::pdCallbackBridge(ref_con, payload, size, info != nullptr ? info->srcIpAddr : 0U,
+                                     info != nullptr ? info->destIpAddr : 0U, rx_time_ns);
     }
 
     static void mdNativeCallback(void *ref_con, TRDP_APP_SESSION_T, const TRDP_MD_INFO_T *info, UINT8 *payload,
                                  UINT32 size) {
+        if (ref_con != nullptr && info != nullptr && info->resultCode == TRDP_NO_ERR) {
+            static_cast<MdRuntimeState *>(ref_con)->engine->stack_adapter_->recordWakeupLatency();
+        }
         const uint8_t *data_ptr = payload;
         std::string src_ip;
         std::string dst_ip;
@@ -479,6 +850,61 @@ private:
                static_cast<TRDP_IP_ADDR_T>(octets[0] & 0xFFu);
     }
 
+    void recordWakeupLatency() {
+        if (wakeup_ns_ != 0) {
+            engine_.receive_latency_.record(unixNowNs() - wakeup_ns_);
+        }
+    }
+
+    // Blocks in select() on the session's sockets and `wake_fd` until data
+    // arrives, the stack's next timer (tlc_getInterval()) or `deadline` is
+    // due. Readable sockets are kept for the next iterate().
+    void waitNative(const std::chrono::steady_clock::time_point *deadline, int wake_fd) {
+        TRDP_TIME_T interval {};
+        TRDP_FDS_T fds;
+        FD_ZERO(&fds);
+        TRDP_SOCK_T highest = 0;
+        std::chrono::microseconds timeout = kStackPollInterval;
+        if (tlc_getInterval_(native_session_, &interval, &fds, &highest) == TRDP_NO_ERR) {
+            timeout = std::chrono::seconds(interval.tv_sec) + std::chrono::microseconds(interval.tv_usec);
+        }
+        if (deadline != nullptr) {
+            const auto until = std::chrono::duration_cast<std::chrono::microseconds>(
+                *deadline - std::chrono::steady_clock::now());
+            timeout = std::max(std::chrono::microseconds(0), std::min(timeout, until));
+        }
+        if (wake_fd >= 0) {
+            FD_SET(wake_fd, &fds);
+            highest = std::max<TRDP_SOCK_T>(highest, wake_fd);
+        }
+        timeval tv {};
+        tv.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+        tv.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000000);
+        int ready = ::select(highest + 1, &fds, nullptr, nullptr, &tv);
+        if (ready <= 0) {
+            return;
+        }
+        if (wake_fd >= 0 && FD_ISSET(wake_fd, &fds)) {
+            uint64_t value = 0;
+            [[maybe_unused]] const ssize_t drained = ::read(wake_fd, &value, sizeof(value));
+            FD_CLR(wake_fd, &fds);
+            --ready;
+        }
+        if (ready > 0) {
+            ready_fds_ = fds;
+            ready_count_ = ready;
+            wakeup_ns_ = unixNowNs();
+        }
+    }
+
+    bool nativeWaitable() const {
+        return native_available_ && tlc_getInterval_ != nullptr && native_session_ != nullptr;
+    }
+#else
+    bool nativeWaitable() const { return false; }
+#endif
+
+#if TRDP_HAS_NATIVE_API
     TRDP_IP_ADDR_T parseEndpointIp(const std::string &endpoint) const {
         const std::string ip = TrdpEngine::extractIp(endpoint);
         if (ip.empty()) {
@@ -488,8 +914,83 @@ private:
     }
 #endif
 
+    struct UdpSubscriber {
+        PdRuntimeState *state {nullptr};
+        uint32_t last_src_ip {0};
+        uint32_t last_sequence {0};
+        bool seen {false};
+    };
+
+    void openUdpTransport(const network::NetworkConfig &cfg) {
+        auto transport = std::make_unique<UdpTransport>();
+        std::string error;
+        if (!transport->open(cfg, engine_.io_backend_, error)) {
+            std::cerr << "Built-in UDP transport unavailable (" << error << "); continuing in simulation mode."
+                      << std::endl;
+            return;
+        }
+        if (!transport->fallbackReason().empty()) {
+            std::cerr << "io_uring unavailable (" << transport->fallbackReason() << "); using epoll." << std::endl;
+        }
+        std::clog << "Using the built-in UDP transport (" << udpIoBackendName(transport->backend())
+                  << ") on PD port " << transport->pdPort() << " and MD port " << transport->mdPort() << "."
+                  << std::endl;
+        udp_ = std::move(transport);
+    }
+
+    bool queueUdpPd(PdRuntimeState &state, const uint8_t *payload, size_t size) {
+        const uint32_t dst_ip = parseIpv4(TrdpEngine::extractIp(state.destination));
+        const uint16_t dst_port = TrdpEngine::extractPort(state.destination, udp_->pdPort());
+        return udp_->queuePd(static_cast<uint32_t>(state.id), dst_ip, dst_port, payload, size);
+    }
+
+    // Runs on the worker thread for every valid frame. PD goes to the
+    // subscribers of its ComId; a frame repeating the previous sequence
+    // number of the same source (e.g. looped back twice) is dropped.
+    static void onUdpFrame(void *context, const UdpFrame &received) {
+        auto &self = *static_cast<TrdpStackAdapter *>(context);
+        const TrdpFrame &frame = received.frame;
+        if (isMdMessage(frame.type)) {
+            self.recordKernelLatency(received);
+            char src_text[16];
+            char dst_text[16];
+            self.engine_.handleIncomingMd(static_cast<int>(frame.com_id),
+                                          std::vector<uint8_t>(frame.data, frame.data + frame.size),
+                                          std::string(formatIpv4(received.src_ip, src_text)),
+                                          std::string(formatIpv4(received.dst_ip, dst_text)));
+            return;
+        }
+        if (frame.type != TrdpMessageType::kPdData && frame.type != TrdpMessageType::kPdPullReply) {
+            return;
+        }
+        auto it = self.udp_subscribers_.find(frame.com_id);
+        if (it == self.udp_subscribers_.end()) {
+            return;
+        }
+        for (auto &subscriber : it->second) {
+            if (subscriber.seen && subscriber.last_src_ip == received.src_ip &&
+                subscriber.last_sequence == frame.sequence) {
+                continue;
+            }
+            subscriber.seen = true;
+            subscriber.last_src_ip = received.src_ip;
+            subscriber.last_sequence = frame.sequence;
+            self.recordKernelLatency(received);
+            TrdpEngine::pdCallbackBridge(subscriber.state, frame.data, static_cast<uint32_t>(frame.size),
+                                         received.src_ip, received.dst_ip, received.rx_time_ns);
+        }
+    }
+
+    void recordKernelLatency(const UdpFrame &received) {
+        if (received.rx_time_ns != 0) {
+            engine_.receive_latency_.record(unixNowNs() - received.rx_time_ns);
+        }
+    }
+
     TrdpEngine &engine_;
     network::NetworkConfig network_cfg_;
+    std::unique_ptr<UdpTransport> udp_;
+    std::unordered_map<uint32_t, std::vector<UdpSubscriber>> udp_subscribers_;
 #ifdef __linux__
     void *library_handle_ {nullptr};
     InitFn tlc_init_ {nullptr};
@@ -503,7 +1004,16 @@ private:
     PdSendFn tlp_put_ {nullptr};
     MdSendFn tlm_notify_ {nullptr};
     MdSubscribeFn tlm_addListener_ {nullptr};
+    GetIntervalFn tlc_getInterval_ {nullptr};
 #endif
+#endif
+#if TRDP_HAS_NATIVE_API
+    // Sockets select() reported readable, passed to the next tlc_process().
+    TRDP_FDS_T ready_fds_ {};
+    INT32 ready_count_ {0};
+    // When that select() returned; callbacks of the following tlc_process()
+    // are timed from here. 0 outside such a pass.
+    int64_t wakeup_ns_ {0};
 #endif
     NativeSessionHandle native_session_ {nullptr};
 #if TRDP_HAS_NATIVE_API
@@ -515,12 +1025,32 @@ private:
     bool ready_ {false};
 };
 
-TrdpEngine::TrdpEngine(db::Database *database) : database_(database) {}
+TrdpEngine::TrdpEngine(db::Database *database, TrdpEngineOptions options)
+    : outgoing_md_(std::make_unique<MdHistory>(options.md_history)),
+      incoming_md_(std::make_unique<MdHistory>(options.md_history)),
+      io_backend_(options.io_backend),
+      database_(database),
+      log_pd_packets_(options.log_pd_packets) {
+    if (database_ != nullptr) {
+        log_writer_ = std::make_unique<util::TrdpLogWriter>(*database_, options.log_writer);
+        if (options.rollup.enabled) {
+            rollup_ = std::make_unique<util::TrafficRollup>(*database_, options.rollup);
+        }
+    }
+#ifdef __linux__
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
 
 TrdpEngine::~TrdpEngine() {
     stop();
     std::lock_guard<std::mutex> lock(engine_mutex_);
     teardownStackLocked();
+#ifdef __linux__
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+    }
+#endif
 }
 
 bool TrdpEngine::loadConfiguration(const config::TrdpConfig &config, const network::NetworkConfig &net_cfg) {
@@ -531,7 +1061,11 @@ bool TrdpEngine::loadConfiguration(const config::TrdpConfig &config, const netwo
     }
     teardownStackLocked();
     loaded_config_ = config;
-    network_config_ = net_cfg;
+    {
+        // Also read by API threads under state_mutex_ (sendMdMessage()).
+        std::lock_guard<std::mutex> state_lock(state_mutex_);
+        network_config_ = net_cfg;
+    }
     rebuildStateFromConfig(config.xml_content);
     if (!stack_adapter_) {
         stack_adapter_ = std::make_unique<TrdpStackAdapter>(*this);
@@ -576,55 +1110,241 @@ void TrdpEngine::stop() {
     stack_ready_ = false;
 }
 
-std::vector<PdMessage> TrdpEngine::listOutgoingPd() const {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    return outgoing_pd_;
+std::vector<PdMessagePtr> TrdpEngine::listOutgoingPd() const {
+    return snapshotTable(std::atomic_load(&outgoing_pd_table_));
 }
 
-std::vector<PdMessage> TrdpEngine::listIncomingPd() const {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    return incoming_pd_;
+std::vector<PdMessagePtr> TrdpEngine::listIncomingPd() const {
+    return snapshotTable(std::atomic_load(&incoming_pd_table_));
+}
+
+PdMessagePtr TrdpEngine::findOutgoingPd(int msg_id) const {
+    auto slot = findSlot(std::atomic_load(&outgoing_pd_table_), msg_id);
+    if (!slot) {
+        return nullptr;
+    }
+    return readSlot(*slot);
+}
+
+PdDelta TrdpEngine::outgoingPdSince(uint64_t version) const {
+    return changesSince(std::atomic_load(&outgoing_pd_table_), version);
+}
+
+PdDelta TrdpEngine::incomingPdSince(uint64_t version) const {
+    return changesSince(std::atomic_load(&incoming_pd_table_), version);
 }
 
 void TrdpEngine::updateOutgoingPdPayload(int msg_id, const std::vector<uint8_t> &payload) {
     std::shared_ptr<PdRuntimeState> runtime;
+    uint64_t version = 0;
+    std::string src_ip;
+    std::string dst_ip;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        auto slot = findSlot(std::atomic_load(&outgoing_pd_table_), msg_id);
+        if (!slot) {
+            throw std::runtime_error("PD message not found");
+        }
+        if (payload.size() > slot->capacity) {
+            throw std::runtime_error("PD payload exceeds " + std::to_string(slot->capacity) + " bytes");
+        }
+        storeSlot(*slot, payload.data(), payload.size(), slot->src_ip.load(std::memory_order_relaxed),
+                  slot->dst_ip.load(std::memory_order_relaxed));
+        auto runtime_it = pd_runtime_.find(msg_id);
+        if (runtime_it == pd_runtime_.end()) {
+            throw std::runtime_error("Runtime PD state missing");
+        }
+        runtime = runtime_it->second;
+        auto &buffer = runtime->payload;
+        std::fill(std::copy(payload.begin(), payload.end(), buffer.begin()), buffer.end(), 0);
+        runtime->payload_size = payload.size();
+        version = ++runtime->put_version;
+        if (runtime->is_outgoing && runtime->cycle_ms > 0) {
+            // The update is sent right away below, so restart the cadence
+            // from now rather than publishing twice in a row.
+            armPublisherLocked(*runtime, std::chrono::steady_clock::now() +
+                                             std::chrono::milliseconds(runtime->cycle_ms));
+            runtime->rearmed = true;
+        }
+        src_ip = extractIp(runtime->source);
+        dst_ip = extractIp(runtime->destination);
+    }
+    putOutgoingPd(*runtime, version, payload.data(), payload.size(), src_ip, dst_ip);
+}
+
+void TrdpEngine::updateOutgoingPdFields(int msg_id, const std::vector<PdFieldUpdate> &updates) {
+    std::shared_ptr<PdRuntimeState> runtime;
+    std::vector<uint8_t> payload;
+    uint64_t version = 0;
     std::string src_ip;
     std::string dst_ip;
     {
         std::lock_guard<std::mutex> lock(state_mutex_);
-        auto idx = outgoing_pd_index_.find(msg_id);
-        if (idx == outgoing_pd_index_.end()) {
+        auto slot = findSlot(std::atomic_load(&outgoing_pd_table_), msg_id);
+        if (!slot) {
             throw std::runtime_error("PD message not found");
         }
-        auto &msg = outgoing_pd_[idx->second];
-        msg.payload = payload;
-        msg.timestamp = nowIso8601();
+        if (!slot->dataset) {
+            throw std::invalid_argument("PD message has no dataset layout");
+        }
         auto runtime_it = pd_runtime_.find(msg_id);
         if (runtime_it == pd_runtime_.end()) {
             throw std::runtime_error("Runtime PD state missing");
         }
         runtime = runtime_it->second;
-        runtime->payload = payload;
-        runtime->next_cycle = std::chrono::steady_clock::now();
+
+        std::vector<FieldPatch> patches;
+        patches.reserve(updates.size());
+        for (const auto &update : updates) {
+            patches.push_back(encodeFieldUpdate(*slot->dataset, update));
+        }
+        // Only the addressed bytes are written, in place and under
+        // state_mutex_, so concurrent updates of different fields never
+        // overwrite each other. Senders work on copies (see putOutgoingPd()
+        // and runEventLoop()).
+        runtime->payload_size = std::max(runtime->payload_size, slot->dataset->size);
+        std::vector<std::pair<size_t, size_t>> ranges;
+        ranges.reserve(patches.size());
+        for (const auto &patch : patches) {
+            std::memcpy(runtime->payload.data() + patch.offset, patch.bytes.data(), patch.bytes.size());
+            ranges.emplace_back(patch.offset, patch.bytes.size());
+        }
+        patchSlot(*slot, runtime->payload.data(), runtime->payload_size, ranges);
+        if (runtime->cycle_ms > 0) {
+            return;
+        }
+        payload.assign(runtime->payload.data(), runtime->payload.data() + runtime->payload_size);
+        version = ++runtime->put_version;
         src_ip = extractIp(runtime->source);
         dst_ip = extractIp(runtime->destination);
     }
-    if (stack_ready_.load() && stack_adapter_ && runtime) {
-        stack_adapter_->sendPd(*runtime, payload);
+    putOutgoingPd(*runtime, version, payload.data(), payload.size(), src_ip, dst_ip);
+}
+
+void TrdpEngine::putOutgoingPd(PdRuntimeState &state, uint64_t version, const uint8_t *payload, size_t size,
+                               const std::string &src_ip, const std::string &dst_ip) {
+    // Concurrent updates may reach this in any order; a copy older than one
+    // already sent is dropped, since the newer copy contains its changes.
+    std::lock_guard<std::mutex> lock(state.put_mutex);
+    if (version < state.put_sent) {
+        return;
+    }
+    state.put_sent = version;
+    {
+        std::shared_lock<std::shared_mutex> stack_lock(stack_mutex_);
+        if (stack_ready_.load() && stack_adapter_ && !stack_adapter_->sendPd(state, payload, size)) {
+            put_errors_.add();
+        }
     }
     if (!src_ip.empty() || !dst_ip.empty()) {
-        logTrdpEvent("OUT", "PD", msg_id, src_ip, dst_ip, payload);
+        logTrdpEvent("OUT", "PD", state.id, src_ip, dst_ip, payload, size);
     }
 }
 
-std::vector<MdMessage> TrdpEngine::listOutgoingMd() const {
+void TrdpEngine::setOutgoingPdGenerators(int msg_id, const std::vector<GeneratorSpec> &specs) {
     std::lock_guard<std::mutex> lock(state_mutex_);
-    return outgoing_md_;
+    auto slot = findSlot(std::atomic_load(&outgoing_pd_table_), msg_id);
+    if (!slot) {
+        throw std::runtime_error("PD message not found");
+    }
+    auto runtime_it = pd_runtime_.find(msg_id);
+    if (runtime_it == pd_runtime_.end()) {
+        throw std::runtime_error("Runtime PD state missing");
+    }
+    auto &runtime = *runtime_it->second;
+    if (!specs.empty() && runtime.cycle_ms <= 0) {
+        throw std::invalid_argument("Generators need a cyclic PD telegram");
+    }
+    std::vector<FieldGenerator> generators;
+    generators.reserve(specs.size());
+    for (const auto &spec : specs) {
+        generators.emplace_back(slot->dataset, spec);
+    }
+    runtime.generators = std::move(generators);
+    runtime.generator_ranges.clear();
+    runtime.generator_ranges.reserve(runtime.generators.size());
+    runtime.generator_cycle = 0;
 }
 
-std::vector<MdMessage> TrdpEngine::listIncomingMd() const {
+std::vector<GeneratorSpec> TrdpEngine::outgoingPdGenerators(int msg_id) const {
     std::lock_guard<std::mutex> lock(state_mutex_);
-    return incoming_md_;
+    auto runtime_it = pd_runtime_.find(msg_id);
+    if (runtime_it == pd_runtime_.end()) {
+        throw std::runtime_error("PD message not found");
+    }
+    std::vector<GeneratorSpec> specs;
+    specs.reserve(runtime_it->second->generators.size());
+    for (const auto &generator : runtime_it->second->generators) {
+        specs.push_back(generator.spec());
+    }
+    return specs;
+}
+
+util::TrdpLogWriterStats TrdpEngine::logWriterStats() const {
+    if (!log_writer_) {
+        return {};
+    }
+    return log_writer_->stats();
+}
+
+TrdpEngineMetrics TrdpEngine::metrics() const {
+    auto read = [](const TrafficCounters &counters) {
+        return TrafficCounts {counters.packets.value(), counters.bytes.value()};
+    };
+    TrdpEngineMetrics result;
+    result.pd_in = read(pd_in_);
+    result.pd_out = read(pd_out_);
+    result.md_in = read(md_in_);
+    result.md_out = read(md_out_);
+    result.put_errors = put_errors_.value();
+    result.process_errors = process_errors_.value();
+    result.scheduler_lateness = scheduler_lateness_.snapshot();
+    return result;
+}
+
+std::vector<PdTimingStats> TrdpEngine::pdTimingStats() const {
+    std::vector<std::shared_ptr<PdRuntimeState>> states;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        states.reserve(pd_runtime_.size() + pd_subscriber_runtime_.size());
+        for (const auto &entry : pd_runtime_) {
+            states.push_back(entry.second);
+        }
+        std::sort(states.begin(), states.end(), [](const auto &a, const auto &b) { return a->id < b->id; });
+        states.insert(states.end(), pd_subscriber_runtime_.begin(), pd_subscriber_runtime_.end());
+    }
+    // Histogram copies are taken outside the lock; the states stay alive
+    // through the shared pointers even if the configuration is reloaded.
+    std::vector<PdTimingStats> result;
+    result.reserve(states.size());
+    for (const auto &state : states) {
+        PdTimingStats stats;
+        stats.id = state->id;
+        stats.name = state->name;
+        stats.is_outgoing = state->is_outgoing;
+        stats.cycle_time_ms = state->cycle_ms;
+        if (state->interval_deviation) {
+            stats.interval_deviation = state->interval_deviation->snapshot();
+        }
+        if (state->inter_arrival) {
+            stats.inter_arrival = state->inter_arrival->snapshot();
+        }
+        if (state->update_latency) {
+            stats.update_latency = state->update_latency->snapshot();
+        }
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+std::vector<MdMessage> TrdpEngine::listOutgoingMd(int since_id, size_t limit) const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return outgoing_md_->since(since_id, limit);
+}
+
+std::vector<MdMessage> TrdpEngine::listIncomingMd(int since_id, size_t limit) const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return incoming_md_->since(since_id, limit);
 }
 
 MdMessage TrdpEngine::sendMdMessage(const std::string &destination, const std::vector<uint8_t> &payload) {
@@ -633,15 +1353,15 @@ MdMessage TrdpEngine::sendMdMessage(const std::string &destination, const std::v
 
 MdMessage TrdpEngine::sendMdMessage(const std::string &destination, int msg_id,
                                     const std::vector<uint8_t> &payload) {
-    if (!network_config_.has_value()) {
-        throw std::runtime_error("Network configuration not loaded");
-    }
     MdMessage message;
     std::shared_ptr<MdRuntimeState> runtime;
     bool requires_registration = false;
     auto target = sanitizeEndpoint(destination);
     {
         std::lock_guard<std::mutex> lock(state_mutex_);
+        if (!network_config_.has_value()) {
+            throw std::runtime_error("Network configuration not loaded");
+        }
         for (auto &entry : md_runtime_) {
             if (entry.second && sanitizeEndpoint(entry.second->destination) == target) {
                 runtime = entry.second;
@@ -670,37 +1390,41 @@ MdMessage TrdpEngine::sendMdMessage(const std::string &destination, int msg_id,
         message.destination = runtime->destination;
         message.payload = payload;
         message.timestamp = nowIso8601();
-        outgoing_md_index_[message.id] = outgoing_md_.size();
-        outgoing_md_.push_back(message);
+        outgoing_md_->push(message);
     }
     if (!runtime) {
         throw std::runtime_error("Failed to allocate MD runtime state");
     }
-    if (requires_registration && stack_ready_.load() && stack_adapter_) {
-        stack_adapter_->registerMdEndpoint(*runtime);
-    }
-    if (stack_ready_.load() && stack_adapter_) {
-        stack_adapter_->sendMd(*runtime, payload, message.msg_id);
+    {
+        std::shared_lock<std::shared_mutex> stack_lock(stack_mutex_);
+        if (stack_ready_.load() && stack_adapter_) {
+            if (requires_registration) {
+                stack_adapter_->registerMdEndpoint(*runtime);
+            }
+            stack_adapter_->sendMd(*runtime, payload, message.msg_id);
+        }
     }
     logTrdpEvent("OUT", "MD", message.msg_id, extractIp(runtime->source), extractIp(runtime->destination),
-                 payload);
+                 payload.data(), payload.size());
     return message;
 }
 
 bool TrdpEngine::initializeStackLocked(const network::NetworkConfig &net_cfg) {
+    std::unique_lock<std::shared_mutex> stack_lock(stack_mutex_);
     if (!stack_adapter_) {
         stack_adapter_ = std::make_unique<TrdpStackAdapter>(*this);
     }
     if (!stack_adapter_->initialize(net_cfg)) {
         return false;
     }
+    receive_latency_.reset();
+    receive_clock_.store(stack_adapter_->receiveClock(), std::memory_order_relaxed);
+    std::lock_guard<std::mutex> state_lock(state_mutex_);
     for (auto &entry : pd_runtime_) {
-        auto &state = *entry.second;
-        if (state.is_outgoing) {
-            stack_adapter_->registerPublisher(state);
-        } else {
-            stack_adapter_->registerSubscriber(state);
-        }
+        stack_adapter_->registerPublisher(*entry.second, entry.second->payload.data(), entry.second->payload_size);
+    }
+    for (auto &state : pd_subscriber_runtime_) {
+        stack_adapter_->registerSubscriber(*state);
     }
     for (auto &entry : md_runtime_) {
         stack_adapter_->registerMdEndpoint(*entry.second);
@@ -709,13 +1433,24 @@ bool TrdpEngine::initializeStackLocked(const network::NetworkConfig &net_cfg) {
 }
 
 void TrdpEngine::teardownStackLocked() {
+    // API threads send under the shared lock, so once this holds it none is
+    // inside the adapter, and none enters it again before the next
+    // initialization.
+    std::unique_lock<std::shared_mutex> stack_lock(stack_mutex_);
+    stack_ready_ = false;
     if (stack_adapter_) {
         stack_adapter_->shutdown();
     }
-    stack_ready_ = false;
+    receive_clock_.store(ReceiveClock::kNone, std::memory_order_relaxed);
 }
 
-bool TrdpEngine::buildStateFromTrdpConfig(const config::TrdpXmlConfig &config_data) {
+bool TrdpEngine::buildStateFromTrdpConfig(const config::TrdpXmlConfig &config_data, PdTable &outgoing,
+                                          PdTable &incoming) {
+    std::vector<std::string> dataset_errors;
+    const auto datasets = compileDatasets(config_data.datasets, &dataset_errors);
+    for (const auto &error : dataset_errors) {
+        std::cerr << "TRDP dataset ignored: " << error << std::endl;
+    }
     bool added = false;
     for (const auto &iface : config_data.interfaces) {
         for (const auto &telegram : iface.telegrams) {
@@ -729,20 +1464,23 @@ bool TrdpEngine::buildStateFromTrdpConfig(const config::TrdpXmlConfig &config_da
                 message.name = !telegram.name.empty() ? telegram.name : "PD-" + std::to_string(message.id);
                 message.cycle_time_ms = telegram.cycle_time_ms;
                 message.payload = telegram.payload;
-                message.timestamp = nowIso8601();
+                message.dataset = findDataset(datasets, telegram.dataset);
+                const bool is_outgoing = telegram.direction == TrdpTelegramDirection::kPublisher ||
+                                         telegram.direction == TrdpTelegramDirection::kResponder;
+                if (is_outgoing && message.payload.empty() && message.dataset) {
+                    // Publish an all-zero dataset until the user sets values.
+                    message.payload.assign(message.dataset->size, 0);
+                }
 
                 auto runtime = std::make_shared<PdRuntimeState>();
                 runtime->engine = this;
                 runtime->id = message.id;
                 runtime->name = message.name;
-                runtime->is_outgoing =
-                    telegram.direction == TrdpTelegramDirection::kPublisher ||
-                    telegram.direction == TrdpTelegramDirection::kResponder;
+                runtime->is_outgoing = is_outgoing;
                 runtime->cycle_ms = telegram.cycle_time_ms > 0 ? telegram.cycle_time_ms : telegram.timeout_ms;
                 runtime->destination = sanitizeEndpoint(telegram.destination);
                 runtime->source = sanitizeEndpoint(telegram.source);
-                runtime->payload = telegram.payload;
-                runtime->next_cycle = std::chrono::steady_clock::now();
+                runtime->createTimingHistograms();
 
                 if (runtime->destination.empty() && network_config_) {
                     runtime->destination = network_config_->local_ip + ":" +
@@ -753,13 +1491,16 @@ bool TrdpEngine::buildStateFromTrdpConfig(const config::TrdpXmlConfig &config_da
                                       std::to_string(network_config_->pd_port);
                 }
 
-                pd_runtime_[runtime->id] = runtime;
+                const uint32_t src_ip = parseIpv4(extractIp(runtime->source));
+                const uint32_t dst_ip = parseIpv4(extractIp(runtime->destination));
                 if (runtime->is_outgoing) {
-                    outgoing_pd_index_[message.id] = outgoing_pd_.size();
-                    outgoing_pd_.push_back(message);
+                    runtime->slot = appendSlot(outgoing, message, pdSlotCapacity(message, true), src_ip, dst_ip);
+                    runtime->allocatePayload(message.payload, runtime->slot->capacity);
+                    pd_runtime_[runtime->id] = runtime;
+                    armPublisherLocked(*runtime, std::chrono::steady_clock::now());
                 } else {
-                    incoming_pd_index_[message.id] = incoming_pd_.size();
-                    incoming_pd_.push_back(message);
+                    runtime->slot = appendSlot(incoming, message, pdSlotCapacity(message, false), src_ip, dst_ip);
+                    pd_subscriber_runtime_.push_back(runtime);
                 }
                 added = true;
             } else {
@@ -791,37 +1532,40 @@ bool TrdpEngine::buildStateFromTrdpConfig(const config::TrdpXmlConfig &config_da
 void TrdpEngine::rebuildStateFromConfig(const std::string &xml_content) {
     std::lock_guard<std::mutex> lock(state_mutex_);
     clearAllStateLocked();
+    auto outgoing = std::make_shared<PdTable>();
+    auto incoming = std::make_shared<PdTable>();
+    outgoing->base_version = pd_version_.load(std::memory_order_relaxed);
+    incoming->base_version = outgoing->base_version;
+    auto publish_tables = [&]() {
+        std::atomic_store(&outgoing_pd_table_, std::shared_ptr<const PdTable>(outgoing));
+        std::atomic_store(&incoming_pd_table_, std::shared_ptr<const PdTable>(incoming));
+    };
     bool trdp_loaded = false;
     if (config::looksLikeTrdpXml(xml_content)) {
         std::string error;
         if (auto parsed = config::parseTrdpXmlConfig(xml_content, &error)) {
-            trdp_loaded = buildStateFromTrdpConfig(*parsed);
+            trdp_loaded = buildStateFromTrdpConfig(*parsed, *outgoing, *incoming);
         } else if (!error.empty()) {
             std::cerr << "TRDP XML parse error: " << error << std::endl;
         }
     }
     if (trdp_loaded) {
+        publish_tables();
         return;
     }
-    const auto pd_elements = extractElements(xml_content, "pd");
-    for (const auto &element : pd_elements) {
+    const xml::XmlDocument doc(xml_content);
+    for (const xml::XmlNode *element : doc.find("pd")) {
         PdMessage message;
         message.id = next_pd_id_++;
-        auto it_name = element.attributes.find("name");
-        message.name = it_name != element.attributes.end() ? it_name->second : "PD-" + std::to_string(message.id);
-        auto it_cycle = element.attributes.find("cycle");
-        message.cycle_time_ms = it_cycle != element.attributes.end() ? safeStoi(it_cycle->second) : 0;
-        std::string payload_str;
-        if (auto attr_payload = element.attributes.find("payload"); attr_payload != element.attributes.end()) {
-            payload_str = attr_payload->second;
-        } else {
-            payload_str = element.body;
-        }
-        message.payload = parseHexPayload(payload_str);
-        message.timestamp = nowIso8601();
+        const auto *name_attr = doc.findAttribute(*element, "name");
+        message.name = name_attr != nullptr ? std::string(name_attr->value) : "PD-" + std::to_string(message.id);
+        const auto *cycle_attr = doc.findAttribute(*element, "cycle");
+        message.cycle_time_ms = cycle_attr != nullptr ? safeStoi(std::string(cycle_attr->value)) : 0;
+        const auto *payload_attr = doc.findAttribute(*element, "payload");
+        message.payload = parseHexPayload(payload_attr != nullptr ? payload_attr->value : element->body);
         std::string direction = "outgoing";
-        if (auto dir_attr = element.attributes.find("direction"); dir_attr != element.attributes.end()) {
-            direction = toLowerCopy(dir_attr->second);
+        if (const auto *dir_attr = doc.findAttribute(*element, "direction")) {
+            direction = toLowerCopy(std::string(dir_attr->value));
         }
         bool is_outgoing = direction != "in" && direction != "incoming" && direction != "subscriber";
         auto runtime = std::make_shared<PdRuntimeState>();
@@ -830,165 +1574,252 @@ void TrdpEngine::rebuildStateFromConfig(const std::string &xml_content) {
         runtime->name = message.name;
         runtime->is_outgoing = is_outgoing;
         runtime->cycle_ms = message.cycle_time_ms;
-        runtime->payload = message.payload;
-        runtime->next_cycle = std::chrono::steady_clock::now();
-        if (auto dst = element.attributes.find("destination"); dst != element.attributes.end()) {
-            runtime->destination = sanitizeEndpoint(dst->second);
+        runtime->createTimingHistograms();
+        if (const auto *dst = doc.findAttribute(*element, "destination")) {
+            runtime->destination = sanitizeEndpoint(std::string(dst->value));
         }
         if (runtime->destination.empty() && network_config_) {
             runtime->destination = network_config_->local_ip + ":" + std::to_string(network_config_->pd_port);
         }
-        if (auto src = element.attributes.find("source"); src != element.attributes.end()) {
-            runtime->source = sanitizeEndpoint(src->second);
+        if (const auto *src = doc.findAttribute(*element, "source")) {
+            runtime->source = sanitizeEndpoint(std::string(src->value));
         }
         if (runtime->source.empty() && network_config_) {
             runtime->source = network_config_->local_ip + ":" + std::to_string(network_config_->pd_port);
         }
-        pd_runtime_[message.id] = runtime;
+        const uint32_t src_ip = parseIpv4(extractIp(runtime->source));
+        const uint32_t dst_ip = parseIpv4(extractIp(runtime->destination));
         if (is_outgoing) {
-            outgoing_pd_index_[message.id] = outgoing_pd_.size();
-            outgoing_pd_.push_back(message);
+            runtime->slot = appendSlot(*outgoing, message, pdSlotCapacity(message, true), src_ip, dst_ip);
+            runtime->allocatePayload(message.payload, runtime->slot->capacity);
+            pd_runtime_[message.id] = runtime;
+            armPublisherLocked(*runtime, std::chrono::steady_clock::now());
         } else {
-            incoming_pd_index_[message.id] = incoming_pd_.size();
-            incoming_pd_.push_back(message);
+            runtime->slot = appendSlot(*incoming, message, pdSlotCapacity(message, false), src_ip, dst_ip);
+            pd_subscriber_runtime_.push_back(runtime);
         }
     }
-    const auto md_elements = extractElements(xml_content, "md");
-    for (const auto &element : md_elements) {
+    for (const xml::XmlNode *element : doc.find("md")) {
         auto runtime = std::make_shared<MdRuntimeState>();
         runtime->engine = this;
         runtime->runtime_id = next_md_runtime_id_++;
-        if (auto name_attr = element.attributes.find("name"); name_attr != element.attributes.end()) {
-            runtime->name = name_attr->second;
+        if (const auto *name_attr = doc.findAttribute(*element, "name")) {
+            runtime->name = std::string(name_attr->value);
         }
-        if (auto dst = element.attributes.find("destination"); dst != element.attributes.end()) {
-            runtime->destination = sanitizeEndpoint(dst->second);
+        if (const auto *dst = doc.findAttribute(*element, "destination")) {
+            runtime->destination = sanitizeEndpoint(std::string(dst->value));
         }
         if (runtime->destination.empty() && network_config_) {
             runtime->destination = network_config_->local_ip + ":" + std::to_string(network_config_->md_port);
         }
-        if (auto src = element.attributes.find("source"); src != element.attributes.end()) {
-            runtime->source = sanitizeEndpoint(src->second);
+        if (const auto *src = doc.findAttribute(*element, "source")) {
+            runtime->source = sanitizeEndpoint(std::string(src->value));
         }
         if (runtime->source.empty() && network_config_) {
             runtime->source = network_config_->local_ip + ":" + std::to_string(network_config_->md_port);
         }
         md_runtime_[runtime->runtime_id] = runtime;
     }
+    publish_tables();
 }
 
 
 void TrdpEngine::runEventLoop() {
+    std::vector<PdScheduler::DueEntry> due_entries;
+    std::vector<std::shared_ptr<PdRuntimeState>> due;
     while (!stop_worker_.load()) {
-        std::vector<std::shared_ptr<PdRuntimeState>> due;
+        due_entries.clear();
+        due.clear();
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
             const auto now = std::chrono::steady_clock::now();
-            for (auto &entry : pd_runtime_) {
-                auto &state = *entry.second;
-                if (!state.is_outgoing || state.cycle_ms <= 0) {
+            pd_scheduler_.collectDue(now, due_entries);
+            for (const auto &entry : due_entries) {
+                scheduler_lateness_.record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.deadline).count());
+                auto it = pd_runtime_.find(entry.id);
+                if (it == pd_runtime_.end() || !it->second->is_outgoing || it->second->cycle_ms <= 0) {
                     continue;
                 }
-                if (now >= state.next_cycle) {
-                    due.push_back(entry.second);
-                    scheduleNextCycle(state);
+                PdRuntimeState &runtime = *it->second;
+                if (std::exchange(runtime.rearmed, false)) {
+                    // The gap since the previous cyclic send includes the
+                    // restart, so it is not a deviation from the cycle.
+                    runtime.last_event.reset();
                 }
+                if (!runtime.generators.empty()) {
+                    applyGeneratorsLocked(runtime);
+                }
+                std::copy_n(runtime.payload.begin(), runtime.payload_size, runtime.send_buffer.begin());
+                runtime.send_size = runtime.payload_size;
+                due.push_back(it->second);
+                scheduleNextCycle(*it->second, now);
             }
         }
         for (const auto &state_ptr : due) {
             if (!stack_ready_.load() || !stack_adapter_) {
                 continue;
             }
-            stack_adapter_->sendPd(*state_ptr, state_ptr->payload);
+            const auto sent = std::chrono::steady_clock::now();
+            if (state_ptr->last_event) {
+                const auto deviation = (sent - *state_ptr->last_event) - std::chrono::milliseconds(state_ptr->cycle_ms);
+                state_ptr->interval_deviation->record(
+                    std::abs(std::chrono::duration_cast<std::chrono::nanoseconds>(deviation).count()));
+            }
+            state_ptr->last_event = sent;
+            if (!stack_adapter_->queuePd(*state_ptr, state_ptr->send_buffer.data(), state_ptr->send_size)) {
+                put_errors_.add();
+            }
             logTrdpEvent("OUT", "PD", state_ptr->id, extractIp(state_ptr->source),
-                         extractIp(state_ptr->destination), state_ptr->payload);
+                         extractIp(state_ptr->destination), state_ptr->send_buffer.data(), state_ptr->send_size);
             std::lock_guard<std::mutex> lock(state_mutex_);
-            auto idx = outgoing_pd_index_.find(state_ptr->id);
-            if (idx != outgoing_pd_index_.end()) {
-                outgoing_pd_[idx->second].timestamp = nowIso8601();
+            if (state_ptr->slot) {
+                touchSlot(*state_ptr->slot);
             }
         }
-        if (stack_ready_.load() && stack_adapter_) {
-            stack_adapter_->iterate();
+        if (stack_ready_.load() && stack_adapter_ && !stack_adapter_->iterate()) {
+            process_errors_.add();
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        waitForNextDeadline();
     }
 }
 
-void TrdpEngine::scheduleNextCycle(PdRuntimeState &state) {
-    if (state.cycle_ms <= 0) {
-        state.next_cycle = std::chrono::steady_clock::now() + std::chrono::hours(24);
+void TrdpEngine::waitForNextDeadline() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    auto deadline = pd_scheduler_.nextDeadline();
+    if (stack_ready_.load() && stack_adapter_ && stack_adapter_->hasSockets() && wake_fd_ >= 0) {
+        // Sleep in the kernel until traffic arrives, the next cycle is due or
+        // wakeWorkerLocked() signals wake_fd_; no periodic polling needed.
+        if (stop_worker_.load() || scheduler_dirty_) {
+            scheduler_dirty_ = false;
+            return;
+        }
+        lock.unlock();
+        stack_adapter_->waitForTraffic(deadline ? &*deadline : nullptr, wake_fd_);
+        lock.lock();
+        scheduler_dirty_ = false;
         return;
     }
-    state.next_cycle = std::chrono::steady_clock::now() + std::chrono::milliseconds(state.cycle_ms);
+    if (stack_ready_.load() && stack_adapter_ && stack_adapter_->needsPolling()) {
+        const auto poll_deadline = std::chrono::steady_clock::now() + kStackPollInterval;
+        if (!deadline || poll_deadline < *deadline) {
+            deadline = poll_deadline;
+        }
+    }
+    auto wake = [this]() { return stop_worker_.load() || scheduler_dirty_; };
+    if (deadline) {
+        scheduler_cv_.wait_until(lock, *deadline, wake);
+    } else {
+        scheduler_cv_.wait(lock, wake);
+    }
+    scheduler_dirty_ = false;
 }
 
-void TrdpEngine::handleIncomingPd(int msg_id, const std::vector<uint8_t> &payload, const std::string &src_ip,
-                                  const std::string &dst_ip) {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    auto idx = incoming_pd_index_.find(msg_id);
-    if (idx == incoming_pd_index_.end()) {
-        PdMessage msg;
-        msg.id = msg_id;
-        msg.name = "PD-" + std::to_string(msg_id);
-        msg.payload = payload;
-        msg.timestamp = nowIso8601();
-        incoming_pd_index_[msg_id] = incoming_pd_.size();
-        incoming_pd_.push_back(msg);
-    } else {
-        auto &msg = incoming_pd_[idx->second];
-        msg.payload = payload;
-        msg.timestamp = nowIso8601();
+void TrdpEngine::armPublisherLocked(PdRuntimeState &state, PdScheduler::TimePoint first_deadline) {
+    if (!state.is_outgoing || state.cycle_ms <= 0) {
+        return;
     }
-    logTrdpEvent("IN", "PD", msg_id, src_ip, dst_ip, payload);
+    state.next_cycle = first_deadline;
+    pd_scheduler_.schedule(state.id, state.next_cycle);
+    wakeWorkerLocked();
 }
 
-void TrdpEngine::handleIncomingMd(int msg_id, const std::vector<uint8_t> &payload, const std::string &src_ip,
-                                  const std::string &dst_ip) {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    MdMessage message;
-    message.id = next_md_id_++;
-    if (msg_id <= 0) {
-        msg_id = next_md_msg_id_++;
-    }
-    message.msg_id = msg_id;
-    message.source = src_ip;
-    message.destination = dst_ip;
-    message.payload = payload;
-    message.timestamp = nowIso8601();
-    incoming_md_index_[message.id] = incoming_md_.size();
-    incoming_md_.push_back(message);
-    logTrdpEvent("IN", "MD", message.msg_id, src_ip, dst_ip, payload);
+void TrdpEngine::wakeWorkerLocked() {
+    scheduler_dirty_ = true;
+    scheduler_cv_.notify_all();
+#ifdef __linux__
+    if (wake_fd_ >= 0) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+    }
+#endif
+}
+
+void TrdpEngine::scheduleNextCycle(PdRuntimeState &state, PdScheduler::TimePoint now) {
+    // Advance from the previous deadline so the cadence does not drift by the
+    // wake-up latency of each cycle.
+    state.next_cycle = PdScheduler::advance(state.next_cycle, std::chrono::milliseconds(state.cycle_ms), now);
+    pd_scheduler_.schedule(state.id, state.next_cycle);
 }
 
-void TrdpEngine::logTrdpEvent(const std::string &direction, const std::string &type, int msg_id,
-                              const std::string &src_ip, const std::string &dst_ip,
-                              const std::vector<uint8_t> &payload) {
-    if (database_ == nullptr) {
+void TrdpEngine::applyGeneratorsLocked(PdRuntimeState &state) {
+    if (!state.slot || !state.slot->dataset) {
         return;
     }
-    auto *db = database_->handle();
-    if (db == nullptr) {
-        return;
+    state.payload_size = std::max(state.payload_size, state.slot->dataset->size);
+    state.generator_ranges.clear();
+    const double seconds = static_cast<double>(state.generator_cycle) * state.cycle_ms / 1000.0;
+    for (auto &generator : state.generators) {
+        state.generator_ranges.push_back(generator.apply(state.payload.data(), state.generator_cycle, seconds));
     }
-    sqlite3_stmt *stmt = nullptr;
-    const char *sql =
-        "INSERT INTO trdp_logs (direction, type, msg_id, src_ip, dst_ip, payload) VALUES (?, ?, ?, ?, ?, ?);";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    ++state.generator_cycle;
+    patchSlot(*state.slot, state.payload.data(), state.payload_size, state.generator_ranges);
+}
+
+void TrdpEngine::handleIncomingPd(PdRuntimeState &state, const uint8_t *payload, size_t size, uint32_t src_ip,
+                                  uint32_t dst_ip, int64_t rx_time_ns) {
+    // Each subscriber slot has a single writer (the stack callback thread),
+    // so it is updated in place without state_mutex_. Once every telegram
+    // has been received, this path, including logging and rollups, does not
+    // allocate; BM_CheckHandleIncomingPdAllocations checks that.
+    if (!state.slot) {
         return;
     }
-    sqlite3_bind_text(stmt, 1, direction.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 3, msg_id);
-    sqlite3_bind_text(stmt, 4, src_ip.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, dst_ip.c_str(), -1, SQLITE_TRANSIENT);
-    if (!payload.empty()) {
-        sqlite3_bind_blob(stmt, 6, payload.data(), static_cast<int>(payload.size()), SQLITE_TRANSIENT);
-    } else {
-        sqlite3_bind_null(stmt, 6);
+    const auto received = std::chrono::steady_clock::now();
+    if (rx_time_ns == 0) {
+        rx_time_ns = unixNowNs();
     }
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    storeSlot(*state.slot, payload, size, src_ip, dst_ip);
+    if (state.update_latency) {
+        // storeSlot() stamps the slot with the time it was published.
+        state.update_latency->record(state.slot->timestamp_ns.load(std::memory_order_relaxed) - rx_time_ns);
+        if (state.last_event) {
+            state.inter_arrival->record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(received - *state.last_event).count());
+        }
+        state.last_event = received;
+    }
+    char src_text[16];
+    char dst_text[16];
+    logTrdpEvent("IN", "PD", state.id, formatIpv4(src_ip, src_text), formatIpv4(dst_ip, dst_text), payload,
+                 std::min(size, state.slot->capacity));
+}
+
+void TrdpEngine::handleIncomingMd(int msg_id, const std::vector<uint8_t> &payload, const std::string &src_ip,
+                                  const std::string &dst_ip) {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        MdMessage message;
+        message.id = next_md_id_++;
+        if (msg_id <= 0) {
+            msg_id = next_md_msg_id_++;
+        }
+        message.msg_id = msg_id;
+        message.source = src_ip;
+        message.destination = dst_ip;
+        message.payload = payload;
+        message.timestamp = nowIso8601();
+        incoming_md_->push(std::move(message));
+    }
+    logTrdpEvent("IN", "MD", msg_id, src_ip, dst_ip, payload.data(), payload.size());
+}
+
+void TrdpEngine::logTrdpEvent(std::string_view direction, std::string_view type, int msg_id, std::string_view src_ip,
+                              std::string_view dst_ip, const uint8_t *payload, size_t size) {
+    // Every sent and received telegram passes through here, so this is also
+    // where traffic is counted.
+    const bool incoming = direction == "IN";
+    TrafficCounters &traffic = type == "MD" ? (incoming ? md_in_ : md_out_) : (incoming ? pd_in_ : pd_out_);
+    traffic.packets.add();
+    traffic.bytes.add(size);
+    const bool pd = type == "PD";
+    if (rollup_ && pd) {
+        rollup_->record(direction, msg_id, src_ip, dst_ip, payload, size);
+    }
+    if (!log_writer_ || (pd && !log_pd_packets_)) {
+        return;
+    }
+    log_writer_->enqueue(direction, type, msg_id, src_ip, dst_ip, payload, size);
 }
 
 std::string TrdpEngine::sanitizeEndpoint(const std::string &endpoint) {
@@ -1026,41 +1857,203 @@ void TrdpEngine::ensureWorker() {
 
 void TrdpEngine::stopWorker() {
     stop_worker_ = true;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        wakeWorkerLocked();
+    }
     if (worker_thread_.joinable()) {
         worker_thread_.join();
     }
 }
 
 void TrdpEngine::clearAllStateLocked() {
-    outgoing_pd_.clear();
-    incoming_pd_.clear();
-    outgoing_md_.clear();
-    incoming_md_.clear();
-    outgoing_pd_index_.clear();
-    incoming_pd_index_.clear();
-    outgoing_md_index_.clear();
-    incoming_md_index_.clear();
+    std::atomic_store(&outgoing_pd_table_, std::shared_ptr<const PdTable>());
+    std::atomic_store(&incoming_pd_table_, std::shared_ptr<const PdTable>());
+    outgoing_md_->clear();
+    incoming_md_->clear();
     pd_runtime_.clear();
+    pd_subscriber_runtime_.clear();
     md_runtime_.clear();
+    pd_scheduler_.clear();
     next_pd_id_ = 1;
-    next_md_id_ = 1;
+    // MD history ids keep counting across reloads so since_id cursors held by
+    // clients never point past the new history.
     next_md_msg_id_ = 1;
     next_md_runtime_id_ = 1;
 }
 
-void TrdpEngine::pdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size, const char *src_ip,
-                                  const char *dst_ip) {
+PdDelta TrdpEngine::changesSince(const std::shared_ptr<const PdTable> &table, uint64_t version) const {
+    PdDelta delta;
+    // Read the high-water mark first: a store that took a version at or
+    // below it has already marked its slot busy, so the scan below waits for
+    // it instead of missing it.
+    delta.version = pd_version_.load(std::memory_order_acquire);
+    if (!table) {
+        delta.reset = true;
+        return delta;
+    }
+    delta.reset = version <= table->base_version;
+    for (const auto &slot : table->slots) {
+        if (slotVersion(*slot) > version) {
+            delta.messages.push_back(readSlot(*slot));
+        }
+    }
+    return delta;
+}
+
+std::vector<PdMessagePtr> TrdpEngine::snapshotTable(const std::shared_ptr<const PdTable> &table) {
+    std::vector<PdMessagePtr> messages;
+    if (!table) {
+        return messages;
+    }
+    messages.reserve(table->slots.size());
+    for (const auto &slot : table->slots) {
+        messages.push_back(readSlot(*slot));
+    }
+    return messages;
+}
+
+std::shared_ptr<TrdpEngine::PdSlot> TrdpEngine::findSlot(const std::shared_ptr<const PdTable> &table, int msg_id) {
+    if (!table) {
+        return nullptr;
+    }
+    auto it = table->index.find(msg_id);
+    if (it == table->index.end()) {
+        return nullptr;
+    }
+    return table->slots[it->second];
+}
+
+std::shared_ptr<TrdpEngine::PdSlot> TrdpEngine::appendSlot(PdTable &table, const PdMessage &message, size_t capacity,
+                                                           uint32_t src_ip, uint32_t dst_ip) {
+    auto slot = std::make_shared<PdSlot>(message.id, message.name, message.cycle_time_ms, message.dataset, capacity);
+    storeSlot(*slot, message.payload.data(), message.payload.size(), src_ip, dst_ip);
+    table.index[message.id] = table.slots.size();
+    table.slots.push_back(slot);
+    return slot;
+}
+
+void TrdpEngine::storeSlot(PdSlot &slot, const uint8_t *payload, size_t size, uint32_t src_ip, uint32_t dst_ip) {
+    const size_t length = payload != nullptr ? std::min(size, slot.capacity) : 0;
+    // Only new bytes or endpoints move the slot's version, so a cyclic
+    // telegram repeating its payload stays out of since_version deltas. The
+    // slot has a single writer, which may read it without the seqlock.
+    if (slot.version.load(std::memory_order_relaxed) != 0 && slot.size.load(std::memory_order_relaxed) == length &&
+        slot.src_ip.load(std::memory_order_relaxed) == src_ip &&
+        slot.dst_ip.load(std::memory_order_relaxed) == dst_ip &&
+        (length == 0 || std::memcmp(slot.data.get(), payload, length) == 0)) {
+        touchSlot(slot);
+        return;
+    }
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // Taken after the slot is marked busy; see changesSince().
+    const uint64_t version = pd_version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (length > 0) {
+        std::memcpy(slot.data.get(), payload, length);
+    }
+    slot.size.store(length, std::memory_order_relaxed);
+    slot.src_ip.store(src_ip, std::memory_order_relaxed);
+    slot.dst_ip.store(dst_ip, std::memory_order_relaxed);
+    slot.timestamp_ns.store(unixNowNs(), std::memory_order_relaxed);
+    slot.version.store(version, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TrdpEngine::patchSlot(PdSlot &slot, const uint8_t *payload, size_t size,
+                           const std::vector<std::pair<size_t, size_t>> &ranges) {
+    const size_t length = std::min(size, slot.capacity);
+    const bool resized = slot.size.load(std::memory_order_relaxed) != length;
+    // As in storeSlot(), rewriting ranges with the bytes they hold keeps the
+    // version.
+    if (!resized && std::all_of(ranges.begin(), ranges.end(), [&](const std::pair<size_t, size_t> &range) {
+            return std::memcmp(slot.data.get() + range.first, payload + range.first, range.second) == 0;
+        })) {
+        touchSlot(slot);
+        return;
+    }
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const uint64_t version = pd_version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (resized) {
+        std::memcpy(slot.data.get(), payload, length);
+        slot.size.store(length, std::memory_order_relaxed);
+    } else {
+        for (const auto &range : ranges) {
+            std::memcpy(slot.data.get() + range.first, payload + range.first, range.second);
+        }
+    }
+    slot.timestamp_ns.store(unixNowNs(), std::memory_order_relaxed);
+    slot.version.store(version, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TrdpEngine::touchSlot(PdSlot &slot) {
+    // The payload stays as it is, so readers need not retry over a new
+    // timestamp and their cached message stays valid.
+    slot.timestamp_ns.store(unixNowNs(), std::memory_order_relaxed);
+}
+
+uint64_t TrdpEngine::slotVersion(const PdSlot &slot) {
+    while ((slot.sequence.load(std::memory_order_acquire) & 1U) != 0) {
+        std::this_thread::yield();
+    }
+    return slot.version.load(std::memory_order_acquire);
+}
+
+PdMessagePtr TrdpEngine::readSlot(PdSlot &slot) {
+    std::lock_guard<std::mutex> lock(slot.cache_mutex);
+    if (slot.cached && slot.sequence.load(std::memory_order_acquire) == slot.cached_sequence) {
+        const int64_t second = slot.timestamp_ns.load(std::memory_order_relaxed) / 1000000000;
+        if (second != slot.cached_second) {
+            auto message = std::make_shared<PdMessage>(*slot.cached);
+            message->timestamp = formatIso8601(second * 1000000000);
+            slot.cached_second = second;
+            slot.cached = std::move(message);
+        }
+        return slot.cached;
+    }
+    auto message = std::make_shared<PdMessage>();
+    message->id = slot.id;
+    message->name = slot.name;
+    message->cycle_time_ms = slot.cycle_time_ms;
+    message->dataset = slot.dataset;
+    message->payload.reserve(slot.capacity);
+    uint64_t sequence = 0;
+    int64_t timestamp_ns = 0;
+    uint64_t version = 0;
+    while (true) {
+        sequence = slot.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1U) != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        const size_t length = slot.size.load(std::memory_order_relaxed);
+        message->payload.assign(slot.data.get(), slot.data.get() + length);
+        timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+        version = slot.version.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            break;
+        }
+    }
+    message->timestamp = formatIso8601(timestamp_ns);
+    message->version = version;
+    slot.cached_sequence = sequence;
+    slot.cached_second = timestamp_ns / 1000000000;
+    slot.cached = std::move(message);
+    return slot.cached;
+}
+
+void TrdpEngine::pdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size, uint32_t src_ip,
+                                  uint32_t dst_ip, int64_t rx_time_ns) {
     if (ref_con == nullptr) {
         return;
     }
     auto *state = static_cast<PdRuntimeState *>(ref_con);
-    std::vector<uint8_t> buffer;
-    if (payload != nullptr && size > 0U) {
-        buffer.assign(payload, payload + size);
-    }
-    std::string src = src_ip != nullptr ? src_ip : "";
-    std::string dst = dst_ip != nullptr ? dst_ip : "";
-    state->engine->handleIncomingPd(state->id, buffer, src, dst);
+    state->engine->handleIncomingPd(*state, payload, payload != nullptr ? size : 0U, src_ip, dst_ip, rx_time_ns);
 }
 
 void TrdpEngine::mdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_t size, const char *src_ip,
@@ -1079,8 +2072,11 @@ void TrdpEngine::mdCallbackBridge(void *ref_con, const uint8_t *payload, uint32_
 }
 
 std::string TrdpEngine::nowIso8601() {
-    auto now = std::chrono::system_clock::now();
-    auto tt = std::chrono::system_clock::to_time_t(now);
+    return formatIso8601(unixNowNs());
+}
+
+std::string TrdpEngine::formatIso8601(int64_t unix_ns) {
+    auto tt = static_cast<std::time_t>(unix_ns / 1000000000);
     std::tm tm;
 #ifdef _WIN32
     gmtime_s(&tm, &tt);
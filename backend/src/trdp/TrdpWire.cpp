@@ -0,0 +1,159 @@
+#include "trdp/TrdpWire.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace trdp::stack {
+
+namespace {
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table {};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) != 0U ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+void put16(uint8_t *out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+void put32(uint8_t *out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint16_t get16(const uint8_t *in) {
+    return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+uint32_t get32(const uint8_t *in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | in[3];
+}
+
+void putFcs(uint8_t *out, uint32_t fcs) {
+    out[0] = static_cast<uint8_t>(fcs);
+    out[1] = static_cast<uint8_t>(fcs >> 8);
+    out[2] = static_cast<uint8_t>(fcs >> 16);
+    out[3] = static_cast<uint8_t>(fcs >> 24);
+}
+
+uint32_t getFcs(const uint8_t *in) {
+    return in[0] | (static_cast<uint32_t>(in[1]) << 8) | (static_cast<uint32_t>(in[2]) << 16) |
+           (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Fields shared by the PD and MD headers: sequence counter, protocol
+// version, message type, ComId, two topography counters and dataset length.
+void putCommonHeader(uint8_t *out, TrdpMessageType type, uint32_t sequence, uint32_t com_id, size_t size) {
+    put32(out, sequence);
+    put16(out + 4, kTrdpProtocolVersion);
+    put16(out + 6, static_cast<uint16_t>(type));
+    put32(out + 8, com_id);
+    put32(out + 12, 0);
+    put32(out + 16, 0);
+    put32(out + 20, static_cast<uint32_t>(size));
+}
+
+}  // namespace
+
+bool isPdMessage(TrdpMessageType type) {
+    switch (type) {
+        case TrdpMessageType::kPdData:
+        case TrdpMessageType::kPdPullRequest:
+        case TrdpMessageType::kPdPullReply:
+        case TrdpMessageType::kPdError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isMdMessage(TrdpMessageType type) {
+    switch (type) {
+        case TrdpMessageType::kMdNotify:
+        case TrdpMessageType::kMdRequest:
+        case TrdpMessageType::kMdReply:
+        case TrdpMessageType::kMdReplyQuery:
+        case TrdpMessageType::kMdConfirm:
+        case TrdpMessageType::kMdError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t trdpFcs(const uint8_t *data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFU;
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+size_t encodePdFrame(uint8_t *out, TrdpMessageType type, uint32_t sequence, uint32_t com_id, const uint8_t *data,
+                     size_t size) {
+    putCommonHeader(out, type, sequence, com_id, size);
+    put32(out + 24, 0);  // reserved
+    put32(out + 28, 0);  // reply ComId, only used by pull requests
+    put32(out + 32, 0);  // reply IP address
+    putFcs(out + 36, trdpFcs(out, 36));
+    if (size > 0) {
+        std::memcpy(out + kPdHeaderSize, data, size);
+    }
+    return kPdHeaderSize + size;
+}
+
+size_t encodeMdFrame(uint8_t *out, TrdpMessageType type, uint32_t sequence, uint32_t com_id, const uint8_t *data,
+                     size_t size) {
+    putCommonHeader(out, type, sequence, com_id, size);
+    // Reply status, session id, reply timeout and both URIs stay zero:
+    // notifications carry no session and no user addressing.
+    std::memset(out + 24, 0, 88);
+    putFcs(out + 112, trdpFcs(out, 112));
+    if (size > 0) {
+        std::memcpy(out + kMdHeaderSize, data, size);
+    }
+    return kMdHeaderSize + size;
+}
+
+std::optional<TrdpFrame> decodeFrame(const uint8_t *frame, size_t size) {
+    if (size < kPdHeaderSize || (get16(frame + 4) & 0xFF00U) != (kTrdpProtocolVersion & 0xFF00U)) {
+        return std::nullopt;
+    }
+    TrdpFrame result;
+    result.type = static_cast<TrdpMessageType>(get16(frame + 6));
+    size_t header = 0;
+    if (isPdMessage(result.type)) {
+        header = kPdHeaderSize;
+    } else if (isMdMessage(result.type)) {
+        header = kMdHeaderSize;
+    } else {
+        return std::nullopt;
+    }
+    if (size < header || getFcs(frame + header - 4) != trdpFcs(frame, header - 4)) {
+        return std::nullopt;
+    }
+    const uint32_t length = get32(frame + 20);
+    if (length > size - header) {
+        return std::nullopt;
+    }
+    result.sequence = get32(frame);
+    result.com_id = get32(frame + 8);
+    result.data = frame + header;
+    result.size = length;
+    return result;
+}
+
+}  // namespace trdp::stack
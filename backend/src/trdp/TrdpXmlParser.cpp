@@ -1,8 +1,10 @@
 #include "trdp/TrdpXmlParser.hpp"
 
 #include <array>
+#include <cctype>
 #include <cstdlib>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -17,12 +19,27 @@
 #define TRDP_HAS_TAU_XML 0
 #endif
 
-#include "trdp/XmlUtils.hpp"
 #include "trdp/xml/TrdpXmlLoader.hpp"
+#include "trdp/xml/XmlTokenizer.hpp"
 
 namespace trdp::config {
 namespace {
 
+std::vector<TrdpDatasetDefinition> convertDatasets(const std::vector<xml::ParsedDataset> &parsed) {
+    std::vector<TrdpDatasetDefinition> datasets;
+    datasets.reserve(parsed.size());
+    for (const auto &dataset : parsed) {
+        TrdpDatasetDefinition definition;
+        definition.id = dataset.dataset_id;
+        definition.name = dataset.name;
+        for (const auto &element : dataset.elements) {
+            definition.elements.push_back(TrdpDatasetElement {element.name, element.type, element.array_size});
+        }
+        datasets.push_back(std::move(definition));
+    }
+    return datasets;
+}
+
 TrdpTelegramType convertTelegramKind(xml::TelegramKind kind) {
     return kind == xml::TelegramKind::kMd ? TrdpTelegramType::kMd : TrdpTelegramType::kPd;
 }
@@ -69,6 +86,7 @@ std::optional<TrdpXmlConfig> parseWithFallbackLoader(const std::string &xml_cont
             }
             return std::nullopt;
         }
+        config.datasets = convertDatasets(parsed.datasets);
         return config;
     } catch (const xml::TrdpXmlLoaderError &ex) {
         if (error_out != nullptr) {
@@ -377,18 +395,50 @@ std::optional<TrdpXmlConfig> parseWithTauXml(const std::string &xml_content, std
 
 #endif  // TRDP_HAS_TAU_XML
 
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool containsIgnoreCase(std::string_view haystack, std::string_view needle) {
+    for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        if (equalsIgnoreCase(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stops at the first start tag that identifies a TRDP configuration, which
+// for real documents is the root element, so large files are not rescanned.
 bool hasTrdpMarkers(const std::string &xml_content) {
-    const auto lowered = xml::toLowerCopy(xml_content);
-    if (lowered.find("trdp-config.xsd") != std::string::npos) {
-        return true;
-    }
-    static const std::array<const char *, 8> markers = {"<device ",          "<device-configuration", "<mem-block-list",
-                                                        "<bus-interface-list", "<bus-interface",        "<pd-com-parameter",
-                                                        "<md-com-parameter",  "<telegram"};
-    for (auto marker : markers) {
-        if (lowered.find(marker) != std::string::npos) {
+    static constexpr std::array<std::string_view, 6> tag_prefixes = {
+        "device-configuration", "mem-block-list",   "bus-interface",
+        "pd-com-parameter",     "md-com-parameter", "telegram"};
+    xml::XmlTokenizer tokenizer(xml_content);
+    xml::XmlToken token;
+    while (tokenizer.next(token)) {
+        if (token.type != xml::XmlTokenType::kStartTag) {
+            continue;
+        }
+        if (containsIgnoreCase(token.text, "trdp-config.xsd")) {
+            return true;
+        }
+        if (equalsIgnoreCase(token.name, "device") && !token.text.empty()) {
             return true;
         }
+        for (auto prefix : tag_prefixes) {
+            if (token.name.size() >= prefix.size() && equalsIgnoreCase(token.name.substr(0, prefix.size()), prefix)) {
+                return true;
+            }
+        }
     }
     return false;
 }
@@ -406,6 +456,9 @@ std::optional<TrdpXmlConfig> parseTrdpXmlConfig(const std::string &xml_content,
 #if TRDP_HAS_TAU_XML
     std::string tau_error;
     if (auto parsed = parseWithTauXml(xml_content, &tau_error)) {
+        // Dataset layouts come from the built-in loader either way, so both
+        // paths decode payloads the same.
+        parsed->datasets = convertDatasets(xml::TrdpXmlLoader().parseDatasets(xml_content));
         return parsed;
     }
     if (auto fallback = parseWithFallbackLoader(xml_content, error_out)) {
@@ -0,0 +1,1013 @@
+#include "trdp/UdpTransport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#endif
+
+// Multishot recvmsg (and thus the whole io_uring backend) needs the Linux 6.0
+// UAPI; older headers build the epoll backend only.
+#if defined(__linux__) && defined(IORING_RECV_MULTISHOT)
+#define TRDP_HAS_IO_URING 1
+#else
+#define TRDP_HAS_IO_URING 0
+#endif
+
+namespace trdp::stack {
+
+namespace {
+
+constexpr size_t kPdSendBatch = 64;
+constexpr size_t kMdSendBatch = 16;
+constexpr size_t kPdReceiveBatch = 64;
+constexpr size_t kMdReceiveBatch = 8;
+// Room for a full PD frame plus slack, so an oversized datagram shows up as
+// truncated instead of fitting by accident.
+constexpr size_t kPdReceiveBuffer = 2048;
+constexpr size_t kMdReceiveBuffer = 65536;
+constexpr int kPdReceiveBufferBytes = 1 << 20;
+constexpr int kMulticastTtl = 64;
+
+struct BackendName {
+    std::string_view name;
+    UdpIoBackend backend;
+};
+
+constexpr std::array<BackendName, 3> kBackendNames = {{
+    {"auto", UdpIoBackend::kAuto},
+    {"epoll", UdpIoBackend::kEpoll},
+    {"io_uring", UdpIoBackend::kIoUring},
+}};
+
+uint64_t sequenceKey(TrdpMessageType type, uint32_t com_id) {
+    return (static_cast<uint64_t>(type) << 32) | com_id;
+}
+
+}  // namespace
+
+std::optional<UdpIoBackend> parseUdpIoBackend(std::string_view name) {
+    for (const auto &entry : kBackendNames) {
+        if (entry.name == name) {
+            return entry.backend;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view udpIoBackendName(UdpIoBackend backend) {
+    for (const auto &entry : kBackendNames) {
+        if (entry.backend == backend) {
+            return entry.name;
+        }
+    }
+    return "auto";
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Ancillary data of a received datagram: the destination address
+// (IP_PKTINFO) and the kernel receive time (SO_TIMESTAMPNS).
+constexpr size_t kReceiveControlSize = CMSG_SPACE(sizeof(in_pktinfo)) + CMSG_SPACE(sizeof(timespec));
+
+}  // namespace
+
+struct UdpTransport::SendQueue {
+    SendQueue(size_t batch, size_t frame_reserve)
+        : frames(batch), addresses(batch), iov(batch), headers(batch) {
+        for (auto &frame : frames) {
+            frame.reserve(frame_reserve);
+        }
+    }
+
+    int socket {-1};
+    size_t count {0};
+    // Frame buffers keep their capacity, so queueing does not allocate once
+    // every slot has carried its largest frame.
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<sockaddr_in> addresses;
+    std::vector<iovec> iov;
+    std::vector<mmsghdr> headers;
+};
+
+struct UdpTransport::ReceiveRing {
+    ReceiveRing(size_t batch, size_t buffer)
+        : buffer_size(buffer),
+          data(std::make_unique<uint8_t[]>(batch * buffer)),
+          addresses(batch),
+          iov(batch),
+          headers(batch),
+          control(batch) {}
+
+    uint8_t *buffer(size_t index) { return data.get() + index * buffer_size; }
+
+    const size_t buffer_size;
+    std::unique_ptr<uint8_t[]> data;
+    std::vector<sockaddr_in> addresses;
+    std::vector<iovec> iov;
+    std::vector<mmsghdr> headers;
+    std::vector<std::array<uint8_t, kReceiveControlSize>> control;
+};
+
+#if TRDP_HAS_IO_URING
+
+namespace {
+
+constexpr unsigned kUringSqEntries = 256;
+constexpr unsigned kUringCqEntries = 4096;
+// Buffer ring sizes must be powers of two.
+constexpr uint32_t kUringPdBuffers = 256;
+constexpr uint32_t kUringMdBuffers = 16;
+// A multishot recvmsg buffer starts with the result header, then the source
+// address and the control data areas sized by the template msghdr.
+constexpr size_t kUringReceiveOverhead =
+    sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + kReceiveControlSize;
+
+enum UringTag : uint64_t { kTagPdReceive = 1, kTagMdReceive = 2, kTagWake = 3, kTagSend = 4 };
+
+}  // namespace
+
+// Raw io_uring on the kernel ABI: one submission and one completion ring
+// mapped into the process, plus a provided buffer ring per socket that
+// multishot receives complete into.
+struct UdpTransport::Uring {
+    struct BufferGroup {
+        uint16_t id {0};
+        uint32_t count {0};
+        size_t buffer_size {0};
+        io_uring_buf_ring *ring {nullptr};
+        size_t ring_bytes {0};
+        std::unique_ptr<uint8_t[]> data;
+        uint16_t tail {0};
+        msghdr receive {};
+
+        uint8_t *buffer(uint16_t bid) { return data.get() + static_cast<size_t>(bid) * buffer_size; }
+
+        // Hands a buffer back to the kernel; visible after publish(). The
+        // entries are addressed from the ring start: the UAPI's flexible
+        // array member lands at the wrong offset when compiled as C++.
+        void give(uint16_t bid) {
+            io_uring_buf &entry = reinterpret_cast<io_uring_buf *>(ring)[tail & (count - 1)];
+            entry.addr = reinterpret_cast<uint64_t>(buffer(bid));
+            entry.len = static_cast<uint32_t>(buffer_size);
+            entry.bid = bid;
+            ++tail;
+        }
+
+        void publish() { __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE); }
+    };
+
+    ~Uring() {
+        for (BufferGroup *group : {&pd, &md}) {
+            if (group->ring != nullptr) {
+                ::munmap(group->ring, group->ring_bytes);
+            }
+        }
+        if (sqes != nullptr) {
+            ::munmap(sqes, sqes_bytes);
+        }
+        if (rings != nullptr) {
+            ::munmap(rings, rings_bytes);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool setupGroup(BufferGroup &group, uint16_t id, uint32_t count, size_t buffer_size) {
+        group.id = id;
+        group.count = count;
+        group.buffer_size = buffer_size;
+        group.data = std::make_unique<uint8_t[]>(count * buffer_size);
+        group.ring_bytes = count * sizeof(io_uring_buf);
+        void *memory = ::mmap(nullptr, group.ring_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+        group.ring = static_cast<io_uring_buf_ring *>(memory);
+        io_uring_buf_reg registration {};
+        registration.ring_addr = reinterpret_cast<uint64_t>(group.ring);
+        registration.ring_entries = count;
+        registration.bgid = id;
+        if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+            return false;
+        }
+        for (uint32_t bid = 0; bid < count; ++bid) {
+            group.give(static_cast<uint16_t>(bid));
+        }
+        group.publish();
+        group.receive.msg_namelen = sizeof(sockaddr_in);
+        group.receive.msg_controllen = kReceiveControlSize;
+        return true;
+    }
+
+    // Returns a cleared submission entry, submitting first when the queue is
+    // full.
+    io_uring_sqe *nextSqe() {
+        if (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+            submit();
+            if (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+                return nullptr;
+            }
+        }
+        io_uring_sqe *sqe = &sqes[sq_local_tail & sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++sq_local_tail;
+        return sqe;
+    }
+
+    // Submits everything queued. Sends run inline during this call (see
+    // UdpTransport::flushLocked()), so their buffers are free on return.
+    int submit() {
+        __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+        int submitted = 0;
+        while (sq_submitted != sq_local_tail) {
+            const long result = ::syscall(__NR_io_uring_enter, fd, sq_local_tail - sq_submitted, 0, 0, nullptr, 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            sq_submitted += static_cast<unsigned>(result);
+            submitted += static_cast<int>(result);
+        }
+        return submitted;
+    }
+
+    bool armReceive(BufferGroup &group, int socket, uint64_t tag) {
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = socket;
+        sqe->addr = reinterpret_cast<uint64_t>(&group.receive);
+        sqe->len = 1;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = group.id;
+        sqe->user_data = tag;
+        return true;
+    }
+
+    bool armWake(int wake_fd) {
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = wake_fd;
+        sqe->poll32_events = POLLIN;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->user_data = kTagWake;
+        return true;
+    }
+
+    bool completionsPending() const {
+        return *cq_head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    int fd {-1};
+    unsigned features {0};
+    void *rings {nullptr};
+    size_t rings_bytes {0};
+    io_uring_sqe *sqes {nullptr};
+    size_t sqes_bytes {0};
+    unsigned *sq_head {nullptr};
+    unsigned *sq_tail {nullptr};
+    unsigned sq_mask {0};
+    unsigned sq_entries {0};
+    unsigned sq_local_tail {0};
+    unsigned sq_submitted {0};
+    unsigned *cq_head {nullptr};
+    unsigned *cq_tail {nullptr};
+    unsigned cq_mask {0};
+    io_uring_cqe *cqes {nullptr};
+    BufferGroup pd;
+    BufferGroup md;
+    int wake_fd {-1};
+};
+
+#else
+
+struct UdpTransport::Uring {};
+
+#endif
+
+namespace {
+
+bool setOption(int socket, int level, int name, int value) {
+    return ::setsockopt(socket, level, name, &value, sizeof(value)) == 0;
+}
+
+int openSocket(uint16_t port, std::string &error) {
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    // Several processes on one host may share the TRDP ports; each gets a
+    // copy of multicast traffic.
+    setOption(fd, SOL_SOCKET, SO_REUSEADDR, 1);
+    setOption(fd, SOL_SOCKET, SO_REUSEPORT, 1);
+    setOption(fd, IPPROTO_IP, IP_PKTINFO, 1);
+    setOption(fd, SOL_SOCKET, SO_TIMESTAMPNS, 1);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        error = "bind to port " + std::to_string(port) + ": " + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+uint32_t parseAddress(const std::string &text) {
+    in_addr address {};
+    if (text.empty() || ::inet_pton(AF_INET, text.c_str(), &address) != 1) {
+        return 0U;
+    }
+    return ntohl(address.s_addr);
+}
+
+bool isMulticast(uint32_t ip) {
+    return (ip >> 28) == 0xEU;
+}
+
+void drainEventFd(int fd) {
+    uint64_t value = 0;
+    [[maybe_unused]] const ssize_t drained = ::read(fd, &value, sizeof(value));
+}
+
+timespec remainingUntil(const std::chrono::steady_clock::time_point &deadline) {
+    const auto remaining =
+        std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+    timespec result {};
+    result.tv_sec = static_cast<time_t>(ns / 1000000000);
+    result.tv_nsec = static_cast<long>(ns % 1000000000);
+    return result;
+}
+
+}  // namespace
+
+UdpTransport::UdpTransport()
+    : pd_queue_(std::make_unique<SendQueue>(kPdSendBatch, kPdHeaderSize + kMaxPdDatasetSize)),
+      md_queue_(std::make_unique<SendQueue>(kMdSendBatch, 0)),
+      pd_ring_(std::make_unique<ReceiveRing>(kPdReceiveBatch, kPdReceiveBuffer)),
+      md_ring_(std::make_unique<ReceiveRing>(kMdReceiveBatch, kMdReceiveBuffer)) {}
+
+UdpTransport::~UdpTransport() {
+    close();
+}
+
+bool UdpTransport::open(const network::NetworkConfig &cfg, UdpIoBackend backend, std::string &error) {
+    close();
+    pd_port_ = cfg.pd_port > 0 ? static_cast<uint16_t>(cfg.pd_port) : kDefaultPdPort;
+    md_port_ = cfg.md_port > 0 ? static_cast<uint16_t>(cfg.md_port) : kDefaultMdPort;
+    interface_ip_ = parseAddress(cfg.local_ip);
+    pd_socket_ = openSocket(pd_port_, error);
+    if (pd_socket_ < 0) {
+        return false;
+    }
+    md_socket_ = openSocket(md_port_, error);
+    if (md_socket_ < 0) {
+        close();
+        return false;
+    }
+    setOption(pd_socket_, SOL_SOCKET, SO_RCVBUF, kPdReceiveBufferBytes);
+    for (const int fd : {pd_socket_, md_socket_}) {
+        if (interface_ip_ != 0U) {
+            in_addr interface_address {htonl(interface_ip_)};
+            ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interface_address, sizeof(interface_address));
+        }
+        setOption(fd, IPPROTO_IP, IP_MULTICAST_TTL, kMulticastTtl);
+        // Lets other processes on this host, and this one, see what we send.
+        setOption(fd, IPPROTO_IP, IP_MULTICAST_LOOP, 1);
+    }
+    pd_queue_->socket = pd_socket_;
+    md_queue_->socket = md_socket_;
+    for (const auto &group : cfg.multicast_groups) {
+        const uint32_t address = parseAddress(group);
+        if (!isMulticast(address) || !joinGroup(address)) {
+            error = "cannot join multicast group '" + group + "'";
+            close();
+            return false;
+        }
+    }
+
+    backend_ = UdpIoBackend::kEpoll;
+    if (backend != UdpIoBackend::kEpoll) {
+        if (openUring(fallback_reason_)) {
+            backend_ = UdpIoBackend::kIoUring;
+            return true;
+        }
+        uring_.reset();
+        if (backend == UdpIoBackend::kAuto) {
+            fallback_reason_.clear();
+        }
+    }
+    if (!openEpoll(error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UdpTransport::close() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    // Closing the ring cancels its outstanding receives before the sockets
+    // go away.
+    uring_.reset();
+    for (int *fd : {&pd_socket_, &md_socket_, &epoll_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    epoll_wake_fd_ = -1;
+    pd_queue_->socket = -1;
+    pd_queue_->count = 0;
+    md_queue_->socket = -1;
+    md_queue_->count = 0;
+    groups_.clear();
+    sequences_.clear();
+    fallback_reason_.clear();
+}
+
+bool UdpTransport::joinGroup(uint32_t group) {
+    if (!isOpen() || !isMulticast(group) || groups_.count(group) != 0) {
+        return true;
+    }
+    ip_mreq request {};
+    request.imr_multiaddr.s_addr = htonl(group);
+    request.imr_interface.s_addr = htonl(interface_ip_);
+    for (const int fd : {pd_socket_, md_socket_}) {
+        if (::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) != 0) {
+            return false;
+        }
+    }
+    groups_.insert(group);
+    return true;
+}
+
+bool UdpTransport::queuePd(uint32_t com_id, uint32_t dst_ip, uint16_t dst_port, const uint8_t *data, size_t size) {
+    if (size > kMaxPdDatasetSize) {
+        return false;
+    }
+    return queueFrame(*pd_queue_, TrdpMessageType::kPdData, com_id, dst_ip, dst_port, data, size);
+}
+
+bool UdpTransport::queueMd(TrdpMessageType type, uint32_t com_id, uint32_t dst_ip, uint16_t dst_port,
+                           const uint8_t *data, size_t size) {
+    if (size > kMaxMdDatasetSize || !isMdMessage(type)) {
+        return false;
+    }
+    return queueFrame(*md_queue_, type, com_id, dst_ip, dst_port, data, size);
+}
+
+bool UdpTransport::queueFrame(SendQueue &queue, TrdpMessageType type, uint32_t com_id, uint32_t dst_ip,
+                              uint16_t dst_port, const uint8_t *data, size_t size) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (queue.socket < 0 || dst_ip == 0U) {
+        return false;
+    }
+    if (queue.count == queue.frames.size()) {
+        flushLocked(queue);
+    }
+    const size_t index = queue.count;
+    auto &frame = queue.frames[index];
+    const bool is_pd = isPdMessage(type);
+    frame.resize((is_pd ? kPdHeaderSize : kMdHeaderSize) + size);
+    const uint32_t sequence = nextSequence(type, com_id);
+    const size_t length = is_pd ? encodePdFrame(frame.data(), type, sequence, com_id, data, size) :
+                                  encodeMdFrame(frame.data(), type, sequence, com_id, data, size);
+
+    auto &address = queue.addresses[index];
+    address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(dst_ip);
+    address.sin_port = htons(dst_port);
+    queue.iov[index] = {frame.data(), length};
+    queue.headers[index] = {};
+    queue.headers[index].msg_hdr.msg_name = &address;
+    queue.headers[index].msg_hdr.msg_namelen = sizeof(address);
+    queue.headers[index].msg_hdr.msg_iov = &queue.iov[index];
+    queue.headers[index].msg_hdr.msg_iovlen = 1;
+    ++queue.count;
+    return true;
+}
+
+size_t UdpTransport::flush() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    return flushLocked(*pd_queue_) + flushLocked(*md_queue_);
+}
+
+size_t UdpTransport::flushLocked(SendQueue &queue) {
+    if (queue.count == 0) {
+        return 0;
+    }
+    size_t sent = 0;
+#if TRDP_HAS_IO_URING
+    if (uring_) {
+        // MSG_DONTWAIT makes a send that cannot complete right away fail with
+        // EAGAIN instead of being parked in the ring, so every send has run
+        // by the time submit() returns and the slots can be reused.
+        const bool skip_success = (uring_->features & IORING_FEAT_CQE_SKIP) != 0U;
+        for (size_t i = 0; i < queue.count; ++i) {
+            io_uring_sqe *sqe = uring_->nextSqe();
+            if (sqe == nullptr) {
+                send_errors_.fetch_add(queue.count - i, std::memory_order_relaxed);
+                break;
+            }
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = queue.socket;
+            sqe->addr = reinterpret_cast<uint64_t>(&queue.headers[i].msg_hdr);
+            sqe->len = 1;
+            sqe->msg_flags = MSG_DONTWAIT;
+            sqe->user_data = kTagSend;
+            if (skip_success) {
+                sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+            }
+            ++sent;
+        }
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (uring_->submit() < 0) {
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        queue.count = 0;
+        frames_sent_.fetch_add(sent, std::memory_order_relaxed);
+        return sent;
+    }
+#endif
+    size_t next = 0;
+    while (next < queue.count) {
+        const int result = ::sendmmsg(queue.socket, queue.headers.data() + next,
+                                      static_cast<unsigned int>(queue.count - next), 0);
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // sendmmsg() only fails for the first frame; drop it like a lost
+            // datagram and carry on with the rest of the batch.
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            ++next;
+            continue;
+        }
+        next += static_cast<size_t>(result);
+        sent += static_cast<size_t>(result);
+    }
+    queue.count = 0;
+    frames_sent_.fetch_add(sent, std::memory_order_relaxed);
+    return sent;
+}
+
+size_t UdpTransport::receive(FrameHandler handler, void *context) {
+    if (!isOpen()) {
+        return 0;
+    }
+    if (uring_) {
+        return reapUring(handler, context);
+    }
+    return drain(pd_socket_, *pd_ring_, handler, context) + drain(md_socket_, *md_ring_, handler, context);
+}
+
+size_t UdpTransport::drain(int socket, ReceiveRing &ring, FrameHandler handler, void *context) {
+    const size_t batch = ring.headers.size();
+    size_t handled = 0;
+    for (;;) {
+        for (size_t i = 0; i < batch; ++i) {
+            ring.iov[i] = {ring.buffer(i), ring.buffer_size};
+            auto &header = ring.headers[i].msg_hdr;
+            header = {};
+            header.msg_name = &ring.addresses[i];
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &ring.iov[i];
+            header.msg_iovlen = 1;
+            header.msg_control = ring.control[i].data();
+            header.msg_controllen = ring.control[i].size();
+        }
+        const int count = ::recvmmsg(socket, ring.headers.data(), static_cast<unsigned int>(batch), MSG_DONTWAIT,
+                                     nullptr);
+        if (count <= 0) {
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        receive_calls_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < static_cast<size_t>(count); ++i) {
+            const auto &header = ring.headers[i];
+            if (deliver(ring.buffer(i), header.msg_len, (header.msg_hdr.msg_flags & MSG_TRUNC) != 0,
+                        &ring.addresses[i], ring.control[i].data(), header.msg_hdr.msg_controllen, handler,
+                        context)) {
+                ++handled;
+            }
+        }
+        if (static_cast<size_t>(count) < batch) {
+            break;
+        }
+    }
+    return handled;
+}
+
+bool UdpTransport::deliver(const uint8_t *datagram, size_t size, bool truncated, const void *source,
+                           const void *control, size_t control_size, FrameHandler handler, void *context) {
+    const auto frame = truncated ? std::nullopt : decodeFrame(datagram, size);
+    if (!frame) {
+        frames_rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    UdpFrame received;
+    received.frame = *frame;
+    sockaddr_in address;
+    std::memcpy(&address, source, sizeof(address));
+    received.src_ip = ntohl(address.sin_addr.s_addr);
+    received.src_port = ntohs(address.sin_port);
+    msghdr message {};
+    message.msg_control = const_cast<void *>(control);
+    message.msg_controllen = control_size;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            in_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+            received.dst_ip = ntohl(info.ipi_addr.s_addr);
+        } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec stamp;
+            std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            received.rx_time_ns = static_cast<int64_t>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+        }
+    }
+    handler(context, received);
+    frames_received_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void UdpTransport::wait(const std::chrono::steady_clock::time_point *deadline, int wake_fd) {
+    if (uring_) {
+        waitUring(deadline, wake_fd);
+    } else if (epoll_fd_ >= 0) {
+        waitEpoll(deadline, wake_fd);
+    }
+}
+
+bool UdpTransport::openEpoll(std::string &error) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        error = std::string("epoll_create1: ") + std::strerror(errno);
+        return false;
+    }
+    for (const int fd : {pd_socket_, md_socket_}) {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            error = std::string("epoll_ctl: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+void UdpTransport::waitEpoll(const std::chrono::steady_clock::time_point *deadline, int wake_fd) {
+    if (wake_fd != epoll_wake_fd_) {
+        if (epoll_wake_fd_ >= 0) {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, epoll_wake_fd_, nullptr);
+        }
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = wake_fd;
+        epoll_wake_fd_ = wake_fd >= 0 && ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd, &event) == 0 ? wake_fd : -1;
+    }
+    std::array<epoll_event, 3> events {};
+    int ready = 0;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+    // epoll_pwait2() takes a nanosecond timeout, so sub-millisecond cycles
+    // are not rounded up.
+    timespec timeout {};
+    if (deadline != nullptr) {
+        timeout = remainingUntil(*deadline);
+    }
+    ready = ::epoll_pwait2(epoll_fd_, events.data(), static_cast<int>(events.size()),
+                           deadline != nullptr ? &timeout : nullptr, nullptr);
+    if (ready < 0 && errno == ENOSYS)
+#endif
+    {
+        int timeout_ms = -1;
+        if (deadline != nullptr) {
+            const auto remaining = std::max(*deadline - std::chrono::steady_clock::now(),
+                                            std::chrono::steady_clock::duration::zero());
+            timeout_ms = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+        }
+        ready = ::epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout_ms);
+    }
+    for (int i = 0; i < ready; ++i) {
+        if (events[static_cast<size_t>(i)].data.fd == epoll_wake_fd_) {
+            drainEventFd(epoll_wake_fd_);
+        }
+    }
+}
+
+#if TRDP_HAS_IO_URING
+
+bool UdpTransport::openUring(std::string &reason) {
+    auto ring = std::make_unique<Uring>();
+    io_uring_params params {};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = kUringCqEntries;
+    ring->fd = static_cast<int>(::syscall(__NR_io_uring_setup, kUringSqEntries, &params));
+    if (ring->fd < 0) {
+        reason = std::string("io_uring_setup: ") + std::strerror(errno);
+        return false;
+    }
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0U || (params.features & IORING_FEAT_EXT_ARG) == 0U) {
+        reason = "kernel io_uring lacks single mmap or wait timeouts";
+        return false;
+    }
+    ring->features = params.features;
+    ring->rings_bytes = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                         params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring->rings = ::mmap(nullptr, ring->rings_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    if (ring->rings == MAP_FAILED) {
+        ring->rings = nullptr;
+        reason = std::string("io_uring mmap: ") + std::strerror(errno);
+        return false;
+    }
+    ring->sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = ::mmap(nullptr, ring->sqes_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        reason = std::string("io_uring mmap: ") + std::strerror(errno);
+        return false;
+    }
+    ring->sqes = static_cast<io_uring_sqe *>(sqes);
+
+    auto *base = static_cast<uint8_t *>(ring->rings);
+    ring->sq_head = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+    ring->sq_tail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+    ring->sq_mask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_local_tail = *ring->sq_tail;
+    ring->sq_submitted = ring->sq_local_tail;
+    auto *sq_array = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; ++i) {
+        sq_array[i] = i;
+    }
+    ring->cq_head = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+    ring->cq_tail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+    ring->cq_mask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+    if (!ring->setupGroup(ring->pd, 0, kUringPdBuffers, kPdReceiveBuffer + kUringReceiveOverhead) ||
+        !ring->setupGroup(ring->md, 1, kUringMdBuffers, kMdReceiveBuffer + kUringReceiveOverhead)) {
+        reason = std::string("io_uring provided buffer rings: ") + std::strerror(errno);
+        return false;
+    }
+    if (!ring->armReceive(ring->pd, pd_socket_, kTagPdReceive) ||
+        !ring->armReceive(ring->md, md_socket_, kTagMdReceive) || ring->submit() < 0) {
+        reason = std::string("io_uring submit: ") + std::strerror(errno);
+        return false;
+    }
+    // Kernels without multishot recvmsg reject it while submitting, so a
+    // receive that already finished without "more" to come means no support.
+    for (unsigned head = *ring->cq_head; head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE); ++head) {
+        const io_uring_cqe &cqe = ring->cqes[head & ring->cq_mask];
+        if ((cqe.user_data == kTagPdReceive || cqe.user_data == kTagMdReceive) && cqe.res < 0 &&
+            (cqe.flags & IORING_CQE_F_MORE) == 0U) {
+            reason = std::string("multishot recvmsg: ") + std::strerror(-cqe.res);
+            return false;
+        }
+    }
+    uring_ = std::move(ring);
+    return true;
+}
+
+size_t UdpTransport::reapUring(FrameHandler handler, void *context) {
+    Uring &ring = *uring_;
+    bool rearm_pd = false;
+    bool rearm_md = false;
+    bool rearm_wake = false;
+    size_t handled = 0;
+    unsigned head = *ring.cq_head;
+    unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe &cqe = ring.cqes[head & ring.cq_mask];
+        const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0U;
+        switch (cqe.user_data) {
+            case kTagSend:
+                if (cqe.res < 0) {
+                    send_errors_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            case kTagWake:
+                drainEventFd(ring.wake_fd);
+                rearm_wake = rearm_wake || !more;
+                break;
+            case kTagPdReceive:
+            case kTagMdReceive: {
+                const bool is_pd = cqe.user_data == kTagPdReceive;
+                Uring::BufferGroup &group = is_pd ? ring.pd : ring.md;
+                if ((cqe.flags & IORING_CQE_F_BUFFER) != 0U) {
+                    const auto bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    if (cqe.res > 0) {
+                        const uint8_t *buffer = group.buffer(bid);
+                        const auto *out = reinterpret_cast<const io_uring_recvmsg_out *>(buffer);
+                        const uint8_t *name = buffer + sizeof(io_uring_recvmsg_out);
+                        const uint8_t *control = name + group.receive.msg_namelen;
+                        const uint8_t *payload = control + group.receive.msg_controllen;
+                        const size_t available = static_cast<size_t>(cqe.res) - static_cast<size_t>(payload - buffer);
+                        const bool truncated = (out->flags & MSG_TRUNC) != 0U || out->payloadlen > available;
+                        if (deliver(payload, std::min<size_t>(out->payloadlen, available), truncated, name, control,
+                                    out->controllen, handler, context)) {
+                            ++handled;
+                        }
+                    }
+                    group.give(bid);
+                }
+                if (!more) {
+                    // Ended, typically because every buffer was in use
+                    // (ENOBUFS); they are handed back below, then re-armed.
+                    (is_pd ? rearm_pd : rearm_md) = true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        ++head;
+        if (head == tail) {
+            __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+            tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+    __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    ring.pd.publish();
+    ring.md.publish();
+    if (rearm_pd || rearm_md || rearm_wake) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (rearm_pd) {
+            ring.armReceive(ring.pd, pd_socket_, kTagPdReceive);
+        }
+        if (rearm_md) {
+            ring.armReceive(ring.md, md_socket_, kTagMdReceive);
+        }
+        if (rearm_wake && ring.wake_fd >= 0) {
+            ring.armWake(ring.wake_fd);
+        }
+        ring.submit();
+    }
+    return handled;
+}
+
+void UdpTransport::waitUring(const std::chrono::steady_clock::time_point *deadline, int wake_fd) {
+    Uring &ring = *uring_;
+    if (wake_fd >= 0 && ring.wake_fd != wake_fd) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        ring.wake_fd = wake_fd;
+        ring.armWake(wake_fd);
+        ring.submit();
+    }
+    if (ring.completionsPending()) {
+        return;
+    }
+    __kernel_timespec timeout {};
+    io_uring_getevents_arg arg {};
+    arg.sigmask_sz = _NSIG / 8;
+    if (deadline != nullptr) {
+        const timespec remaining = remainingUntil(*deadline);
+        timeout.tv_sec = remaining.tv_sec;
+        timeout.tv_nsec = remaining.tv_nsec;
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+    }
+    ::syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+#else
+
+bool UdpTransport::openUring(std::string &reason) {
+    reason = "built without io_uring support";
+    return false;
+}
+
+size_t UdpTransport::reapUring(FrameHandler, void *) {
+    return 0;
+}
+
+void UdpTransport::waitUring(const std::chrono::steady_clock::time_point *, int) {}
+
+#endif
+
+#else
+
+struct UdpTransport::SendQueue {};
+struct UdpTransport::ReceiveRing {};
+struct UdpTransport::Uring {};
+
+UdpTransport::UdpTransport() = default;
+UdpTransport::~UdpTransport() = default;
+
+bool UdpTransport::open(const network::NetworkConfig &, UdpIoBackend, std::string &error) {
+    error = "the built-in UDP transport needs Linux";
+    return false;
+}
+
+void UdpTransport::close() {}
+
+bool UdpTransport::joinGroup(uint32_t) {
+    return false;
+}
+
+bool UdpTransport::queuePd(uint32_t, uint32_t, uint16_t, const uint8_t *, size_t) {
+    return false;
+}
+
+bool UdpTransport::queueMd(TrdpMessageType, uint32_t, uint32_t, uint16_t, const uint8_t *, size_t) {
+    return false;
+}
+
+bool UdpTransport::queueFrame(SendQueue &, TrdpMessageType, uint32_t, uint32_t, uint16_t, const uint8_t *,
+                              size_t) {
+    return false;
+}
+
+size_t UdpTransport::flush() {
+    return 0;
+}
+
+size_t UdpTransport::flushLocked(SendQueue &) {
+    return 0;
+}
+
+size_t UdpTransport::receive(FrameHandler, void *) {
+    return 0;
+}
+
+size_t UdpTransport::drain(int, ReceiveRing &, FrameHandler, void *) {
+    return 0;
+}
+
+bool UdpTransport::deliver(const uint8_t *, size_t, bool, const void *, const void *, size_t, FrameHandler,
+                           void *) {
+    return false;
+}
+
+void UdpTransport::wait(const std::chrono::steady_clock::time_point *, int) {}
+
+bool UdpTransport::openEpoll(std::string &) {
+    return false;
+}
+
+void UdpTransport::waitEpoll(const std::chrono::steady_clock::time_point *, int) {}
+
+bool UdpTransport::openUring(std::string &) {
+    return false;
+}
+
+size_t UdpTransport::reapUring(FrameHandler, void *) {
+    return 0;
+}
+
+void UdpTransport::waitUring(const std::chrono::steady_clock::time_point *, int) {}
+
+#endif
+
+uint32_t UdpTransport::nextSequence(TrdpMessageType type, uint32_t com_id) {
+    return sequences_[sequenceKey(type, com_id)]++;
+}
+
+UdpTransportStats UdpTransport::stats() const {
+    UdpTransportStats stats;
+    stats.frames_sent = frames_sent_.load(std::memory_order_relaxed);
+    stats.frames_received = frames_received_.load(std::memory_order_relaxed);
+    stats.send_errors = send_errors_.load(std::memory_order_relaxed);
+    stats.frames_rejected = frames_rejected_.load(std::memory_order_relaxed);
+    stats.send_calls = send_calls_.load(std::memory_order_relaxed);
+    stats.receive_calls = receive_calls_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace trdp::stack
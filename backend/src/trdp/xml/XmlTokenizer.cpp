@@ -0,0 +1,250 @@
+#include "trdp/xml/XmlTokenizer.hpp"
+
+#include <array>
+
+namespace trdp::xml {
+
+namespace {
+
+constexpr std::array<bool, 256> makeNameTable() {
+    std::array<bool, 256> table {};
+    for (int ch = 'a'; ch <= 'z'; ++ch) {
+        table[ch] = true;
+    }
+    for (int ch = 'A'; ch <= 'Z'; ++ch) {
+        table[ch] = true;
+    }
+    for (int ch = '0'; ch <= '9'; ++ch) {
+        table[ch] = true;
+    }
+    table['_'] = true;
+    table[':'] = true;
+    table['-'] = true;
+    table['.'] = true;
+    return table;
+}
+
+constexpr std::array<bool, 256> kNameChars = makeNameTable();
+
+bool isSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f' || ch == '\v';
+}
+
+bool isNameChar(char ch) {
+    return kNameChars[static_cast<unsigned char>(ch)];
+}
+
+bool startsWith(std::string_view text, size_t pos, std::string_view prefix) {
+    return text.compare(pos, prefix.size(), prefix) == 0;
+}
+
+}  // namespace
+
+bool XmlTokenizer::next(XmlToken &token) {
+    while (pos_ < xml_.size()) {
+        const size_t begin = pos_;
+        if (xml_[begin] != '<' || begin + 1 == xml_.size()) {
+            const size_t lt = xml_.find('<', begin + 1);
+            pos_ = lt == std::string_view::npos ? xml_.size() : lt;
+            token = XmlToken {XmlTokenType::kText, {}, xml_.substr(begin, pos_ - begin), false, begin, pos_};
+            return true;
+        }
+
+        if (startsWith(xml_, begin, "<!--")) {
+            const size_t close = xml_.find("-->", begin + 4);
+            pos_ = close == std::string_view::npos ? xml_.size() : close + 3;
+            continue;
+        }
+        if (startsWith(xml_, begin, "<![CDATA[")) {
+            const size_t content = begin + 9;
+            const size_t close = xml_.find("]]>", content);
+            const size_t content_end = close == std::string_view::npos ? xml_.size() : close;
+            pos_ = close == std::string_view::npos ? xml_.size() : close + 3;
+            token = XmlToken {XmlTokenType::kText, {}, xml_.substr(content, content_end - content), false, begin,
+                              pos_};
+            return true;
+        }
+        if (startsWith(xml_, begin, "<?")) {
+            const size_t close = xml_.find("?>", begin + 2);
+            pos_ = close == std::string_view::npos ? xml_.size() : close + 2;
+            continue;
+        }
+        if (startsWith(xml_, begin, "<!")) {
+            const size_t close = xml_.find('>', begin + 2);
+            pos_ = close == std::string_view::npos ? xml_.size() : close + 1;
+            continue;
+        }
+
+        const bool is_end = xml_[begin + 1] == '/';
+        const size_t name_begin = begin + (is_end ? 2 : 1);
+        size_t name_end = name_begin;
+        while (name_end < xml_.size() && !isSpace(xml_[name_end]) && xml_[name_end] != '/' &&
+               xml_[name_end] != '>') {
+            ++name_end;
+        }
+        if (name_end == name_begin) {
+            // A bare '<' is character data.
+            const size_t lt = xml_.find('<', begin + 1);
+            pos_ = lt == std::string_view::npos ? xml_.size() : lt;
+            token = XmlToken {XmlTokenType::kText, {}, xml_.substr(begin, pos_ - begin), false, begin, pos_};
+            return true;
+        }
+
+        // '>' may legally appear inside quoted attribute values.
+        size_t close = name_end;
+        char quote = 0;
+        for (; close < xml_.size(); ++close) {
+            const char ch = xml_[close];
+            if (quote != 0) {
+                if (ch == quote) {
+                    quote = 0;
+                }
+            } else if (ch == '"' || ch == '\'') {
+                quote = ch;
+            } else if (ch == '>') {
+                break;
+            }
+        }
+        if (close == xml_.size()) {
+            pos_ = xml_.size();
+            return false;
+        }
+        pos_ = close + 1;
+
+        token.begin = begin;
+        token.end = pos_;
+        token.name = xml_.substr(name_begin, name_end - name_begin);
+        if (is_end) {
+            token.type = XmlTokenType::kEndTag;
+            token.text = {};
+            token.self_closing = false;
+        } else {
+            token.type = XmlTokenType::kStartTag;
+            token.self_closing = close > name_end && xml_[close - 1] == '/';
+            const size_t segment_end = token.self_closing ? close - 1 : close;
+            token.text = xml_.substr(name_end, segment_end - name_end);
+        }
+        return true;
+    }
+    return false;
+}
+
+void XmlTokenizer::parseAttributes(std::string_view segment, std::vector<XmlAttribute> &out) {
+    size_t i = 0;
+    const size_t size = segment.size();
+    while (i < size) {
+        if (!isNameChar(segment[i])) {
+            ++i;
+            continue;
+        }
+        const size_t name_begin = i;
+        while (i < size && isNameChar(segment[i])) {
+            ++i;
+        }
+        const std::string_view name = segment.substr(name_begin, i - name_begin);
+        while (i < size && isSpace(segment[i])) {
+            ++i;
+        }
+        if (i == size || segment[i] != '=') {
+            continue;
+        }
+        ++i;
+        while (i < size && isSpace(segment[i])) {
+            ++i;
+        }
+        if (i == size || (segment[i] != '"' && segment[i] != '\'')) {
+            continue;
+        }
+        const char quote = segment[i++];
+        const size_t close = segment.find(quote, i);
+        if (close == std::string_view::npos) {
+            break;
+        }
+        out.push_back(XmlAttribute {name, segment.substr(i, close - i)});
+        i = close + 1;
+    }
+}
+
+XmlDocument::XmlDocument(std::string_view xml) : xml_(xml) {
+    XmlTokenizer tokenizer(xml_);
+    XmlToken token;
+    std::vector<uint32_t> open;
+    std::vector<size_t> body_begin;
+
+    auto close_node = [&](size_t body_end) {
+        auto &node = nodes_[open.back()];
+        node.body = xml_.substr(body_begin.back(), body_end - body_begin.back());
+        node.subtree_end = static_cast<uint32_t>(nodes_.size());
+        open.pop_back();
+        body_begin.pop_back();
+    };
+
+    while (tokenizer.next(token)) {
+        if (token.type == XmlTokenType::kStartTag) {
+            XmlNode node;
+            node.name = token.name;
+            node.first_attribute = static_cast<uint32_t>(attributes_.size());
+            XmlTokenizer::parseAttributes(token.text, attributes_);
+            node.attribute_count = static_cast<uint32_t>(attributes_.size()) - node.first_attribute;
+            const auto index = static_cast<uint32_t>(nodes_.size());
+            node.subtree_end = index + 1;
+            nodes_.push_back(node);
+            if (!token.self_closing) {
+                open.push_back(index);
+                body_begin.push_back(token.end);
+            }
+        } else if (token.type == XmlTokenType::kEndTag) {
+            size_t depth = open.size();
+            while (depth > 0 && nodes_[open[depth - 1]].name != token.name) {
+                --depth;
+            }
+            if (depth == 0) {
+                continue;
+            }
+            while (open.size() >= depth) {
+                close_node(token.begin);
+            }
+        }
+    }
+    while (!open.empty()) {
+        close_node(xml_.size());
+    }
+}
+
+std::vector<const XmlNode *> XmlDocument::find(std::string_view tag, const XmlNode *scope) const {
+    std::vector<const XmlNode *> matches;
+    size_t index = 0;
+    size_t end = nodes_.size();
+    if (scope != nullptr) {
+        index = static_cast<size_t>(scope - nodes_.data()) + 1;
+        end = scope->subtree_end;
+    }
+    while (index < end) {
+        const auto &node = nodes_[index];
+        if (node.name == tag) {
+            matches.push_back(&node);
+            index = node.subtree_end;
+        } else {
+            ++index;
+        }
+    }
+    return matches;
+}
+
+const XmlAttribute *XmlDocument::findAttribute(const XmlNode &node, std::string_view name) const {
+    const XmlAttribute *begin = attributes_.data() + node.first_attribute;
+    const XmlAttribute *end = begin + node.attribute_count;
+    for (const XmlAttribute *it = begin; it != end; ++it) {
+        if (it->name == name) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view XmlDocument::attribute(const XmlNode &node, std::string_view name) const {
+    const XmlAttribute *found = findAttribute(node, name);
+    return found != nullptr ? found->value : std::string_view {};
+}
+
+}  // namespace trdp::xml
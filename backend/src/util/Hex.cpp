@@ -0,0 +1,229 @@
+#include "util/Hex.hpp"
+
+#include <array>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TRDP_HEX_X86 1
+#include <immintrin.h>
+#else
+#define TRDP_HEX_X86 0
+#endif
+
+namespace trdp::util {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+constexpr std::array<int8_t, 256> makeDecodeTable() {
+    std::array<int8_t, 256> table {};
+    for (auto &entry : table) {
+        entry = -1;
+    }
+    for (int i = 0; i < 10; ++i) {
+        table['0' + i] = static_cast<int8_t>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        table['a' + i] = static_cast<int8_t>(10 + i);
+        table['A' + i] = static_cast<int8_t>(10 + i);
+    }
+    return table;
+}
+
+constexpr std::array<int8_t, 256> kDecodeTable = makeDecodeTable();
+
+void encodeScalar(const uint8_t *data, size_t size, char *out) {
+    for (size_t i = 0; i < size; ++i) {
+        out[2 * i] = kHexDigits[data[i] >> 4];
+        out[2 * i + 1] = kHexDigits[data[i] & 0x0F];
+    }
+}
+
+bool decodeScalar(const char *hex, size_t size, uint8_t *out) {
+    for (size_t i = 0; i < size; ++i) {
+        const int hi = kDecodeTable[static_cast<unsigned char>(hex[2 * i])];
+        const int lo = kDecodeTable[static_cast<unsigned char>(hex[2 * i + 1])];
+        if ((hi | lo) < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+#if TRDP_HEX_X86
+
+// Encodes 16 bytes into 32 digits: split nibbles, map them through a
+// 16-entry shuffle table and interleave high/low digits.
+__attribute__((target("ssse3"))) void encodeSsse3(const uint8_t *data, size_t size, char *out) {
+    const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kHexDigits));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+        const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    encodeScalar(data + i, size - i, out + 2 * i);
+}
+
+// Maps 16 hex digits to nibble values; `valid` is cleared on any other byte.
+__attribute__((target("ssse3"))) inline __m128i nibblesSsse3(__m128i chars, __m128i &valid) {
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_letter));
+    const __m128i letter_value = _mm_add_epi8(letter, _mm_set1_epi8(10));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_andnot_si128(is_digit, letter_value));
+}
+
+__attribute__((target("ssse3"))) bool decodeSsse3(const char *hex, size_t size, uint8_t *out) {
+    // maddubs folds each (high, low) nibble pair into high * 16 + low.
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i valid = _mm_set1_epi8(-1);
+        const __m128i a = nibblesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex + 2 * i)), valid);
+        const __m128i b =
+            nibblesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex + 2 * i + 16)), valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            return false;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bytes);
+    }
+    return decodeScalar(hex + 2 * i, size - i, out + i);
+}
+
+__attribute__((target("avx2"))) void encodeAvx2(const uint8_t *data, size_t size, char *out) {
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kHexDigits)));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+        const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+        // Unpacking works per 128-bit lane; permute restores byte order.
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * i + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    encodeSsse3(data + i, size - i, out + 2 * i);
+}
+
+__attribute__((target("avx2"))) inline __m256i nibblesAvx2(__m256i chars, __m256i &valid) {
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_letter));
+    const __m256i letter_value = _mm256_add_epi8(letter, _mm256_set1_epi8(10));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit), _mm256_andnot_si256(is_digit, letter_value));
+}
+
+__attribute__((target("avx2"))) bool decodeAvx2(const char *hex, size_t size, uint8_t *out) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i valid = _mm256_set1_epi8(-1);
+        const __m256i a =
+            nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(hex + 2 * i)), valid);
+        const __m256i b =
+            nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(hex + 2 * i + 32)), valid);
+        if (_mm256_movemask_epi8(valid) != -1) {
+            return false;
+        }
+        const __m256i packed =
+            _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+        // packus interleaves 64-bit quarters of its inputs per lane.
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return decodeSsse3(hex + 2 * i, size - i, out + i);
+}
+
+#endif
+
+struct HexKernels {
+    void (*encode)(const uint8_t *, size_t, char *) {encodeScalar};
+    bool (*decode)(const char *, size_t, uint8_t *) {decodeScalar};
+    const char *name {"scalar"};
+};
+
+HexKernels selectKernels() {
+    HexKernels kernels;
+#if TRDP_HEX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.encode = encodeAvx2;
+        kernels.decode = decodeAvx2;
+        kernels.name = "avx2";
+    } else if (__builtin_cpu_supports("ssse3")) {
+        kernels.encode = encodeSsse3;
+        kernels.decode = decodeSsse3;
+        kernels.name = "ssse3";
+    }
+#endif
+    return kernels;
+}
+
+const HexKernels &kernels() {
+    static const HexKernels selected = selectKernels();
+    return selected;
+}
+
+}  // namespace
+
+void hexEncode(const uint8_t *data, size_t size, char *out) {
+    if (size == 0) {
+        return;
+    }
+    kernels().encode(data, size, out);
+}
+
+bool hexDecode(const char *hex, size_t size, uint8_t *out) {
+    if (size == 0) {
+        return true;
+    }
+    return kernels().decode(hex, size, out);
+}
+
+std::vector<uint8_t> parseLooseHex(std::string_view raw) {
+    size_t digits = 0;
+    for (char ch : raw) {
+        if (kDecodeTable[static_cast<unsigned char>(ch)] >= 0) {
+            ++digits;
+        }
+    }
+    if (digits == 0) {
+        return {};
+    }
+    std::string filtered;
+    std::string_view source = raw;
+    if (digits != raw.size() || digits % 2 != 0) {
+        filtered.reserve(digits + 1);
+        if (digits % 2 != 0) {
+            filtered.push_back('0');
+        }
+        for (char ch : raw) {
+            if (kDecodeTable[static_cast<unsigned char>(ch)] >= 0) {
+                filtered.push_back(ch);
+            }
+        }
+        source = filtered;
+    }
+    std::vector<uint8_t> payload(source.size() / 2);
+    hexDecode(source.data(), payload.size(), payload.data());
+    return payload;
+}
+
+const char *hexKernelName() {
+    return kernels().name;
+}
+
+}  // namespace trdp::util
@@ -0,0 +1,123 @@
+#include "util/LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace trdp::util {
+
+namespace {
+
+constexpr size_t kSubBuckets = size_t {1} << LatencyHistogram::kSubBucketBits;
+
+int highestBit(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+}  // namespace
+
+int64_t LatencySnapshot::percentileNs(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            const auto upper = static_cast<int64_t>(LatencyHistogram::bucketUpperBound(i));
+            return std::clamp(upper, min_ns, max_ns);
+        }
+    }
+    return max_ns;
+}
+
+void LatencySnapshot::merge(const LatencySnapshot &other) {
+    if (other.count == 0) {
+        return;
+    }
+    min_ns = count == 0 ? other.min_ns : std::min(min_ns, other.min_ns);
+    max_ns = count == 0 ? other.max_ns : std::max(max_ns, other.max_ns);
+    count += other.count;
+    sum_ns += other.sum_ns;
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size(), 0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : min_(std::numeric_limits<int64_t>::max()) {
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) noexcept {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const int bit = highestBit(value);
+    if (bit >= kMaxValueBits) {
+        return kBucketCount - 1;
+    }
+    const int shift = bit - kSubBucketBits;
+    const auto sub = static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+    return (static_cast<size_t>(shift + 1) << kSubBucketBits) + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) noexcept {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const size_t shift = (index >> kSubBucketBits) - 1;
+    const uint64_t sub = kSubBuckets + (index & (kSubBuckets - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t value_ns) noexcept {
+    const int64_t value = std::max<int64_t>(value_ns, 0);
+    buckets_[bucketIndex(static_cast<uint64_t>(value))].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    int64_t current = min_.load(std::memory_order_relaxed);
+    while (value < current && !min_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const {
+    LatencySnapshot result;
+    result.buckets.resize(kBucketCount);
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        result.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += result.buckets[i];
+    }
+    // Use the bucket total so percentiles stay consistent with the buckets
+    // even when a sample lands between the loads.
+    result.count = total;
+    if (total > 0) {
+        result.sum_ns = sum_.load(std::memory_order_relaxed);
+        result.min_ns = min_.load(std::memory_order_relaxed);
+        result.max_ns = max_.load(std::memory_order_relaxed);
+        if (result.min_ns > result.max_ns) {
+            result.min_ns = result.max_ns;
+        }
+    }
+    return result;
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace trdp::util
@@ -3,9 +3,13 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <stdexcept>
+#include <variant>
 
 #include "db/Database.hpp"
+#include "util/TrafficRollup.hpp"
 
 namespace trdp::util {
 
@@ -34,109 +38,352 @@ int sanitizeOffset(int offset) {
     return offset;
 }
 
-}  // namespace
+// Timestamps are stored in SQLite's CURRENT_TIMESTAMP format, UTC.
+bool parseTimestamp(const std::string &text, std::time_t &out) {
+    std::tm tm {};
+    if (std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+                    &tm.tm_sec) != 6) {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+#ifdef _WIN32
+    out = _mkgmtime(&tm);
+#else
+    out = timegm(&tm);
+#endif
+    return out != static_cast<std::time_t>(-1);
+}
 
-LogService::LogService(db::Database &database) : database_(database) {}
+std::string formatTimestamp(std::time_t time) {
+    std::tm tm {};
+#ifdef _WIN32
+    gmtime_s(&tm, &time);
+#else
+    gmtime_r(&time, &tm);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    return buffer;
+}
 
-std::vector<TrdpLogEntry> LogService::getTrdpLogs(int limit, int offset, std::optional<std::string> type_filter,
-                                                  std::optional<std::string> direction_filter) {
-    sqlite3 *db = database_.handle();
-    if (db == nullptr) {
-        return {};
+// Appends the repeats of `run`, newest first, until `out` holds `cap`
+// entries.
+void expandRun(const TrdpLogEntry &run, std::vector<TrdpLogEntry> &out, size_t cap) {
+    std::time_t first = 0;
+    std::time_t last = 0;
+    const bool timed = run.repeat_count > 1 && parseTimestamp(run.timestamp, first) &&
+                       parseTimestamp(run.last_timestamp, last) && last >= first;
+    for (int64_t i = run.repeat_count - 1; i >= 0 && out.size() < cap; --i) {
+        TrdpLogEntry entry = run;
+        entry.repeat_count = 1;
+        if (timed) {
+            entry.timestamp = formatTimestamp(first + static_cast<std::time_t>((last - first) * i /
+                                                                                (run.repeat_count - 1)));
+        }
+        entry.last_timestamp = entry.timestamp;
+        out.push_back(std::move(entry));
     }
+}
 
-    std::string sql =
-        "SELECT id, direction, type, msg_id, src_ip, dst_ip, payload, timestamp FROM trdp_logs";
-    std::vector<std::string> clauses;
-    std::vector<std::string> values;
+}  // namespace
+
+LogService::LogService(db::Database &database, const TrdpLogWriterOptions &writer)
+    : database_(database),
+      partitions_([&]() {
+          auto storage = writer.storage;
+          if (storage.directory.empty()) {
+              storage.directory = TrdpLogPartitions::defaultDirectory(database.path());
+          }
+          return storage;
+      }()),
+      max_run_duration_(writer.deduplicate_pd ? writer.max_run_duration : std::chrono::seconds{0}) {}
 
-    if (type_filter && !type_filter->empty()) {
-        auto value = toUpperCopy(*type_filter);
+std::vector<TrdpLogEntry> LogService::getTrdpLogs(const TrdpLogQuery &query) {
+    // The WHERE clause is the same for every partition.
+    std::string where;
+    std::vector<std::variant<int64_t, std::string>> values;
+    auto addClause = [&](const char *clause, std::variant<int64_t, std::string> value) {
+        where += where.empty() ? " WHERE " : " AND ";
+        where += clause;
+        values.push_back(std::move(value));
+    };
+    if (query.before_id) {
+        addClause("id < ?", *query.before_id);
+    }
+    if (query.type && !query.type->empty()) {
+        auto value = toUpperCopy(*query.type);
         if (value == "PD" || value == "MD") {
-            clauses.push_back("type = ?");
-            values.push_back(value);
+            addClause("type = ?", value);
         }
     }
-    if (direction_filter && !direction_filter->empty()) {
-        auto value = toUpperCopy(*direction_filter);
+    if (query.direction && !query.direction->empty()) {
+        auto value = toUpperCopy(*query.direction);
         if (value == "IN" || value == "OUT") {
-            clauses.push_back("direction = ?");
-            values.push_back(value);
+            addClause("direction = ?", value);
         }
     }
+    if (query.msg_id) {
+        addClause("msg_id = ?", static_cast<int64_t>(*query.msg_id));
+    }
+    if (query.src_ip && !query.src_ip->empty()) {
+        addClause("src_ip = ?", *query.src_ip);
+    }
+    if (query.from) {
+        addClause("COALESCE(last_timestamp, timestamp) >= ?", formatTimestamp(static_cast<std::time_t>(*query.from)));
+    }
+    if (query.to) {
+        addClause("timestamp < ?", formatTimestamp(static_cast<std::time_t>(*query.to)));
+    }
 
-    if (!clauses.empty()) {
-        sql += " WHERE ";
-        for (size_t i = 0; i < clauses.size(); ++i) {
-            if (i != 0) {
-                sql += " AND ";
+    auto prepare = [&](db::Connection &connection, const std::string &sql) {
+        auto stmt = connection.prepare(sql);
+        if (!stmt) {
+            throw std::runtime_error{"Failed to prepare TRDP log query"};
+        }
+        int param_index = 1;
+        for (const auto &value : values) {
+            if (const auto *number = std::get_if<int64_t>(&value)) {
+                sqlite3_bind_int64(stmt, param_index++, *number);
+            } else {
+                sqlite3_bind_text(stmt, param_index++, std::get<std::string>(value).c_str(), -1, SQLITE_TRANSIENT);
             }
-            sql += clauses[i];
         }
-    }
+        return stmt;
+    };
 
-    sql += " ORDER BY id DESC LIMIT ? OFFSET ?";
+    const int limit = sanitizeLimit(query.limit);
+    int skip = sanitizeOffset(query.offset);
+    int rows = 0;
+    std::vector<TrdpLogEntry> logs;
+
+    // Id of the oldest row logged at or after `unix_seconds`. This is the
+    // smallest such id only because TrdpLogWriter stamps records under the
+    // same lock that orders them, so ids never decrease as time goes on;
+    // rows sharing a second are ordered by id so the smallest of them is
+    // taken. Both orders come straight from the timestamp index, whose
+    // entries end with the id.
+    auto firstIdFrom = [&](db::Connection &connection, int64_t unix_seconds) -> std::optional<int64_t> {
+        auto stmt =
+            connection.prepare("SELECT id FROM trdp_logs WHERE timestamp >= ? ORDER BY timestamp, id LIMIT 1");
+        if (!stmt) {
+            throw std::runtime_error{"Failed to prepare TRDP log query"};
+        }
+        const auto timestamp = formatTimestamp(static_cast<std::time_t>(unix_seconds));
+        sqlite3_bind_text(stmt, 1, timestamp.c_str(), -1, SQLITE_TRANSIENT);
+        std::optional<int64_t> id;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            id = sqlite3_column_int64(stmt, 0);
+        }
+        return id;
+    };
+
+    // Reads one source; returns false once the page is complete.
+    auto readSource = [&](db::Connection &connection) {
+        // Ids grow with time, so the window is turned into an id range
+        // through the timestamp index and the scan stays inside it; the
+        // timestamp clauses still decide which rows match. A run that
+        // overlaps `from` started at most max_run_duration before it.
+        std::string id_range;
+        std::vector<int64_t> id_bounds;
+        if (query.from) {
+            const auto first = firstIdFrom(connection, *query.from - max_run_duration_.count());
+            if (!first) {
+                return true;
+            }
+            id_range += " AND id >= ?";
+            id_bounds.push_back(*first);
+        }
+        if (query.to) {
+            if (const auto after = firstIdFrom(connection, *query.to)) {
+                id_range += " AND id < ?";
+                id_bounds.push_back(*after);
+            }
+        }
+        auto bindIdRange = [&](sqlite3_stmt *stmt) {
+            int param_index = static_cast<int>(values.size()) + 1;
+            for (const int64_t bound : id_bounds) {
+                sqlite3_bind_int64(stmt, param_index++, bound);
+            }
+            return param_index;
+        };
+
+        if (skip > 0) {
+            auto stmt = prepare(connection, "SELECT COUNT(*) FROM trdp_logs" + where + id_range);
+            bindIdRange(stmt);
+            const int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+            if (skip >= count) {
+                skip -= count;
+                return true;
+            }
+        }
+        auto stmt =
+            prepare(connection,
+                    "SELECT id, direction, type, msg_id, src_ip, dst_ip, payload, timestamp, repeat_count, "
+                    "COALESCE(last_timestamp, timestamp) FROM trdp_logs" +
+                        where + id_range + " ORDER BY id DESC LIMIT ? OFFSET ?");
+        const int param_index = bindIdRange(stmt);
+        sqlite3_bind_int(stmt, param_index, limit - rows);
+        sqlite3_bind_int(stmt, param_index + 1, skip);
+        skip = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            TrdpLogEntry entry;
+            entry.id = sqlite3_column_int64(stmt, 0);
+            const unsigned char *dir = sqlite3_column_text(stmt, 1);
+            const unsigned char *type = sqlite3_column_text(stmt, 2);
+            entry.direction = dir ? reinterpret_cast<const char *>(dir) : "";
+            entry.type = type ? reinterpret_cast<const char *>(type) : "";
+            entry.msg_id = sqlite3_column_int(stmt, 3);
+            const unsigned char *src = sqlite3_column_text(stmt, 4);
+            const unsigned char *dst = sqlite3_column_text(stmt, 5);
+            entry.src_ip = src ? reinterpret_cast<const char *>(src) : "";
+            entry.dst_ip = dst ? reinterpret_cast<const char *>(dst) : "";
+            const void *blob = sqlite3_column_blob(stmt, 6);
+            int blob_size = sqlite3_column_bytes(stmt, 6);
+            if (blob != nullptr && blob_size > 0) {
+                const auto *data = static_cast<const uint8_t *>(blob);
+                entry.payload.assign(data, data + blob_size);
+            }
+            const unsigned char *ts = sqlite3_column_text(stmt, 7);
+            entry.timestamp = ts ? reinterpret_cast<const char *>(ts) : "";
+            entry.repeat_count = std::max<int64_t>(sqlite3_column_int64(stmt, 8), 1);
+            const unsigned char *last_ts = sqlite3_column_text(stmt, 9);
+            entry.last_timestamp = last_ts ? reinterpret_cast<const char *>(last_ts) : "";
+            ++rows;
+            if (query.expand_runs) {
+                if (logs.size() < kMaxExpandedEntries) {
+                    expandRun(entry, logs, kMaxExpandedEntries);
+                }
+            } else {
+                logs.push_back(std::move(entry));
+            }
+        }
+        return rows < limit;
+    };
 
-    sqlite3_stmt *stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        throw std::runtime_error{"Failed to prepare TRDP log query"};
+    const auto partitions = partitions_.list();
+    for (auto it = partitions.rbegin(); it != partitions.rend(); ++it) {
+        if ((query.from && it->end <= *query.from) || (query.to && it->start >= *query.to)) {
+            continue;
+        }
+        // Retention may remove a partition between listing and opening it.
+        sqlite3 *db = TrdpLogPartitions::openForReading(it->path);
+        if (db == nullptr) {
+            continue;
+        }
+        db::Connection partition(db);
+        if (!readSource(partition)) {
+            return logs;
+        }
     }
+    readSource(*database_.reader());
+    return logs;
+}
 
+std::vector<RollupEntry> LogService::getRollups(const RollupQuery &query) {
+    if (std::find(std::begin(kRollupResolutions), std::end(kRollupResolutions), query.resolution_s) ==
+        std::end(kRollupResolutions)) {
+        throw std::invalid_argument{"resolution must be 1s, 1m or 1h"};
+    }
+    std::string sql =
+        "SELECT resolution, bucket_start, direction, msg_id, src_ip, dst_ip, packets, bytes, min_gap_ns, "
+        "max_gap_ns, changes, last_payload FROM trdp_rollups WHERE resolution = ?";
+    if (query.from) {
+        sql += " AND bucket_start >= ?";
+    }
+    if (query.to) {
+        sql += " AND bucket_start < ?";
+    }
+    if (query.msg_id) {
+        sql += " AND msg_id = ?";
+    }
+    std::string direction;
+    if (query.direction && !query.direction->empty()) {
+        direction = toUpperCopy(*query.direction);
+        if (direction == "IN" || direction == "OUT") {
+            sql += " AND direction = ?";
+        } else {
+            direction.clear();
+        }
+    }
+    sql += " ORDER BY bucket_start DESC, msg_id, direction, src_ip, dst_ip LIMIT ?";
+
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
+        throw std::runtime_error{"Failed to prepare rollup query"};
+    }
     int param_index = 1;
-    for (const auto &value : values) {
-        sqlite3_bind_text(stmt, param_index++, value.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, param_index++, query.resolution_s);
+    if (query.from) {
+        sqlite3_bind_int64(stmt, param_index++, *query.from);
     }
-    sqlite3_bind_int(stmt, param_index++, sanitizeLimit(limit));
-    sqlite3_bind_int(stmt, param_index++, sanitizeOffset(offset));
+    if (query.to) {
+        sqlite3_bind_int64(stmt, param_index++, *query.to);
+    }
+    if (query.msg_id) {
+        sqlite3_bind_int(stmt, param_index++, *query.msg_id);
+    }
+    if (!direction.empty()) {
+        sqlite3_bind_text(stmt, param_index++, direction.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_int(stmt, param_index++, sanitizeLimit(query.limit));
 
-    std::vector<TrdpLogEntry> logs;
+    auto text = [&stmt](int column) {
+        const unsigned char *value = sqlite3_column_text(stmt, column);
+        return value ? std::string(reinterpret_cast<const char *>(value)) : std::string();
+    };
+    auto optionalInt = [&stmt](int column) -> std::optional<int64_t> {
+        if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+            return std::nullopt;
+        }
+        return sqlite3_column_int64(stmt, column);
+    };
+
+    std::vector<RollupEntry> rollups;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        TrdpLogEntry entry;
-        entry.id = sqlite3_column_int(stmt, 0);
-        const unsigned char *dir = sqlite3_column_text(stmt, 1);
-        const unsigned char *type = sqlite3_column_text(stmt, 2);
-        entry.direction = dir ? reinterpret_cast<const char *>(dir) : "";
-        entry.type = type ? reinterpret_cast<const char *>(type) : "";
+        RollupEntry entry;
+        entry.resolution_s = sqlite3_column_int(stmt, 0);
+        entry.bucket_start = sqlite3_column_int64(stmt, 1);
+        entry.direction = text(2);
         entry.msg_id = sqlite3_column_int(stmt, 3);
-        const unsigned char *src = sqlite3_column_text(stmt, 4);
-        const unsigned char *dst = sqlite3_column_text(stmt, 5);
-        entry.src_ip = src ? reinterpret_cast<const char *>(src) : "";
-        entry.dst_ip = dst ? reinterpret_cast<const char *>(dst) : "";
-        const void *blob = sqlite3_column_blob(stmt, 6);
-        int blob_size = sqlite3_column_bytes(stmt, 6);
+        entry.src_ip = text(4);
+        entry.dst_ip = text(5);
+        entry.packets = static_cast<uint64_t>(sqlite3_column_int64(stmt, 6));
+        entry.bytes = static_cast<uint64_t>(sqlite3_column_int64(stmt, 7));
+        entry.min_gap_ns = optionalInt(8);
+        entry.max_gap_ns = optionalInt(9);
+        entry.changes = static_cast<uint64_t>(sqlite3_column_int64(stmt, 10));
+        const void *blob = sqlite3_column_blob(stmt, 11);
+        const int blob_size = sqlite3_column_bytes(stmt, 11);
         if (blob != nullptr && blob_size > 0) {
             const auto *data = static_cast<const uint8_t *>(blob);
-            entry.payload.assign(data, data + blob_size);
-        } else {
-            entry.payload.clear();
+            entry.last_payload.assign(data, data + blob_size);
         }
-        const unsigned char *ts = sqlite3_column_text(stmt, 7);
-        entry.timestamp = ts ? reinterpret_cast<const char *>(ts) : "";
-        logs.push_back(std::move(entry));
+        rollups.push_back(std::move(entry));
     }
 
-    sqlite3_finalize(stmt);
-    return logs;
+    return rollups;
 }
 
-std::vector<AppLogEntry> LogService::getAppLogs(int limit, int offset, std::optional<std::string> level_filter) {
-    sqlite3 *db = database_.handle();
-    if (db == nullptr) {
-        return {};
-    }
-
+std::vector<AppLogEntry> LogService::getAppLogs(int limit, int offset, std::optional<std::string> level_filter,
+                                                std::optional<int64_t> before_id) {
     std::string sql = "SELECT id, level, message, timestamp FROM app_logs";
     bool has_filter = false;
     std::string normalized_level;
     if (level_filter && !level_filter->empty()) {
         normalized_level = toUpperCopy(*level_filter);
         has_filter = true;
-        sql += " WHERE UPPER(level) = ?";
+        sql += " WHERE level = ?";
+    }
+    if (before_id) {
+        sql += has_filter ? " AND id < ?" : " WHERE id < ?";
     }
     sql += " ORDER BY id DESC LIMIT ? OFFSET ?";
 
-    sqlite3_stmt *stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.reader();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         throw std::runtime_error{"Failed to prepare app log query"};
     }
 
@@ -144,13 +391,16 @@ std::vector<AppLogEntry> LogService::getAppLogs(int limit, int offset, std::opti
     if (has_filter) {
         sqlite3_bind_text(stmt, param_index++, normalized_level.c_str(), -1, SQLITE_TRANSIENT);
     }
+    if (before_id) {
+        sqlite3_bind_int64(stmt, param_index++, *before_id);
+    }
     sqlite3_bind_int(stmt, param_index++, sanitizeLimit(limit));
     sqlite3_bind_int(stmt, param_index++, sanitizeOffset(offset));
 
     std::vector<AppLogEntry> logs;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         AppLogEntry entry;
-        entry.id = sqlite3_column_int(stmt, 0);
+        entry.id = sqlite3_column_int64(stmt, 0);
         const unsigned char *level = sqlite3_column_text(stmt, 1);
         const unsigned char *message = sqlite3_column_text(stmt, 2);
         const unsigned char *timestamp = sqlite3_column_text(stmt, 3);
@@ -160,26 +410,21 @@ std::vector<AppLogEntry> LogService::getAppLogs(int limit, int offset, std::opti
         logs.push_back(std::move(entry));
     }
 
-    sqlite3_finalize(stmt);
     return logs;
 }
 
 void LogService::appendAppLog(const std::string &level, const std::string &message) {
-    sqlite3 *db = database_.handle();
-    if (db == nullptr) {
-        return;
-    }
-
-    sqlite3_stmt *stmt = nullptr;
     const char *sql = "INSERT INTO app_logs (level, message) VALUES (?, ?);";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    auto connection = database_.writer();
+    auto stmt = connection->prepare(sql);
+    if (!stmt) {
         return;
     }
 
-    sqlite3_bind_text(stmt, 1, level.c_str(), -1, SQLITE_TRANSIENT);
+    const std::string normalized_level = toUpperCopy(level);
+    sqlite3_bind_text(stmt, 1, normalized_level.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 2, message.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
 }
 
 }  // namespace trdp::util
@@ -0,0 +1,146 @@
+#include "util/Metrics.hpp"
+
+#include <charconv>
+#include <cmath>
+
+namespace trdp::util {
+
+namespace {
+
+std::atomic<size_t> next_shard {0};
+
+constexpr std::array<std::pair<double, std::string_view>, 4> kQuantiles = {{
+    {0.5, "0.5"},
+    {0.9, "0.9"},
+    {0.99, "0.99"},
+    {0.999, "0.999"},
+}};
+
+void appendLabelValue(std::string &out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+}
+
+}  // namespace
+
+size_t metricShard() noexcept {
+    thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+}
+
+uint64_t ShardedCounter::value() const noexcept {
+    uint64_t total = 0;
+    for (const auto &shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void OpenMetricsWriter::family(std::string_view name, std::string_view type, std::string_view help,
+                               std::string_view unit) {
+    out_ += "# TYPE ";
+    out_ += name;
+    out_ += ' ';
+    out_ += type;
+    out_ += '\n';
+    if (!unit.empty()) {
+        out_ += "# UNIT ";
+        out_ += name;
+        out_ += ' ';
+        out_ += unit;
+        out_ += '\n';
+    }
+    out_ += "# HELP ";
+    out_ += name;
+    out_ += ' ';
+    out_ += help;
+    out_ += '\n';
+}
+
+void OpenMetricsWriter::counter(std::string_view name, uint64_t value, const MetricLabels &labels) {
+    sample(name, "_total", labels, {}, {});
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out_.append(digits, static_cast<size_t>(result.ptr - digits));
+    out_ += '\n';
+}
+
+void OpenMetricsWriter::gauge(std::string_view name, double value, const MetricLabels &labels) {
+    sample(name, {}, labels, {}, {});
+    number(value);
+    out_ += '\n';
+}
+
+void OpenMetricsWriter::summary(std::string_view name, const LatencySnapshot &latency, const MetricLabels &labels) {
+    for (const auto &[fraction, text] : kQuantiles) {
+        sample(name, {}, labels, "quantile", text);
+        // An empty summary has no quantiles; OpenMetrics spells that NaN.
+        number(latency.count > 0 ? static_cast<double>(latency.percentileNs(fraction)) / 1e9 : std::nan(""));
+        out_ += '\n';
+    }
+    sample(name, "_sum", labels, {}, {});
+    number(static_cast<double>(latency.sum_ns) / 1e9);
+    out_ += '\n';
+    sample(name, "_count", labels, {}, {});
+    number(static_cast<double>(latency.count));
+    out_ += '\n';
+}
+
+std::string OpenMetricsWriter::finish() {
+    out_ += "# EOF\n";
+    return std::move(out_);
+}
+
+void OpenMetricsWriter::sample(std::string_view name, std::string_view suffix, const MetricLabels &labels,
+                               std::string_view extra_label, std::string_view extra_value) {
+    out_ += name;
+    out_ += suffix;
+    if (labels.empty() && extra_label.empty()) {
+        out_ += ' ';
+        return;
+    }
+    out_ += '{';
+    bool first = true;
+    auto append = [&](std::string_view key, std::string_view value) {
+        if (!first) {
+            out_ += ',';
+        }
+        first = false;
+        out_ += key;
+        out_ += "=\"";
+        appendLabelValue(out_, value);
+        out_ += '"';
+    };
+    for (const auto &[key, value] : labels) {
+        append(key, value);
+    }
+    if (!extra_label.empty()) {
+        append(extra_label, extra_value);
+    }
+    out_ += "} ";
+}
+
+void OpenMetricsWriter::number(double value) {
+    if (std::isnan(value)) {
+        out_ += "NaN";
+        return;
+    }
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out_.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+}  // namespace trdp::util
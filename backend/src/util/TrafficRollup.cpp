@@ -0,0 +1,225 @@
+#include "util/TrafficRollup.hpp"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "db/Database.hpp"
+
+namespace trdp::util {
+
+namespace {
+
+// Series without traffic for this long are forgotten, so keys of telegrams
+// that went away do not accumulate.
+constexpr auto kIdleSeriesTimeout = std::chrono::hours(1);
+
+int64_t unixSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+// Minute and hour rows receive every closed second, and a flushed second
+// may be written again when more packets arrive within it, so all
+// resolutions are merged with an upsert.
+const char *kUpsertSql =
+    "INSERT INTO trdp_rollups (resolution, bucket_start, direction, msg_id, src_ip, dst_ip, packets, bytes, "
+    "min_gap_ns, max_gap_ns, changes, last_payload) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT (resolution, bucket_start, msg_id, direction, src_ip, dst_ip) DO UPDATE SET "
+    "packets = packets + excluded.packets, bytes = bytes + excluded.bytes, "
+    "min_gap_ns = COALESCE(MIN(min_gap_ns, excluded.min_gap_ns), min_gap_ns, excluded.min_gap_ns), "
+    "max_gap_ns = COALESCE(MAX(max_gap_ns, excluded.max_gap_ns), max_gap_ns, excluded.max_gap_ns), "
+    "changes = changes + excluded.changes, last_payload = excluded.last_payload;";
+const char *kPruneSql = "DELETE FROM trdp_rollups WHERE resolution = ? AND bucket_start < ?;";
+
+void bindOptionalGap(sqlite3_stmt *stmt, int index, int64_t gap_ns) {
+    if (gap_ns >= 0) {
+        sqlite3_bind_int64(stmt, index, gap_ns);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+}  // namespace
+
+TrafficRollup::TrafficRollup(db::Database &database, TrafficRollupOptions options)
+    : database_(database), options_(options) {
+    // Prepared here so that a schema problem fails construction; the
+    // writer connection keeps them cached for the flushes.
+    auto connection = database_.writer();
+    if (!connection->prepare(kUpsertSql)) {
+        throw std::runtime_error{"Failed to prepare TRDP rollup upsert"};
+    }
+    if (!connection->prepare(kPruneSql)) {
+        throw std::runtime_error{"Failed to prepare TRDP rollup pruning"};
+    }
+    thread_ = std::thread(&TrafficRollup::run, this);
+}
+
+TrafficRollup::~TrafficRollup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TrafficRollup::record(std::string_view direction, int msg_id, std::string_view src_ip, std::string_view dst_ip,
+                           const uint8_t *payload, size_t size) {
+    const auto arrival = std::chrono::steady_clock::now();
+    const int64_t second = unixSeconds(std::chrono::system_clock::now());
+    std::lock_guard<std::mutex> lock(mutex_);
+    key_.assign(direction);
+    key_ += '|';
+    key_ += std::to_string(msg_id);
+    key_ += '|';
+    key_ += src_ip;
+    key_ += '|';
+    key_ += dst_ip;
+    auto [it, inserted] = series_.try_emplace(key_);
+    Series &series = it->second;
+    Bucket &bucket = series.bucket;
+    if (inserted) {
+        bucket.direction.assign(direction);
+        bucket.msg_id = msg_id;
+        bucket.src_ip.assign(src_ip);
+        bucket.dst_ip.assign(dst_ip);
+    }
+    if (bucket.packets > 0 && bucket.start != second) {
+        closeBucketLocked(bucket);
+    }
+    bucket.start = second;
+    ++bucket.packets;
+    bucket.bytes += size;
+    if (series.last_packet) {
+        const int64_t gap = std::chrono::duration_cast<std::chrono::nanoseconds>(arrival - *series.last_packet).count();
+        if (bucket.min_gap_ns < 0 || gap < bucket.min_gap_ns) {
+            bucket.min_gap_ns = gap;
+        }
+        bucket.max_gap_ns = std::max(bucket.max_gap_ns, gap);
+        if (bucket.last_payload.size() != size ||
+            (size > 0 && !std::equal(payload, payload + size, bucket.last_payload.begin()))) {
+            ++bucket.changes;
+        }
+    }
+    series.last_packet = arrival;
+    if (payload != nullptr) {
+        bucket.last_payload.assign(payload, payload + size);
+    } else {
+        bucket.last_payload.clear();
+    }
+}
+
+void TrafficRollup::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Wake shortly after each second boundary.
+        const auto now = std::chrono::system_clock::now();
+        const auto next = std::chrono::floor<std::chrono::seconds>(now) + std::chrono::seconds(1) +
+                          std::chrono::milliseconds(5);
+        wake_.wait_for(lock, next - now, [this]() { return stopping_; });
+        const int64_t second = unixSeconds(std::chrono::system_clock::now());
+        closeBucketsLocked(stopping_ ? std::numeric_limits<int64_t>::max() : second);
+        pending_.swap(flushing_);
+        const size_t count = std::exchange(pending_count_, 0);
+        lock.unlock();
+        writeBuckets(flushing_, count);
+        if (second - last_prune_ >= 60) {
+            prune(second);
+            last_prune_ = second;
+        }
+        lock.lock();
+    }
+}
+
+void TrafficRollup::closeBucketsLocked(int64_t before) {
+    const auto idle_since = std::chrono::steady_clock::now() - kIdleSeriesTimeout;
+    for (auto it = series_.begin(); it != series_.end();) {
+        Bucket &bucket = it->second.bucket;
+        if (bucket.packets > 0 && bucket.start < before) {
+            closeBucketLocked(bucket);
+        }
+        if (bucket.packets == 0 && it->second.last_packet && *it->second.last_packet < idle_since) {
+            it = series_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TrafficRollup::closeBucketLocked(Bucket &bucket) {
+    if (pending_count_ < pending_.size()) {
+        pending_[pending_count_] = bucket;
+    } else {
+        pending_.push_back(bucket);
+    }
+    ++pending_count_;
+    bucket.packets = 0;
+    bucket.bytes = 0;
+    bucket.min_gap_ns = -1;
+    bucket.max_gap_ns = -1;
+    bucket.changes = 0;
+}
+
+void TrafficRollup::writeBuckets(const std::vector<Bucket> &buckets, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    auto connection = database_.writer();
+    sqlite3 *db = connection->handle();
+    auto upsert = connection->prepare(kUpsertSql);
+    if (!upsert) {
+        std::cerr << "Failed to prepare TRDP rollup upsert: " << sqlite3_errmsg(db) << std::endl;
+        return;
+    }
+    const bool in_transaction = sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    for (size_t i = 0; i < count; ++i) {
+        const Bucket &bucket = buckets[i];
+        for (int resolution : kRollupResolutions) {
+            sqlite3_bind_int(upsert, 1, resolution);
+            sqlite3_bind_int64(upsert, 2, bucket.start - bucket.start % resolution);
+            sqlite3_bind_text(upsert, 3, bucket.direction.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int(upsert, 4, bucket.msg_id);
+            sqlite3_bind_text(upsert, 5, bucket.src_ip.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(upsert, 6, bucket.dst_ip.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int64(upsert, 7, static_cast<sqlite3_int64>(bucket.packets));
+            sqlite3_bind_int64(upsert, 8, static_cast<sqlite3_int64>(bucket.bytes));
+            bindOptionalGap(upsert, 9, bucket.min_gap_ns);
+            bindOptionalGap(upsert, 10, bucket.max_gap_ns);
+            sqlite3_bind_int64(upsert, 11, static_cast<sqlite3_int64>(bucket.changes));
+            sqlite3_bind_blob(upsert, 12, bucket.last_payload.data(), static_cast<int>(bucket.last_payload.size()),
+                              SQLITE_STATIC);
+            sqlite3_step(upsert);
+            sqlite3_reset(upsert);
+            sqlite3_clear_bindings(upsert);
+        }
+    }
+    if (in_transaction && sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to commit TRDP rollups: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+}
+
+void TrafficRollup::prune(int64_t now) {
+    const std::pair<int, std::chrono::seconds> retention[] = {
+        {1, options_.second_retention}, {60, options_.minute_retention}, {3600, options_.hour_retention}};
+    auto connection = database_.writer();
+    auto prune = connection->prepare(kPruneSql);
+    if (!prune) {
+        return;
+    }
+    for (const auto &[resolution, keep] : retention) {
+        sqlite3_bind_int(prune, 1, resolution);
+        sqlite3_bind_int64(prune, 2, now - keep.count());
+        sqlite3_step(prune);
+        sqlite3_reset(prune);
+    }
+}
+
+}  // namespace trdp::util
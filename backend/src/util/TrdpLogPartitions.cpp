@@ -0,0 +1,254 @@
+#include "util/TrdpLogPartitions.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace trdp::util {
+
+namespace {
+
+constexpr std::string_view kPrefix = "trdp_logs-";
+constexpr std::string_view kSuffix = ".db";
+// Side files SQLite may leave next to a partition.
+constexpr const char *kSideFiles[] = {"-journal", "-wal", "-shm"};
+// Writers and readers of the same partition wait this long for each other.
+constexpr int kBusyTimeoutMs = 2000;
+
+// WAL, as for the main database: queries read the partition being written
+// without ever holding up the log writer.
+const char *kPartitionSchema =
+    "PRAGMA journal_mode = WAL;"
+    "PRAGMA synchronous = NORMAL;"
+    "CREATE TABLE IF NOT EXISTS trdp_logs ("
+    "id INTEGER PRIMARY KEY,"
+    "direction TEXT NOT NULL,"
+    "type TEXT NOT NULL,"
+    "msg_id INTEGER,"
+    "src_ip TEXT,"
+    "dst_ip TEXT,"
+    "payload BLOB,"
+    "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,"
+    "repeat_count INTEGER NOT NULL DEFAULT 1,"
+    "last_timestamp DATETIME);"
+    // Same indexes as the main database's trdp_logs, see
+    // Database::initializeSchema().
+    "CREATE INDEX IF NOT EXISTS idx_trdp_logs_type ON trdp_logs (type);"
+    "CREATE INDEX IF NOT EXISTS idx_trdp_logs_msg_id ON trdp_logs (msg_id);"
+    "CREATE INDEX IF NOT EXISTS idx_trdp_logs_src_ip ON trdp_logs (src_ip);"
+    "CREATE INDEX IF NOT EXISTS idx_trdp_logs_timestamp ON trdp_logs (timestamp);";
+
+int64_t spanSeconds(LogPartitionSpan span) {
+    return span == LogPartitionSpan::kHour ? 3600 : 86400;
+}
+
+uint64_t fileBytes(const std::filesystem::path &path) {
+    std::error_code error;
+    uint64_t bytes = 0;
+    const auto main_size = std::filesystem::file_size(path, error);
+    if (!error) {
+        bytes += main_size;
+    }
+    for (const char *suffix : kSideFiles) {
+        const auto side_size = std::filesystem::file_size(path.string() + suffix, error);
+        if (!error) {
+            bytes += side_size;
+        }
+    }
+    return bytes;
+}
+
+// Highest row id in the partition; 0 when it is empty or unreadable.
+int64_t maxRowId(const std::filesystem::path &path) {
+    sqlite3 *db = TrdpLogPartitions::openForReading(path);
+    if (db == nullptr) {
+        return 0;
+    }
+    sqlite3_stmt *stmt = nullptr;
+    int64_t max_id = 0;
+    if (sqlite3_prepare_v2(db, "SELECT MAX(id) FROM trdp_logs;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        max_id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return max_id;
+}
+
+void removePartition(const std::filesystem::path &path) {
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+    for (const char *suffix : kSideFiles) {
+        std::filesystem::remove(path.string() + suffix, ignored);
+    }
+}
+
+}  // namespace
+
+TrdpLogPartitions::TrdpLogPartitions(TrdpLogStorageOptions options) : options_(std::move(options)) {}
+
+std::vector<LogPartition> TrdpLogPartitions::list() const {
+    std::vector<LogPartition> partitions;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(options_.directory, error)) {
+        if (!entry.is_regular_file(error)) {
+            continue;
+        }
+        auto partition = parseName(entry.path().filename().string());
+        if (!partition) {
+            continue;
+        }
+        partition->path = entry.path();
+        partition->bytes = fileBytes(entry.path());
+        partitions.push_back(std::move(*partition));
+    }
+    std::sort(partitions.begin(), partitions.end(), [](const LogPartition &a, const LogPartition &b) {
+        return a.start != b.start ? a.start < b.start : a.end < b.end;
+    });
+    // After the span changed, files of the old span overlap those of the
+    // new one. Their rows still do not interleave in time, so overlapping
+    // files are put in the order of their ids, i.e. the order they were
+    // written in.
+    for (size_t first = 0; first < partitions.size();) {
+        size_t last = first + 1;
+        int64_t end = partitions[first].end;
+        while (last < partitions.size() && partitions[last].start < end) {
+            end = std::max(end, partitions[last].end);
+            ++last;
+        }
+        if (last - first > 1) {
+            std::vector<std::pair<int64_t, LogPartition>> overlapping;
+            for (size_t i = first; i < last; ++i) {
+                overlapping.emplace_back(maxRowId(partitions[i].path), std::move(partitions[i]));
+            }
+            std::stable_sort(overlapping.begin(), overlapping.end(),
+                             [](const auto &a, const auto &b) { return a.first < b.first; });
+            for (size_t i = first; i < last; ++i) {
+                partitions[i] = std::move(overlapping[i - first].second);
+            }
+        }
+        first = last;
+    }
+    return partitions;
+}
+
+LogPartition TrdpLogPartitions::partitionAt(int64_t unix_seconds) const {
+    const int64_t span = spanSeconds(options_.span);
+    LogPartition partition;
+    partition.start = unix_seconds - ((unix_seconds % span) + span) % span;
+    partition.end = partition.start + span;
+
+    const std::time_t start = static_cast<std::time_t>(partition.start);
+    std::tm tm {};
+#ifdef _WIN32
+    gmtime_s(&tm, &start);
+#else
+    gmtime_r(&start, &tm);
+#endif
+    char stamp[16];
+    std::strftime(stamp, sizeof(stamp), options_.span == LogPartitionSpan::kHour ? "%Y%m%d%H" : "%Y%m%d", &tm);
+    partition.path = options_.directory / (std::string(kPrefix) + stamp + std::string(kSuffix));
+    partition.bytes = fileBytes(partition.path);
+    return partition;
+}
+
+size_t TrdpLogPartitions::enforceRetention(int64_t now, const std::filesystem::path &keep) const {
+    auto partitions = list();
+    const int64_t oldest_end = now - std::chrono::duration_cast<std::chrono::seconds>(options_.max_age).count();
+    uint64_t total = 0;
+    for (const auto &partition : partitions) {
+        total += partition.bytes;
+    }
+    size_t removed = 0;
+    for (const auto &partition : partitions) {
+        if (partition.path == keep) {
+            continue;
+        }
+        const bool expired = partition.end <= oldest_end;
+        const bool over_size = options_.max_bytes > 0 && total > options_.max_bytes;
+        if (!expired && !over_size) {
+            // Not necessarily the last one to go: overlapping partitions
+            // are listed by id, not by end.
+            continue;
+        }
+        removePartition(partition.path);
+        total -= partition.bytes;
+        ++removed;
+    }
+    return removed;
+}
+
+sqlite3 *TrdpLogPartitions::openForWriting(const std::filesystem::path &path) {
+    std::error_code ignored;
+    std::filesystem::create_directories(path.parent_path(), ignored);
+    sqlite3 *db = nullptr;
+    if (sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) !=
+        SQLITE_OK) {
+        sqlite3_close(db);
+        throw std::runtime_error{"Unable to open TRDP log partition " + path.string()};
+    }
+    sqlite3_busy_timeout(db, kBusyTimeoutMs);
+    char *err_msg = nullptr;
+    if (sqlite3_exec(db, kPartitionSchema, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::string error = err_msg ? err_msg : "Unknown error";
+        sqlite3_free(err_msg);
+        sqlite3_close(db);
+        throw std::runtime_error{"Failed to initialize TRDP log partition " + path.string() + ": " + error};
+    }
+    return db;
+}
+
+sqlite3 *TrdpLogPartitions::openForReading(const std::filesystem::path &path) {
+    sqlite3 *db = nullptr;
+    // Opened read-write but query-only: a read-only connection cannot
+    // recover the WAL index of a partition that nobody has open.
+    if (sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+    sqlite3_busy_timeout(db, kBusyTimeoutMs);
+    sqlite3_exec(db, "PRAGMA query_only = ON;", nullptr, nullptr, nullptr);
+    return db;
+}
+
+std::filesystem::path TrdpLogPartitions::defaultDirectory(const std::string &database_path) {
+    const std::filesystem::path path(database_path);
+    return path.parent_path() / (path.stem().string() + "-trdp_logs");
+}
+
+std::optional<LogPartition> TrdpLogPartitions::parseName(const std::string &file_name) {
+    // Both spans are accepted, so that partitions written before the span
+    // was changed are still read and subject to retention.
+    const size_t digits = file_name.size() - std::min(file_name.size(), kPrefix.size() + kSuffix.size());
+    if ((digits != 10 && digits != 8) || file_name.compare(0, kPrefix.size(), kPrefix) != 0 ||
+        file_name.compare(file_name.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0) {
+        return std::nullopt;
+    }
+    const std::string stamp = file_name.substr(kPrefix.size(), digits);
+    if (!std::all_of(stamp.begin(), stamp.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+        return std::nullopt;
+    }
+    std::tm tm {};
+    tm.tm_year = std::stoi(stamp.substr(0, 4)) - 1900;
+    tm.tm_mon = std::stoi(stamp.substr(4, 2)) - 1;
+    tm.tm_mday = std::stoi(stamp.substr(6, 2));
+    tm.tm_hour = digits == 10 ? std::stoi(stamp.substr(8, 2)) : 0;
+#ifdef _WIN32
+    const std::time_t start = _mkgmtime(&tm);
+#else
+    const std::time_t start = timegm(&tm);
+#endif
+    if (start == static_cast<std::time_t>(-1)) {
+        return std::nullopt;
+    }
+    LogPartition partition;
+    partition.start = static_cast<int64_t>(start);
+    partition.end = partition.start +
+                    spanSeconds(digits == 10 ? LogPartitionSpan::kHour : LogPartitionSpan::kDay);
+    return partition;
+}
+
+}  // namespace trdp::util
@@ -0,0 +1,418 @@
+#include "util/TrdpLogWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "db/Database.hpp"
+
+namespace trdp::util {
+
+namespace {
+
+// Open runs kept by the writer; beyond this many distinct telegram/peer
+// combinations all runs are closed and started afresh.
+constexpr size_t kMaxRuns = 4096;
+
+constexpr auto kRetentionInterval = std::chrono::minutes(1);
+
+void copyTag(char (&target)[4], std::string_view value) {
+    const size_t length = std::min(value.size(), sizeof(target) - 1);
+    value.copy(target, length);
+    target[length] = '\0';
+}
+
+// Formats like SQLite's CURRENT_TIMESTAMP so queued rows sort and display the
+// same way as rows that relied on the column default.
+void formatTimestamp(std::chrono::system_clock::time_point time, char (&buffer)[32]) {
+    const auto tt = std::chrono::system_clock::to_time_t(time);
+    std::tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &tt);
+#else
+    gmtime_r(&tt, &tm);
+#endif
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+int64_t unixSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+TrdpLogStorageOptions resolveStorage(const db::Database &database, TrdpLogStorageOptions storage) {
+    if (storage.directory.empty()) {
+        storage.directory = TrdpLogPartitions::defaultDirectory(database.path());
+    }
+    return storage;
+}
+
+int64_t maxLogId(sqlite3 *db) {
+    sqlite3_stmt *stmt = nullptr;
+    int64_t max_id = 0;
+    if (sqlite3_prepare_v2(db, "SELECT MAX(id) FROM trdp_logs;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        max_id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return max_id;
+}
+
+void bindText(sqlite3_stmt *stmt, int index, const std::string &value) {
+    sqlite3_bind_text(stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+}  // namespace
+
+TrdpLogWriter::TrdpLogWriter(db::Database &database, TrdpLogWriterOptions options)
+    : database_(database), options_(options), partitions_(resolveStorage(database, options.storage)) {
+    options_.queue_capacity = std::max<size_t>(options_.queue_capacity, 1);
+    options_.batch_size = std::clamp<size_t>(options_.batch_size, 1, options_.queue_capacity);
+    if (options_.flush_interval.count() <= 0) {
+        options_.flush_interval = std::chrono::milliseconds(1);
+    }
+
+    initializeNextId();
+    // Open the current partition up front so that a bad directory fails
+    // construction instead of dropping every record later.
+    openPartition(unixSeconds(options_.clock()));
+
+    ring_.resize(options_.queue_capacity);
+    thread_ = std::thread(&TrdpLogWriter::run, this);
+}
+
+TrdpLogWriter::~TrdpLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closePartition();
+}
+
+void TrdpLogWriter::enqueue(std::string_view direction, std::string_view type, int msg_id, std::string_view src_ip,
+                            std::string_view dst_ip, const uint8_t *payload, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (size_ == ring_.size()) {
+        if (options_.overflow_policy == LogOverflowPolicy::kBlock) {
+            not_full_.wait(lock, [this]() { return size_ < ring_.size() || stopping_; });
+            if (stopping_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        } else {
+            head_ = (head_ + 1) % ring_.size();
+            --size_;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Slots keep their buffers between uses, so steady-state enqueues only
+    // copy bytes into already reserved storage.
+    auto &record = ring_[(head_ + size_) % ring_.size()];
+    copyTag(record.direction, direction);
+    copyTag(record.type, type);
+    record.msg_id = msg_id;
+    record.src_ip.assign(src_ip.data(), src_ip.size());
+    record.dst_ip.assign(dst_ip.data(), dst_ip.size());
+    if (payload != nullptr && size > 0) {
+        record.payload.assign(payload, payload + size);
+    } else {
+        record.payload.clear();
+    }
+    // Stamped in ring order, which is id order; a clock stepping back does
+    // not reorder them either.
+    record.timestamp = std::max(options_.clock(), last_timestamp_);
+    last_timestamp_ = record.timestamp;
+    ++size_;
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    const bool wake_writer = size_ >= options_.batch_size;
+    lock.unlock();
+    if (wake_writer) {
+        not_empty_.notify_one();
+    }
+}
+
+void TrdpLogWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (size_ == 0 && in_flight_ == 0) {
+        return;
+    }
+    flush_requested_ = true;
+    not_empty_.notify_one();
+    drained_.wait(lock, [this]() { return (size_ == 0 && in_flight_ == 0) || stopping_; });
+}
+
+TrdpLogWriterStats TrdpLogWriter::stats() const {
+    TrdpLogWriterStats stats;
+    stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.deduplicated = deduplicated_.load(std::memory_order_relaxed);
+    stats.write_latency = write_latency_.snapshot();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.queue_depth = size_;
+    return stats;
+}
+
+void TrdpLogWriter::run() {
+    std::vector<Record> batch(options_.batch_size);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        not_empty_.wait_for(lock, options_.flush_interval,
+                            [this]() { return stopping_ || flush_requested_ || size_ >= options_.batch_size; });
+        if (std::chrono::steady_clock::now() >= next_retention_) {
+            lock.unlock();
+            partitions_.enforceRetention(unixSeconds(options_.clock()), partition_.path);
+            next_retention_ = std::chrono::steady_clock::now() + kRetentionInterval;
+            lock.lock();
+        }
+        const size_t count = std::min(size_, batch.size());
+        if (count == 0) {
+            flush_requested_ = false;
+            drained_.notify_all();
+            if (stopping_) {
+                break;
+            }
+            continue;
+        }
+        // Swap instead of copy: the ring slot inherits the batch buffer so
+        // neither side reallocates.
+        for (size_t i = 0; i < count; ++i) {
+            std::swap(batch[i], ring_[head_]);
+            head_ = (head_ + 1) % ring_.size();
+        }
+        size_ -= count;
+        in_flight_ = count;
+        lock.unlock();
+        not_full_.notify_all();
+        writeBatch(batch, count);
+        lock.lock();
+        in_flight_ = 0;
+        if (size_ == 0) {
+            flush_requested_ = false;
+            drained_.notify_all();
+        }
+    }
+}
+
+void TrdpLogWriter::writeBatch(std::vector<Record> &batch, size_t count) {
+    const auto started = std::chrono::steady_clock::now();
+    bool in_transaction = false;
+    uint64_t written = 0;
+    uint64_t deduplicated = 0;
+    // Counted into written/deduplicated once their transaction commits.
+    uint64_t pending_written = 0;
+    uint64_t pending_deduplicated = 0;
+    auto commit = [&]() {
+        if (!in_transaction || commitPartition()) {
+            written += pending_written;
+            deduplicated += pending_deduplicated;
+        }
+        in_transaction = false;
+        pending_written = 0;
+        pending_deduplicated = 0;
+    };
+
+    char timestamp[32];
+    for (size_t i = 0; i < count; ++i) {
+        const auto &record = batch[i];
+        const int64_t second = unixSeconds(record.timestamp);
+        if (partition_db_ == nullptr || second < partition_.start || second >= partition_.end) {
+            commit();
+            try {
+                openPartition(second);
+            } catch (const std::exception &ex) {
+                std::cerr << ex.what() << std::endl;
+                continue;
+            }
+        }
+        if (!in_transaction) {
+            in_transaction = sqlite3_exec(partition_db_, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK;
+        }
+        if (extendRun(record)) {
+            ++pending_written;
+            ++pending_deduplicated;
+            continue;
+        }
+        formatTimestamp(record.timestamp, timestamp);
+        const int64_t id = next_id_++;
+        sqlite3_bind_int64(insert_stmt_, 1, id);
+        sqlite3_bind_text(insert_stmt_, 2, record.direction, -1, SQLITE_STATIC);
+        sqlite3_bind_text(insert_stmt_, 3, record.type, -1, SQLITE_STATIC);
+        sqlite3_bind_int(insert_stmt_, 4, record.msg_id);
+        bindText(insert_stmt_, 5, record.src_ip);
+        bindText(insert_stmt_, 6, record.dst_ip);
+        if (!record.payload.empty()) {
+            sqlite3_bind_blob(insert_stmt_, 7, record.payload.data(), static_cast<int>(record.payload.size()),
+                              SQLITE_STATIC);
+        } else {
+            sqlite3_bind_null(insert_stmt_, 7);
+        }
+        sqlite3_bind_text(insert_stmt_, 8, timestamp, -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(insert_stmt_) == SQLITE_DONE) {
+            ++pending_written;
+            openRun(record, id);
+        }
+        sqlite3_reset(insert_stmt_);
+        sqlite3_clear_bindings(insert_stmt_);
+    }
+    commit();
+    write_latency_.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+    written_.fetch_add(written, std::memory_order_relaxed);
+    deduplicated_.fetch_add(deduplicated, std::memory_order_relaxed);
+    dropped_.fetch_add(count - written, std::memory_order_relaxed);
+}
+
+bool TrdpLogWriter::commitPartition() {
+    updateDirtyRuns();
+    if (sqlite3_exec(partition_db_, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK) {
+        return true;
+    }
+    std::cerr << "Failed to commit TRDP log batch: " << sqlite3_errmsg(partition_db_) << std::endl;
+    sqlite3_exec(partition_db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+    // The rolled back rows may have started runs; begin afresh.
+    runs_.clear();
+    return false;
+}
+
+void TrdpLogWriter::openPartition(int64_t unix_seconds) {
+    closePartition();
+    LogPartition partition = partitions_.partitionAt(unix_seconds);
+    sqlite3 *db = TrdpLogPartitions::openForWriting(partition.path);
+    const char *insert_sql =
+        "INSERT INTO trdp_logs (id, direction, type, msg_id, src_ip, dst_ip, payload, timestamp) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(db, insert_sql, -1, &insert_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "UPDATE trdp_logs SET repeat_count = ?, last_timestamp = ? WHERE id = ?;", -1,
+                           &update_run_stmt_, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(insert_stmt_);
+        insert_stmt_ = nullptr;
+        sqlite3_close(db);
+        throw std::runtime_error{"Failed to prepare TRDP log statements for " + partition.path.string()};
+    }
+    partition_db_ = db;
+    partition_ = std::move(partition);
+}
+
+void TrdpLogWriter::closePartition() {
+    runs_.clear();
+    dirty_runs_.clear();
+    sqlite3_finalize(insert_stmt_);
+    sqlite3_finalize(update_run_stmt_);
+    insert_stmt_ = nullptr;
+    update_run_stmt_ = nullptr;
+    if (partition_db_ != nullptr) {
+        sqlite3_close(partition_db_);
+        partition_db_ = nullptr;
+    }
+}
+
+void TrdpLogWriter::initializeNextId() {
+    // Rows logged before partitioning stay in the main database and keep
+    // their ids; partitions continue after them.
+    int64_t max_id = maxLogId(database_.reader()->handle());
+    const auto existing = partitions_.list();
+    for (auto it = existing.rbegin(); it != existing.rend(); ++it) {
+        sqlite3 *db = TrdpLogPartitions::openForReading(it->path);
+        if (db == nullptr) {
+            continue;
+        }
+        const int64_t partition_max = maxLogId(db);
+        sqlite3_close(db);
+        if (partition_max > 0) {
+            max_id = std::max(max_id, partition_max);
+            break;
+        }
+    }
+    next_id_ = max_id + 1;
+}
+
+bool TrdpLogWriter::extendRun(const Record &record) {
+    if (!options_.deduplicate_pd || std::strcmp(record.type, "PD") != 0) {
+        return false;
+    }
+    run_key_.assign(record.direction);
+    run_key_ += '|';
+    run_key_ += std::to_string(record.msg_id);
+    run_key_ += '|';
+    run_key_ += record.src_ip;
+    run_key_ += '|';
+    run_key_ += record.dst_ip;
+    const auto it = runs_.find(run_key_);
+    if (it == runs_.end()) {
+        return false;
+    }
+    Run &run = it->second;
+    if (run.row_id == 0 || run.payload != record.payload || record.timestamp - run.first >= options_.max_run_duration) {
+        return false;
+    }
+    ++run.repeat_count;
+    run.last = record.timestamp;
+    if (!run.dirty) {
+        run.dirty = true;
+        dirty_runs_.push_back(&run);
+    }
+    return true;
+}
+
+void TrdpLogWriter::openRun(const Record &record, int64_t row_id) {
+    // extendRun() has just built run_key_ for this record.
+    if (!options_.deduplicate_pd || std::strcmp(record.type, "PD") != 0) {
+        return;
+    }
+    if (runs_.size() >= kMaxRuns && runs_.find(run_key_) == runs_.end()) {
+        updateDirtyRuns();
+        runs_.clear();
+    }
+    Run &run = runs_[run_key_];
+    if (run.dirty) {
+        // The previous run of this telegram ends here; persist its count
+        // before the slot is reused.
+        persistRun(run);
+    }
+    run.row_id = row_id;
+    run.payload = record.payload;
+    run.repeat_count = 1;
+    run.first = record.timestamp;
+    run.last = record.timestamp;
+}
+
+void TrdpLogWriter::updateDirtyRuns() {
+    // A run reopened by openRun() may be listed twice; persistRun() skips
+    // runs that are already clean.
+    for (Run *run : dirty_runs_) {
+        if (run->dirty) {
+            persistRun(*run);
+        }
+    }
+    dirty_runs_.clear();
+}
+
+void TrdpLogWriter::persistRun(Run &run) {
+    char timestamp[32];
+    formatTimestamp(run.last, timestamp);
+    sqlite3_bind_int64(update_run_stmt_, 1, run.repeat_count);
+    sqlite3_bind_text(update_run_stmt_, 2, timestamp, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(update_run_stmt_, 3, run.row_id);
+    // A row deleted underneath the writer closes the run.
+    if (sqlite3_step(update_run_stmt_) != SQLITE_DONE || sqlite3_changes(partition_db_) == 0) {
+        run.row_id = 0;
+    }
+    sqlite3_reset(update_run_stmt_);
+    sqlite3_clear_bindings(update_run_stmt_);
+    run.dirty = false;
+}
+
+}  // namespace trdp::util
@@ -0,0 +1,8 @@
+/*
+ * Compile-only stand-in for the TCNopen IEC 61375-2-3 definitions; see
+ * trdp_if_light.h in this directory. The engine uses none of them yet.
+ */
+#ifndef TRDP_STUB_IEC61375_2_3_H
+#define TRDP_STUB_IEC61375_2_3_H
+
+#endif /* TRDP_STUB_IEC61375_2_3_H */
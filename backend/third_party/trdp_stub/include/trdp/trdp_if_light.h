@@ -0,0 +1,184 @@
+/*
+ * Compile-only stand-in for the TCNopen TRDP light interface.
+ *
+ * It declares the types, constants and callback signatures that
+ * src/trdp/TrdpEngine.cpp uses, with the names and layouts of the TCNopen
+ * headers, so the native code path (TRDP_HAS_NATIVE_API) is compiled even
+ * where the SDK is not installed. The functions are resolved with dlsym()
+ * at run time, so nothing links against this; see the trdp_native_check
+ * target in CMakeLists.txt. Keep it in step with the engine when the native
+ * path starts using more of the API.
+ */
+#ifndef TRDP_STUB_TRDP_IF_LIGHT_H
+#define TRDP_STUB_TRDP_IF_LIGHT_H
+
+#include <stdint.h>
+#include <sys/select.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef int32_t INT32;
+typedef char CHAR8;
+typedef uint8_t BOOL8;
+
+#define TRDP_MAX_LABEL_LEN 16u
+#define TRDP_MAX_URI_USER_LEN 32u
+
+typedef UINT32 TRDP_IP_ADDR_T;
+typedef INT32 TRDP_SOCK_T;
+typedef fd_set TRDP_FDS_T;
+typedef CHAR8 TRDP_URI_USER_T[TRDP_MAX_URI_USER_LEN + 1u];
+typedef CHAR8 TRDP_LABEL_T[TRDP_MAX_LABEL_LEN + 1u];
+
+typedef struct {
+    UINT32 tv_sec;
+    INT32 tv_usec;
+} TRDP_TIME_T;
+
+typedef enum {
+    TRDP_NO_ERR = 0,
+    TRDP_PARAM_ERR = -1,
+    TRDP_INIT_ERR = -2,
+    TRDP_NOINIT_ERR = -3,
+    TRDP_TIMEOUT_ERR = -4,
+    TRDP_NODATA_ERR = -5,
+    TRDP_SOCK_ERR = -6,
+    TRDP_IO_ERR = -7,
+    TRDP_MEM_ERR = -8
+} TRDP_ERR_T;
+
+typedef enum {
+    VOS_LOG_ERROR = 0,
+    VOS_LOG_WARNING = 1,
+    VOS_LOG_INFO = 2,
+    VOS_LOG_DBG = 3
+} TRDP_LOG_T;
+
+typedef UINT8 TRDP_FLAGS_T;
+#define TRDP_FLAGS_DEFAULT 0u
+#define TRDP_FLAGS_NONE 0x01u
+#define TRDP_FLAGS_MARSHALL 0x02u
+#define TRDP_FLAGS_CALLBACK 0x04u
+
+typedef UINT8 TRDP_OPTION_T;
+#define TRDP_OPTION_NONE 0u
+#define TRDP_OPTION_BLOCK 0x01u
+
+typedef enum {
+    TRDP_TO_DEFAULT = 0,
+    TRDP_TO_SET_TO_ZERO = 1,
+    TRDP_TO_KEEP_LAST_VALUE = 2
+} TRDP_TO_BEHAVIOR_T;
+
+typedef struct TRDP_SESSION *TRDP_APP_SESSION_T;
+typedef struct PD_ELE *TRDP_PUB_T;
+typedef struct PD_ELE *TRDP_SUB_T;
+typedef struct MD_LIS_ELE *TRDP_LIS_T;
+
+typedef struct {
+    UINT8 qos;
+    UINT8 ttl;
+    UINT8 retries;
+    BOOL8 tsn;
+    UINT16 vlan;
+} TRDP_COM_PARAM_T;
+
+typedef TRDP_COM_PARAM_T TRDP_SEND_PARAM_T;
+
+#define TRDP_PD_DEFAULT_SEND_PARAM {5u, 64u, 0u, 0u, 0u}
+#define TRDP_MD_DEFAULT_SEND_PARAM {3u, 64u, 2u, 0u, 0u}
+
+typedef struct {
+    UINT8 *p;
+    UINT32 size;
+    UINT32 prealloc[15];
+} TRDP_MEM_CONFIG_T;
+
+typedef struct {
+    void *pfCbMarshall;
+    void *pfCbUnmarshall;
+    void *pRefCon;
+} TRDP_MARSHALL_CONFIG_T;
+
+typedef struct {
+    TRDP_IP_ADDR_T srcIpAddr;
+    TRDP_IP_ADDR_T destIpAddr;
+    UINT32 seqCount;
+    UINT16 protVersion;
+    UINT16 msgType;
+    UINT32 comId;
+    UINT32 etbTopoCnt;
+    UINT32 opTrnTopoCnt;
+    UINT32 replyComId;
+    TRDP_IP_ADDR_T replyIpAddr;
+    const void *pUserRef;
+    TRDP_ERR_T resultCode;
+} TRDP_PD_INFO_T;
+
+typedef struct {
+    TRDP_IP_ADDR_T srcIpAddr;
+    TRDP_IP_ADDR_T destIpAddr;
+    UINT32 seqCount;
+    UINT16 protVersion;
+    UINT16 msgType;
+    UINT32 comId;
+    UINT32 etbTopoCnt;
+    UINT32 opTrnTopoCnt;
+    UINT32 replyTimeout;
+    TRDP_URI_USER_T srcUserURI;
+    TRDP_URI_USER_T destUserURI;
+    const void *pUserRef;
+    TRDP_ERR_T resultCode;
+} TRDP_MD_INFO_T;
+
+typedef void (*TRDP_PRINT_DBG_T)(void *pRefCon, TRDP_LOG_T category, const CHAR8 *pTime, const CHAR8 *pFile,
+                                 UINT16 lineNumber, const CHAR8 *pMsgStr);
+typedef void (*TRDP_PD_CALLBACK_T)(void *pRefCon, TRDP_APP_SESSION_T appHandle, const TRDP_PD_INFO_T *pMsg,
+                                   UINT8 *pData, UINT32 dataSize);
+typedef void (*TRDP_MD_CALLBACK_T)(void *pRefCon, TRDP_APP_SESSION_T appHandle, const TRDP_MD_INFO_T *pMsg,
+                                   UINT8 *pData, UINT32 dataSize);
+
+typedef struct {
+    TRDP_PD_CALLBACK_T pfCbFunction;
+    void *pRefCon;
+    TRDP_SEND_PARAM_T sendParam;
+    TRDP_FLAGS_T flags;
+    UINT32 timeout;
+    TRDP_TO_BEHAVIOR_T toBehavior;
+    UINT16 port;
+} TRDP_PD_CONFIG_T;
+
+typedef struct {
+    TRDP_MD_CALLBACK_T pfCbFunction;
+    void *pRefCon;
+    TRDP_SEND_PARAM_T sendParam;
+    TRDP_FLAGS_T flags;
+    UINT32 replyTimeout;
+    UINT32 confirmTimeout;
+    UINT32 connectTimeout;
+    UINT32 sendingTimeout;
+    UINT16 udpPort;
+    UINT16 tcpPort;
+    UINT32 maxNumSessions;
+} TRDP_MD_CONFIG_T;
+
+typedef struct {
+    TRDP_LABEL_T hostName;
+    TRDP_LABEL_T leaderName;
+    TRDP_LABEL_T type;
+    UINT32 cycleTime;
+    UINT32 priority;
+    TRDP_OPTION_T options;
+    UINT16 vlanId;
+} TRDP_PROCESS_CONFIG_T;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRDP_STUB_TRDP_IF_LIGHT_H */
@@ -1,7 +1,17 @@
 import { useEffect, useState } from 'react';
 import type { FormEvent } from 'react';
 import { apiGet, apiPost } from '../api/client';
-import type { MdMessage, PdMessage } from '../types';
+import type { MdMessage, PdDelta, PdMessage } from '../types';
+
+function applyPdDelta(current: PdMessage[], delta: PdDelta): PdMessage[] {
+  if (delta.reset) {
+    return delta.telegrams;
+  }
+  const changed = new Map(delta.telegrams.map((msg) => [msg.id, msg]));
+  const merged = current.map((msg) => changed.get(msg.id) ?? msg);
+  const known = new Set(current.map((msg) => msg.id));
+  return merged.concat(delta.telegrams.filter((msg) => !known.has(msg.id)));
+}
 
 export function TrdpCommPage() {
   const [pdOutgoing, setPdOutgoing] = useState<PdMessage[]>([]);
@@ -14,6 +24,28 @@ export function TrdpCommPage() {
 
   useEffect(() => {
     refreshData();
+    // The stream pushes only changed telegrams; the initial frame carries the
+    // full lists, so the fetch above just covers browsers without SSE.
+    if (typeof EventSource === 'undefined') {
+      return undefined;
+    }
+    const source = new EventSource('/api/stream', { withCredentials: true });
+    source.addEventListener('pd-outgoing', (event) => {
+      const delta = JSON.parse((event as MessageEvent<string>).data) as PdDelta;
+      setPdOutgoing((current) => applyPdDelta(current, delta));
+    });
+    source.addEventListener('pd-incoming', (event) => {
+      const delta = JSON.parse((event as MessageEvent<string>).data) as PdDelta;
+      setPdIncoming((current) => applyPdDelta(current, delta));
+    });
+    source.addEventListener('md-incoming', (event) => {
+      const messages = JSON.parse((event as MessageEvent<string>).data) as MdMessage[];
+      setMdIncoming((current) => {
+        const known = new Set(current.map((msg) => msg.id));
+        return current.concat(messages.filter((msg) => !known.has(msg.id)));
+      });
+    });
+    return () => source.close();
   }, []);
 
   const refreshData = async () => {
@@ -32,6 +32,12 @@ export interface PdMessage {
   updated_at: string;
 }
 
+export interface PdDelta {
+  version: number;
+  reset: boolean;
+  telegrams: PdMessage[];
+}
+
 export interface MdMessage {
   id: number;
   subject: string;